@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <sdkconfig.h>
+
+/**
+ * @brief Time base of all accessory timers and motion computations.
+ *
+ * On the target this is esp_timer_get_time(). With CONFIG_A_M_VIRTUAL_TIME the clock only moves when
+ * AccessoryTimerService::advanceTo() is called, so simulations run deterministically and as fast as possible.
+ */
+class AccessoryClock
+{
+public:
+    /**
+     * @brief Gets the current time.
+     *
+     * @return Time in microseconds.
+     */
+    static int64_t now();
+
+#if CONFIG_A_M_VIRTUAL_TIME
+    /**
+     * @brief Sets the virtual time. Only used by AccessoryTimerService::advanceTo() and simulation runners.
+     *
+     * @param nowUs Time in microseconds, never earlier than the current time.
+     */
+    static void set(int64_t nowUs);
+#endif
+};
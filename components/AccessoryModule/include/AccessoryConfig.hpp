@@ -0,0 +1,127 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <ButtonModuleInterface.hpp>
+#include <RelayModuleInterface.hpp>
+
+#include "AccessoryRegistry.hpp"
+
+/**
+ * @brief Header of an accessory configuration image, followed by recordCount records of recordSize bytes.
+ *
+ * All fields are little endian. Images are written by tools/accessory_config_gen.py.
+ */
+struct AccessoryConfigHeader
+{
+    uint32_t magic;       ///< AccessoryConfig::MAGIC.
+    uint16_t version;     ///< Format version, AccessoryConfig::VERSION.
+    uint16_t headerSize;  ///< Size of the header, the offset of the first record.
+    uint16_t recordSize;  ///< Size of a record; later versions append fields that older loaders skip.
+    uint16_t recordCount; ///< Number of records.
+    uint16_t crc;         ///< CRC-16/CCITT of the records.
+    uint16_t reserved;    ///< Written as 0xFFFF.
+};
+
+/**
+ * @brief One accessory of a configuration image, the binary form of an AccessorySpec row.
+ */
+struct AccessoryConfigRecord
+{
+    static constexpr uint8_t NONE = 0xFF; ///< Unused relay or button.
+
+    uint8_t type;        ///< AccessoryType of the accessory.
+    uint8_t reserved;    ///< Written as 0xFF.
+    uint16_t endpointId; ///< Endpoint id, set as accessory id.
+    uint8_t relays[2];   ///< Relay index, or the up and down motors of a blind.
+    uint8_t buttons[2];  ///< Button index, or the up and down buttons of a blind.
+    uint8_t timing[2];   ///< Open duration of a door, or open and close times of a blind, in seconds.
+    uint16_t padding;    ///< Written as 0xFFFF.
+};
+
+static_assert(sizeof(AccessoryConfigHeader) == 16, "The configuration header layout is fixed");
+static_assert(sizeof(AccessoryConfigRecord) == 12, "The configuration record layout is fixed");
+
+/**
+ * @brief Reads an accessory configuration image in place and builds its accessories.
+ *
+ * The image is usually memory mapped, with AccessoryConfigPartition or AccessoryConfigFile: the records are used
+ * where they are, nothing is parsed or copied. The constructor only checks the header and the CRC; build()
+ * constructs every accessory in an AccessoryRegistry.
+ */
+class AccessoryConfig
+{
+public:
+    static constexpr uint32_t MAGIC   = 0x4643414D; ///< "MACF" in little endian.
+    static constexpr uint16_t VERSION = 1;          ///< Format version written by this module.
+
+    /**
+     * @brief Constructor for AccessoryConfig. Checks the image.
+     *
+     * @param image The image, must stay mapped while the AccessoryConfig is used.
+     * @param size Size of the image, or of the partition holding it.
+     */
+    AccessoryConfig(const void * image, size_t size);
+
+    /**
+     * @brief Checks whether the image is a valid configuration.
+     *
+     * @return True if the header and the CRC are valid, false otherwise.
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Gets the number of records.
+     *
+     * @return The number of records, 0 if the image is not valid.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Gets a record.
+     *
+     * @param index Index of the record, below size().
+     * @return The record, inside the image.
+     */
+    const AccessoryConfigRecord & record(size_t index) const;
+
+    /**
+     * @brief Constructs the accessory of every record in a registry.
+     *
+     * Records with an unknown type, a missing module or an index outside the tables are logged and skipped, as
+     * are the ones the registry rejects.
+     *
+     * @param registry Registry receiving the accessories.
+     * @param relays Relay table of the board, indexed by AccessoryConfigRecord::relays.
+     * @param relayCount Number of relays.
+     * @param buttons Button table of the board, indexed by AccessoryConfigRecord::buttons.
+     * @param buttonCount Number of buttons.
+     * @return Number of accessories built.
+     */
+    size_t build(AccessoryRegistry & registry, RelayModuleInterface * const * relays, size_t relayCount,
+                 ButtonModuleInterface * const * buttons, size_t buttonCount) const;
+
+    /**
+     * @brief Computes the CRC-16/CCITT stored in the header, for tools writing images.
+     *
+     * @param data The records.
+     * @param length Size of the records.
+     * @return The CRC.
+     */
+    static uint16_t checksum(const void * data, size_t length);
+
+private:
+    /**
+     * @brief Constructs the accessory of one record.
+     *
+     * @return The accessory, nullptr if the record was skipped.
+     */
+    static BaseAccessoryInterface * buildRecord(const AccessoryConfigRecord & record, AccessoryRegistry & registry,
+                                                RelayModuleInterface * const * relays, size_t relayCount,
+                                                ButtonModuleInterface * const * buttons, size_t buttonCount);
+
+    const uint8_t * m_records; ///< First record inside the image, nullptr if the image is not valid.
+    size_t m_recordSize;       ///< Size of a record in the image.
+    size_t m_recordCount;      ///< Number of records.
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <sdkconfig.h>
+
+// Builds for the chip have no mmap(); the Linux target and host builds do.
+#if !defined(ESP_PLATFORM) || CONFIG_IDF_TARGET_LINUX
+
+/**
+ * @brief Accessory configuration image kept in a file, mapped read-only with mmap(), for Linux and host builds.
+ */
+class AccessoryConfigFile
+{
+public:
+    /**
+     * @brief Constructor for AccessoryConfigFile. Maps the file.
+     *
+     * @param path Path of the file.
+     */
+    AccessoryConfigFile(const char * path);
+
+    /**
+     * @brief Destructor for AccessoryConfigFile. Unmaps the file.
+     */
+    ~AccessoryConfigFile();
+
+    /**
+     * @brief Gets the mapped file.
+     *
+     * @return The first byte of the file, nullptr if it could not be mapped.
+     */
+    const void * getData() const;
+
+    /**
+     * @brief Gets the size of the mapped file.
+     *
+     * @return Size in bytes, 0 if the file could not be mapped.
+     */
+    size_t getSize() const;
+
+private:
+    const void * m_data; ///< The mapped file, nullptr if it could not be mapped.
+    size_t m_size;       ///< Size of the mapping.
+
+    // Delete copy constructor and assignment operator
+    AccessoryConfigFile(const AccessoryConfigFile &)             = delete;
+    AccessoryConfigFile & operator=(const AccessoryConfigFile &) = delete;
+};
+
+#endif // !defined(ESP_PLATFORM) || CONFIG_IDF_TARGET_LINUX
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <sdkconfig.h>
+
+#if CONFIG_A_M_CONFIG_PARTITION
+
+#include <esp_partition.h>
+
+/**
+ * @brief Accessory configuration image kept in a data partition of the SPI flash, mapped into the data address space.
+ *
+ * The mapping goes through the flash cache: records are read where they are, without a copy in RAM.
+ */
+class AccessoryConfigPartition
+{
+public:
+    /**
+     * @brief Constructor for AccessoryConfigPartition. Maps the partition.
+     *
+     * @param label Label of the data partition in the partition table.
+     */
+    AccessoryConfigPartition(const char * label);
+
+    /**
+     * @brief Destructor for AccessoryConfigPartition. Unmaps the partition.
+     */
+    ~AccessoryConfigPartition();
+
+    /**
+     * @brief Gets the mapped partition.
+     *
+     * @return The first byte of the partition, nullptr if it could not be mapped.
+     */
+    const void * getData() const;
+
+    /**
+     * @brief Gets the size of the mapped partition.
+     *
+     * @return Size in bytes, 0 if the partition could not be mapped.
+     */
+    size_t getSize() const;
+
+private:
+    const void * m_data;                  ///< The mapped partition, nullptr if it could not be mapped.
+    size_t m_size;                        ///< Size of the mapping.
+    esp_partition_mmap_handle_t m_handle; ///< Handle releasing the mapping.
+
+    // Delete copy constructor and assignment operator
+    AccessoryConfigPartition(const AccessoryConfigPartition &)             = delete;
+    AccessoryConfigPartition & operator=(const AccessoryConfigPartition &) = delete;
+};
+
+#endif // CONFIG_A_M_CONFIG_PARTITION
@@ -0,0 +1,449 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+
+#include <ButtonModuleInterface.hpp>
+#include <RelayModuleInterface.hpp>
+
+#include "BlindAccessory.hpp"
+#include "DoorLockAccessory.hpp"
+#include "FanAccessory.hpp"
+#include "LightAccessory.hpp"
+#include "PluginAccessory.hpp"
+#include "StatelessButtonAccessory.hpp"
+#include "SwitchAccessory.hpp"
+
+/**
+ * @brief One row of a device description: type, endpoint, wiring and timing of an accessory.
+ *
+ * Relays and buttons are indices into the tables passed to the AccessoryDevice constructor, NONE when unused.
+ * Rows are built with the constexpr functions below.
+ */
+struct AccessorySpec
+{
+    static constexpr uint8_t NONE = 0xFF; ///< Unused relay or button.
+
+    AccessoryType type;  ///< Type of the accessory.
+    uint16_t endpointId; ///< Endpoint id, set as accessory id.
+    uint8_t relays[2];   ///< The relay, or the up and down motors of a blind.
+    uint8_t buttons[2];  ///< The button, or the up and down buttons of a blind.
+    uint8_t timing[2];   ///< Open duration of a door, or open and close times of a blind, in seconds.
+
+    /**
+     * @brief Describes a LightAccessory.
+     */
+    static constexpr AccessorySpec light(uint16_t endpointId, uint8_t relay, uint8_t button = NONE)
+    {
+        return { AccessoryType::Light, endpointId, { relay, NONE }, { button, NONE }, { 0, 0 } };
+    }
+
+    /**
+     * @brief Describes a FanAccessory.
+     */
+    static constexpr AccessorySpec fan(uint16_t endpointId, uint8_t relay, uint8_t button = NONE)
+    {
+        return { AccessoryType::Fan, endpointId, { relay, NONE }, { button, NONE }, { 0, 0 } };
+    }
+
+    /**
+     * @brief Describes a SwitchAccessory.
+     */
+    static constexpr AccessorySpec onOffSwitch(uint16_t endpointId, uint8_t relay, uint8_t button = NONE)
+    {
+        return { AccessoryType::Switch, endpointId, { relay, NONE }, { button, NONE }, { 0, 0 } };
+    }
+
+    /**
+     * @brief Describes a PluginAccessory.
+     */
+    static constexpr AccessorySpec plugin(uint16_t endpointId, uint8_t relay, uint8_t button = NONE)
+    {
+        return { AccessoryType::Plugin, endpointId, { relay, NONE }, { button, NONE }, { 0, 0 } };
+    }
+
+    /**
+     * @brief Describes a DoorLockAccessory, which needs a button.
+     */
+    static constexpr AccessorySpec doorLock(uint16_t endpointId, uint8_t relay, uint8_t button, uint8_t openDuration = 5)
+    {
+        return { AccessoryType::DoorLock, endpointId, { relay, NONE }, { button, NONE }, { openDuration, 0 } };
+    }
+
+    /**
+     * @brief Describes a BlindAccessory.
+     */
+    static constexpr AccessorySpec blind(uint16_t endpointId, uint8_t motorUp, uint8_t motorDown, uint8_t buttonUp = NONE,
+                                         uint8_t buttonDown = NONE, uint8_t timeToOpen = 30, uint8_t timeToClose = 30)
+    {
+        return { AccessoryType::Blind, endpointId, { motorUp, motorDown }, { buttonUp, buttonDown }, { timeToOpen, timeToClose } };
+    }
+
+    /**
+     * @brief Describes a StatelessButtonAccessory, without a button when edges are fed with handleEdge().
+     */
+    static constexpr AccessorySpec statelessButton(uint16_t endpointId, uint8_t button = NONE)
+    {
+        return { AccessoryType::StatelessButton, endpointId, { NONE, NONE }, { button, NONE }, { 0, 0 } };
+    }
+};
+
+/**
+ * @brief Compile-time checks of a device description, used by the static_asserts of AccessoryDevice.
+ */
+struct AccessoryDeviceCheck
+{
+    /**
+     * @brief Checks that no two accessories share an endpoint id.
+     */
+    template <size_t N>
+    static constexpr bool endpointsDistinct(const AccessorySpec (&specs)[N])
+    {
+        for (size_t i = 0; i < N; i++)
+        {
+            for (size_t j = i + 1; j < N; j++)
+            {
+                if (specs[i].endpointId == specs[j].endpointId)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Checks that no relay drives two accessories, or both motors of a blind.
+     */
+    template <size_t N>
+    static constexpr bool relaysDistinct(const AccessorySpec (&specs)[N])
+    {
+        return distinct(specs, &AccessorySpec::relays);
+    }
+
+    /**
+     * @brief Checks that no button is wired to two accessories, or to both directions of a blind.
+     */
+    template <size_t N>
+    static constexpr bool buttonsDistinct(const AccessorySpec (&specs)[N])
+    {
+        return distinct(specs, &AccessorySpec::buttons);
+    }
+
+    /**
+     * @brief Checks that every accessory has the relays and buttons its constructor needs.
+     */
+    template <size_t N>
+    static constexpr bool wiringComplete(const AccessorySpec (&specs)[N])
+    {
+        for (size_t i = 0; i < N; i++)
+        {
+            const AccessorySpec & spec = specs[i];
+            bool hasRelay              = spec.relays[0] != AccessorySpec::NONE;
+            switch (spec.type)
+            {
+            case AccessoryType::Blind:
+                if (!hasRelay || spec.relays[1] == AccessorySpec::NONE)
+                {
+                    return false;
+                }
+                break;
+            case AccessoryType::DoorLock:
+                if (!hasRelay || spec.buttons[0] == AccessorySpec::NONE)
+                {
+                    return false;
+                }
+                break;
+            case AccessoryType::StatelessButton:
+                break;
+            default:
+                if (!hasRelay)
+                {
+                    return false;
+                }
+                break;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Gets the size the relay table needs: the highest relay index plus one.
+     */
+    template <size_t N>
+    static constexpr size_t relayCount(const AccessorySpec (&specs)[N])
+    {
+        return count(specs, &AccessorySpec::relays);
+    }
+
+    /**
+     * @brief Gets the size the button table needs: the highest button index plus one.
+     */
+    template <size_t N>
+    static constexpr size_t buttonCount(const AccessorySpec (&specs)[N])
+    {
+        return count(specs, &AccessorySpec::buttons);
+    }
+
+private:
+    /**
+     * @brief Checks that the used indices of one wiring field appear once in the whole description.
+     */
+    template <size_t N>
+    static constexpr bool distinct(const AccessorySpec (&specs)[N], uint8_t (AccessorySpec::*field)[2])
+    {
+        for (size_t i = 0; i < 2 * N; i++)
+        {
+            uint8_t index = (specs[i / 2].*field)[i % 2];
+            for (size_t j = i + 1; j < 2 * N && index != AccessorySpec::NONE; j++)
+            {
+                if ((specs[j / 2].*field)[j % 2] == index)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Gets the highest used index of one wiring field plus one.
+     */
+    template <size_t N>
+    static constexpr size_t count(const AccessorySpec (&specs)[N], uint8_t (AccessorySpec::*field)[2])
+    {
+        size_t result = 0;
+        for (size_t i = 0; i < 2 * N; i++)
+        {
+            uint8_t index = (specs[i / 2].*field)[i % 2];
+            if (index != AccessorySpec::NONE && size_t(index) + 1 > result)
+            {
+                result = size_t(index) + 1;
+            }
+        }
+        return result;
+    }
+};
+
+/**
+ * @brief Maps an AccessoryType to the class AccessoryDevice builds for it.
+ */
+template <AccessoryType Type>
+struct AccessoryOfType;
+
+template <>
+struct AccessoryOfType<AccessoryType::Light>
+{
+    using type = LightAccessory; ///< Class of the accessory.
+};
+
+template <>
+struct AccessoryOfType<AccessoryType::Fan>
+{
+    using type = FanAccessory; ///< Class of the accessory.
+};
+
+template <>
+struct AccessoryOfType<AccessoryType::Switch>
+{
+    using type = SwitchAccessory; ///< Class of the accessory.
+};
+
+template <>
+struct AccessoryOfType<AccessoryType::Plugin>
+{
+    using type = PluginAccessory; ///< Class of the accessory.
+};
+
+template <>
+struct AccessoryOfType<AccessoryType::DoorLock>
+{
+    using type = DoorLockAccessory; ///< Class of the accessory.
+};
+
+template <>
+struct AccessoryOfType<AccessoryType::Blind>
+{
+    using type = BlindAccessory; ///< Class of the accessory.
+};
+
+template <>
+struct AccessoryOfType<AccessoryType::StatelessButton>
+{
+    using type = StatelessButtonAccessory; ///< Class of the accessory.
+};
+
+/**
+ * @brief Looks up the modules of a row in the tables of the board.
+ */
+struct AccessoryDeviceWiring
+{
+    using Relays  = RelayModuleInterface * const *;  ///< Relay table of the board.
+    using Buttons = ButtonModuleInterface * const *; ///< Button table of the board.
+
+    /**
+     * @brief Gets a button of the board table.
+     *
+     * @param index Index of the button, AccessorySpec::NONE if there is none.
+     * @param buttons Button table of the board.
+     * @return The button, nullptr for AccessorySpec::NONE.
+     */
+    static ButtonModuleInterface * button(uint8_t index, Buttons buttons)
+    {
+        return index == AccessorySpec::NONE ? nullptr : buttons[index];
+    }
+};
+
+/**
+ * @brief Storage of the accessory at position Index of a device, constructed from its row.
+ *
+ * Index keeps two accessories of the same class distinct bases of the device. The primary template builds the relay
+ * toggle accessories; the others are specialized below.
+ */
+template <size_t Index, typename Accessory>
+struct AccessoryDeviceSlot
+{
+    /**
+     * @brief Constructs the accessory.
+     *
+     * @param spec Row of the accessory.
+     * @param relays Relay table of the board.
+     * @param buttons Button table of the board.
+     */
+    AccessoryDeviceSlot(const AccessorySpec & spec, AccessoryDeviceWiring::Relays relays, AccessoryDeviceWiring::Buttons buttons) :
+        accessory(relays[spec.relays[0]], AccessoryDeviceWiring::button(spec.buttons[0], buttons))
+    {
+    }
+
+    Accessory accessory; ///< The accessory.
+};
+
+/**
+ * @brief Storage of a door lock of a device.
+ */
+template <size_t Index>
+struct AccessoryDeviceSlot<Index, DoorLockAccessory>
+{
+    AccessoryDeviceSlot(const AccessorySpec & spec, AccessoryDeviceWiring::Relays relays, AccessoryDeviceWiring::Buttons buttons) :
+        accessory(relays[spec.relays[0]], buttons[spec.buttons[0]], spec.timing[0])
+    {
+    }
+
+    DoorLockAccessory accessory; ///< The accessory.
+};
+
+/**
+ * @brief Storage of a blind of a device.
+ */
+template <size_t Index>
+struct AccessoryDeviceSlot<Index, BlindAccessory>
+{
+    AccessoryDeviceSlot(const AccessorySpec & spec, AccessoryDeviceWiring::Relays relays, AccessoryDeviceWiring::Buttons buttons) :
+        accessory(relays[spec.relays[0]], relays[spec.relays[1]], AccessoryDeviceWiring::button(spec.buttons[0], buttons),
+                  AccessoryDeviceWiring::button(spec.buttons[1], buttons), spec.timing[0], spec.timing[1])
+    {
+    }
+
+    BlindAccessory accessory; ///< The accessory.
+};
+
+/**
+ * @brief Storage of a stateless button of a device.
+ */
+template <size_t Index>
+struct AccessoryDeviceSlot<Index, StatelessButtonAccessory>
+{
+    AccessoryDeviceSlot(const AccessorySpec & spec, AccessoryDeviceWiring::Relays relays, AccessoryDeviceWiring::Buttons buttons) :
+        accessory(AccessoryDeviceWiring::button(spec.buttons[0], buttons))
+    {
+        (void) relays;
+    }
+
+    StatelessButtonAccessory accessory; ///< The accessory.
+};
+
+template <const auto & Specs, typename Indices = std::make_index_sequence<sizeof(Specs) / sizeof(Specs[0])>>
+class AccessoryDevice;
+
+/**
+ * @brief Every accessory of a board, built from a constexpr description into one object with no heap use.
+ *
+ * The description is a constexpr array of AccessorySpec rows; each row becomes a member of the concrete accessory
+ * class, so the whole device has a size known at compile time and lives wherever the object is declared, typically
+ * as a static in app_main:
+ * @code
+ * static constexpr AccessorySpec BOARD[] = { AccessorySpec::light(1, 0, 0), AccessorySpec::blind(2, 1, 2, 1, 2, 25, 20) };
+ * static AccessoryDevice<BOARD> device(relays, buttons);
+ * @endcode
+ *
+ * Conflicting endpoints, relays and buttons, missing wiring and tables too small for the description fail to
+ * compile.
+ */
+template <const auto & Specs, size_t... Index>
+class AccessoryDevice<Specs, std::index_sequence<Index...>> :
+    private AccessoryDeviceSlot<Index, typename AccessoryOfType<Specs[Index].type>::type>...
+{
+    static_assert(sizeof...(Index) > 0, "A device needs at least one accessory");
+    static_assert(AccessoryDeviceCheck::endpointsDistinct(Specs), "Two accessories share an endpoint id");
+    static_assert(AccessoryDeviceCheck::relaysDistinct(Specs), "A relay is assigned twice");
+    static_assert(AccessoryDeviceCheck::buttonsDistinct(Specs), "A button is assigned twice");
+    static_assert(AccessoryDeviceCheck::wiringComplete(Specs), "An accessory lacks a relay or button it needs");
+
+    template <size_t I>
+    using Slot = AccessoryDeviceSlot<I, typename AccessoryOfType<Specs[I].type>::type>;
+
+public:
+    static constexpr size_t SIZE = sizeof...(Index); ///< Number of accessories.
+
+    /**
+     * @brief Constructs every accessory and sets its accessory id to its endpoint id.
+     *
+     * @param relays Relay table of the board, indexed by AccessorySpec::relays.
+     * @param buttons Button table of the board, indexed by AccessorySpec::buttons.
+     */
+    template <size_t RelayCount, size_t ButtonCount>
+    AccessoryDevice(RelayModuleInterface * const (&relays)[RelayCount], ButtonModuleInterface * const (&buttons)[ButtonCount]) :
+        Slot<Index>(Specs[Index], relays, buttons)..., m_accessories{ &this->Slot<Index>::accessory... }
+    {
+        static_assert(AccessoryDeviceCheck::relayCount(Specs) <= RelayCount, "A relay index is outside the relay table");
+        static_assert(AccessoryDeviceCheck::buttonCount(Specs) <= ButtonCount, "A button index is outside the button table");
+        for (size_t i = 0; i < SIZE; i++)
+        {
+            m_accessories[i]->setAccessoryId(Specs[i].endpointId);
+        }
+    }
+
+    /**
+     * @brief Gets an accessory with its concrete type.
+     *
+     * @tparam I Row of the accessory in the description.
+     * @return The accessory.
+     */
+    template <size_t I>
+    typename AccessoryOfType<Specs[I].type>::type & get()
+    {
+        return Slot<I>::accessory;
+    }
+
+    /**
+     * @brief Gets the accessories, in the order of the description.
+     *
+     * @return SIZE accessories.
+     */
+    BaseAccessoryInterface * const * accessories() const { return m_accessories; }
+
+    /**
+     * @brief Gets the number of accessories.
+     *
+     * @return SIZE.
+     */
+    static constexpr size_t size() { return SIZE; }
+
+private:
+    BaseAccessoryInterface * m_accessories[SIZE]; ///< The accessories, in the order of the description.
+
+    // Delete copy constructor and assignment operator
+    AccessoryDevice(const AccessoryDevice &)             = delete;
+    AccessoryDevice & operator=(const AccessoryDevice &) = delete;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief Kind of accessory that emitted an event.
+ */
+enum class AccessoryType : uint8_t
+{
+    Light,          ///< LightAccessory.
+    Fan,            ///< FanAccessory.
+    Switch,         ///< SwitchAccessory.
+    Plugin,         ///< PluginAccessory.
+    DoorLock,       ///< DoorLockAccessory.
+    Blind,          ///< BlindAccessory.
+    StatelessButton ///< StatelessButtonAccessory.
+};
+
+static constexpr uint8_t ACCESSORY_TYPE_COUNT = static_cast<uint8_t>(AccessoryType::StatelessButton) + 1; ///< Number of types.
+
+/**
+ * @brief Change event delivered to the application, carrying the changed attributes and their new values.
+ *
+ * Only the values flagged in changedMask are meaningful, so the application can push exactly those attributes
+ * without calling back into the accessory getters.
+ */
+struct AccessoryEvent
+{
+    /**
+     * @brief Bits of changedMask.
+     */
+    enum Attribute : uint16_t
+    {
+        ATTRIBUTE_POWER            = 1 << 0, ///< powerOn changed.
+        ATTRIBUTE_LOCK_STATE       = 1 << 1, ///< unlocked changed.
+        ATTRIBUTE_CURRENT_POSITION = 1 << 2, ///< currentPosition changed.
+        ATTRIBUTE_TARGET_POSITION  = 1 << 3, ///< targetPosition changed.
+        ATTRIBUTE_PRESS_TYPE       = 1 << 4  ///< A press of type pressType happened.
+    };
+
+    uint16_t accessoryId;        ///< Identifier set with setAccessoryId().
+    uint16_t changedMask;        ///< Attribute bits whose values changed.
+    AccessoryType accessoryType; ///< Kind of accessory that emitted the event.
+    bool onlySave;               ///< True for intermediate values that only need to be persisted.
+    bool powerOn;                ///< Power state of light, fan, switch and plugin accessories.
+    bool unlocked;               ///< Lock state of door lock accessories.
+    uint16_t currentPosition;    ///< Current blind position in hundredths of a percent.
+    uint16_t targetPosition;     ///< Target blind position in hundredths of a percent.
+    uint8_t pressType;           ///< StatelessButtonAccessoryInterface::PressType of the press.
+    uint8_t pressCount;          ///< Number of presses of the sequence, 1 unless decoded from raw edges.
+};
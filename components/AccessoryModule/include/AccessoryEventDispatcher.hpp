@@ -0,0 +1,115 @@
+#pragma once
+
+#include <sdkconfig.h>
+
+#if CONFIG_A_M_EVENT_DISPATCHER_ENABLE
+
+#if CONFIG_A_M_VIRTUAL_TIME
+#error "The event dispatcher task cannot be used with CONFIG_A_M_VIRTUAL_TIME"
+#endif
+
+#include <atomic>
+#include <stddef.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "AccessoryEvent.hpp"
+
+class AccessoryReporter;
+
+/**
+ * @brief Single task that delivers accessory events to the application callbacks.
+ *
+ * Events are posted into a preallocated lock-free ring buffer, so button callbacks and timer callbacks only pay
+ * for an enqueue and never wait for a slow application callback. When the ring is full the event is dropped and
+ * counted.
+ */
+class AccessoryEventDispatcher
+{
+public:
+    /**
+     * @brief Back-pressure statistics of the event queue.
+     */
+    struct Stats
+    {
+        uint32_t enqueued;  ///< Number of events accepted into the queue.
+        uint32_t dropped;   ///< Number of events dropped because the queue was full.
+        uint32_t highWater; ///< Largest number of events waiting in the queue at once.
+    };
+
+    /**
+     * @brief Gets the event dispatcher, starting its task on first use.
+     *
+     * @return The event dispatcher instance.
+     */
+    static AccessoryEventDispatcher & instance();
+
+    /**
+     * @brief Queues an event for delivery by the dispatcher task.
+     *
+     * Safe to call from several tasks at once. Never blocks.
+     *
+     * @param reporter The reporter whose callbacks receive the event.
+     * @param event The event to deliver.
+     * @return True if the event was queued, false if the queue is full.
+     */
+    bool post(AccessoryReporter * reporter, const AccessoryEvent & event);
+
+    /**
+     * @brief Makes sure no event of a reporter is delivered after the call, before the reporter is destroyed.
+     *
+     * Waits until every event posted before the call has been delivered. On the dispatcher task itself, when an
+     * event callback destroys an accessory, the pending events of the reporter are dropped instead.
+     *
+     * @param reporter The reporter.
+     */
+    void drain(AccessoryReporter * reporter);
+
+    /**
+     * @brief Gets the back-pressure statistics.
+     *
+     * @return The statistics since start-up.
+     */
+    Stats getStats() const;
+
+private:
+    /**
+     * @brief Constructor for AccessoryEventDispatcher. Creates the dispatcher task.
+     */
+    AccessoryEventDispatcher();
+
+    /**
+     * @brief Task that delivers queued events in order.
+     *
+     * @param instance Pointer to the instance of the class.
+     */
+    static void dispatcherTask(void * instance);
+
+    /**
+     * @brief Ring buffer slot. The sequence tells producers and the consumer whose turn it is.
+     */
+    struct Slot
+    {
+        std::atomic<size_t> sequence; ///< Position the slot is ready for, plus one once it holds an event.
+        AccessoryReporter * reporter; ///< Reporter whose callbacks receive the event, nullptr once dropped.
+        AccessoryEvent event;         ///< The queued event.
+    };
+
+    static constexpr size_t CAPACITY = CONFIG_A_M_EVENT_DISPATCHER_QUEUE_SIZE; ///< Number of slots in the ring.
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "CONFIG_A_M_EVENT_DISPATCHER_QUEUE_SIZE must be a power of two");
+
+    Slot m_slots[CAPACITY];                ///< Preallocated ring buffer.
+    std::atomic<size_t> m_enqueuePosition; ///< Next position claimed by a producer.
+    std::atomic<size_t> m_dequeuePosition; ///< Next position read by the dispatcher task.
+    std::atomic<size_t> m_deliveredCount;  ///< Number of events whose callbacks have returned.
+    std::atomic<uint32_t> m_droppedCount;  ///< Number of events dropped because the queue was full.
+    std::atomic<uint32_t> m_highWater;     ///< Largest queue depth observed by a producer.
+    TaskHandle_t m_taskHandle;             ///< Handle of the dispatcher task.
+
+    // Delete copy constructor and assignment operator
+    AccessoryEventDispatcher(const AccessoryEventDispatcher &)             = delete;
+    AccessoryEventDispatcher & operator=(const AccessoryEventDispatcher &) = delete;
+};
+
+#endif // CONFIG_A_M_EVENT_DISPATCHER_ENABLE
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdio.h>
+
+#include "AccessoryStorageInterface.hpp"
+
+/**
+ * @brief AccessoryStorageInterface kept in a file, for host builds and VFS mounted file systems.
+ */
+class AccessoryFileStorage : public AccessoryStorageInterface
+{
+public:
+    /**
+     * @brief Constructor for AccessoryFileStorage. Opens the file, creating it erased if it does not exist.
+     *
+     * @param path Path of the file.
+     * @param size Size of the storage in bytes.
+     */
+    AccessoryFileStorage(const char * path, size_t size);
+
+    /**
+     * @brief Destructor for AccessoryFileStorage. Closes the file.
+     */
+    ~AccessoryFileStorage();
+
+    /**
+     * @brief Gets the size of the storage.
+     *
+     * @return Size in bytes.
+     */
+    size_t getSize() override;
+
+    /**
+     * @brief Reads bytes from the file.
+     *
+     * @param offset Offset of the first byte.
+     * @param data Buffer receiving the bytes.
+     * @param length Number of bytes to read.
+     * @return True on success, false otherwise.
+     */
+    bool read(size_t offset, void * data, size_t length) override;
+
+    /**
+     * @brief Writes bytes to the file and flushes them.
+     *
+     * @param offset Offset of the first byte.
+     * @param data Bytes to write.
+     * @param length Number of bytes to write.
+     * @return True on success, false otherwise.
+     */
+    bool write(size_t offset, const void * data, size_t length) override;
+
+    /**
+     * @brief Fills a region of the file with 0xFF.
+     *
+     * @param offset Offset of the region.
+     * @param length Size of the region.
+     * @return True on success, false otherwise.
+     */
+    bool erase(size_t offset, size_t length) override;
+
+private:
+    FILE * m_file; ///< The open file, nullptr if it could not be opened.
+    size_t m_size; ///< Size of the storage in bytes.
+
+    // Delete copy constructor and assignment operator
+    AccessoryFileStorage(const AccessoryFileStorage &)             = delete;
+    AccessoryFileStorage & operator=(const AccessoryFileStorage &) = delete;
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Instrumented paths of an accessory.
+ */
+enum class AccessoryLatencyPath : uint8_t
+{
+    ACTUATION, ///< From button callback entry to the return of RelayModuleInterface::setPower().
+    REPORT,    ///< From the return of RelayModuleInterface::setPower() to the completion of the report callbacks.
+    RELOCK     ///< From the end of the unlock window to the start of the relock, door locks only.
+};
+
+/**
+ * @brief Summary of a latency histogram. Percentiles are the upper bound of the bucket they fall in.
+ */
+struct AccessoryLatencyStats
+{
+    uint32_t count; ///< Number of recorded samples.
+    uint32_t p50Us; ///< Median latency in microseconds.
+    uint32_t p99Us; ///< 99th percentile latency in microseconds.
+    uint32_t maxUs; ///< Largest recorded latency in microseconds.
+};
+
+/**
+ * @brief Log-scale latency histogram with constant-time recording.
+ *
+ * Bucket 0 holds samples of 0 us and bucket i holds samples in [2^(i-1), 2^i) us. The last bucket also collects
+ * everything above its lower bound.
+ */
+class AccessoryLatencyHistogram
+{
+public:
+    static constexpr size_t BUCKET_COUNT = 24; ///< Number of buckets, the last one starts at about 4 seconds.
+
+    /**
+     * @brief Constructor for AccessoryLatencyHistogram.
+     */
+    AccessoryLatencyHistogram();
+
+    /**
+     * @brief Records one sample. Safe to call from several tasks at once.
+     *
+     * @param latencyUs The latency in microseconds.
+     */
+    void record(uint32_t latencyUs);
+
+    /**
+     * @brief Computes the given percentile.
+     *
+     * @param percent The percentile, from 1 to 100.
+     * @return Upper bound in microseconds of the bucket holding the percentile, at most the largest sample.
+     */
+    uint32_t percentile(uint8_t percent) const;
+
+    /**
+     * @brief Gets the sample count, p50, p99 and maximum.
+     *
+     * @return The summary of the histogram.
+     */
+    AccessoryLatencyStats getStats() const;
+
+    /**
+     * @brief Clears all samples.
+     */
+    void reset();
+
+private:
+    std::atomic<uint32_t> m_buckets[BUCKET_COUNT]; ///< Number of samples per bucket.
+    std::atomic<uint32_t> m_count;                 ///< Total number of samples.
+    std::atomic<uint32_t> m_max;                   ///< Largest sample in microseconds.
+
+    // Delete copy constructor and assignment operator
+    AccessoryLatencyHistogram(const AccessoryLatencyHistogram &)             = delete;
+    AccessoryLatencyHistogram & operator=(const AccessoryLatencyHistogram &) = delete;
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <sdkconfig.h>
+
+#if CONFIG_A_M_STATE_STORE_PARTITION
+
+#include <esp_partition.h>
+
+#include "AccessoryStorageInterface.hpp"
+
+/**
+ * @brief AccessoryStorageInterface kept in a data partition of the SPI flash.
+ *
+ * The AccessoryStateStore erases one half of the storage at a time, so the partition size must be a multiple of
+ * twice the 4 KB flash sector.
+ */
+class AccessoryPartitionStorage : public AccessoryStorageInterface
+{
+public:
+    /**
+     * @brief Constructor for AccessoryPartitionStorage.
+     *
+     * @param label Label of the data partition in the partition table.
+     */
+    AccessoryPartitionStorage(const char * label);
+
+    /**
+     * @brief Gets the size of the partition.
+     *
+     * @return Size in bytes, 0 if the partition was not found.
+     */
+    size_t getSize() override;
+
+    /**
+     * @brief Reads bytes from the partition.
+     *
+     * @param offset Offset of the first byte.
+     * @param data Buffer receiving the bytes.
+     * @param length Number of bytes to read.
+     * @return True on success, false otherwise.
+     */
+    bool read(size_t offset, void * data, size_t length) override;
+
+    /**
+     * @brief Writes bytes to an erased region of the partition.
+     *
+     * @param offset Offset of the first byte.
+     * @param data Bytes to write.
+     * @param length Number of bytes to write.
+     * @return True on success, false otherwise.
+     */
+    bool write(size_t offset, const void * data, size_t length) override;
+
+    /**
+     * @brief Erases a sector aligned region of the partition.
+     *
+     * @param offset Offset of the region.
+     * @param length Size of the region.
+     * @return True on success, false otherwise.
+     */
+    bool erase(size_t offset, size_t length) override;
+
+private:
+    const esp_partition_t * m_partition; ///< The partition, nullptr if it was not found.
+};
+
+#endif // CONFIG_A_M_STATE_STORE_PARTITION
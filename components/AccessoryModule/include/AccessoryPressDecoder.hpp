@@ -0,0 +1,185 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <freertos/FreeRTOS.h>
+#include <sdkconfig.h>
+
+#include "AccessoryTimer.hpp"
+#include "StatelessButtonAccessoryInterface.hpp"
+
+/**
+ * @brief Timing profile of one button, in milliseconds.
+ *
+ * With maxPresses set to 1 the decoder is speculative: a short press is reported on release without waiting for
+ * a following press, or on the press itself when longPressMs is 0 too.
+ */
+struct AccessoryPressProfile
+{
+    uint16_t debounceMs      = CONFIG_A_M_PRESS_DECODER_DEBOUNCE_MS;   ///< Edges closer than this to the previous one are ignored.
+    uint16_t multiPressGapMs = CONFIG_A_M_PRESS_DECODER_GAP_MS;        ///< Longest release between presses of a sequence.
+    uint16_t longPressMs     = CONFIG_A_M_PRESS_DECODER_LONG_PRESS_MS; ///< Hold time of a long press, 0 to disable.
+    uint16_t repeatMs        = CONFIG_A_M_PRESS_DECODER_REPEAT_MS;     ///< Period of LongPressRepeat, 0 to disable.
+    uint8_t maxPresses       = CONFIG_A_M_PRESS_DECODER_MAX_PRESSES;   ///< Presses after which a sequence is reported at once.
+};
+
+/**
+ * @brief Decodes raw button edges into single, double, N-press and long press sequences.
+ *
+ * A sequence is reported once the button stayed released for multiPressGapMs, or as soon as it reaches
+ * maxPresses. Holding the button for longPressMs reports LongPress, then LongPressRepeat every repeatMs and
+ * LongPressRelease when it is released.
+ *
+ * edge() must be called from a single task, not from an interrupt. The decoder arms a single timer on the shared
+ * AccessoryTimerService and calls back from its task only, in the order the presses were decoded: presses decoded
+ * on an edge are queued and the timer is fired at once to deliver them. When the timer service is full the
+ * sequence in progress is abandoned.
+ */
+class AccessoryPressDecoder
+{
+public:
+    /**
+     * @brief Type definition for the function receiving decoded presses.
+     *
+     * @param callbackParam Pointer to user-defined data.
+     * @param pressType The decoded press.
+     * @param pressCount Number of presses of the sequence, including the held one for long presses.
+     */
+    using Callback = void (*)(void * callbackParam, StatelessButtonAccessoryInterface::PressType pressType, uint8_t pressCount);
+
+    /**
+     * @brief Constructor for AccessoryPressDecoder.
+     *
+     * @param callback Function receiving decoded presses.
+     * @param callbackParam Parameter passed to the callback function.
+     */
+    AccessoryPressDecoder(Callback callback, void * callbackParam);
+
+    /**
+     * @brief Sets the timing profile. A sequence in progress is decoded with the new profile from its next edge.
+     *
+     * @param profile The profile.
+     */
+    void setProfile(const AccessoryPressProfile & profile);
+
+    /**
+     * @brief Gets the timing profile.
+     *
+     * @return The profile.
+     */
+    AccessoryPressProfile getProfile();
+
+    /**
+     * @brief Feeds a raw edge of the button.
+     *
+     * @param pressed True when the button went down, false when it was released.
+     */
+    void edge(bool pressed);
+
+    /**
+     * @brief Abandons the sequence in progress without reporting it.
+     */
+    void reset();
+
+    /**
+     * @brief Sets the type of accessory the decoder serves, used to attribute its callbacks in AccessoryTelemetry.
+     *
+     * @param ownerType The accessory type.
+     */
+    void setOwner(AccessoryType ownerType);
+
+private:
+    /**
+     * @brief State of the sequence in progress.
+     */
+    enum class State : uint8_t
+    {
+        Idle,     ///< No sequence in progress.
+        Pressed,  ///< Button down, waiting for the release or the long press time.
+        Released, ///< Button up, waiting for the next press or the end of the gap.
+        Holding,  ///< Long press reported, waiting for the release.
+        Reported  ///< Press reported on the down edge, waiting for the release.
+    };
+
+    /**
+     * @brief A decoded press waiting for the timer service task.
+     */
+    struct Pending
+    {
+        StatelessButtonAccessoryInterface::PressType pressType; ///< The decoded press.
+        uint8_t pressCount;                                     ///< Number of presses of the sequence.
+    };
+
+    static constexpr uint8_t PENDING_SIZE = 4; ///< Capacity of the queue of decoded presses.
+
+    /**
+     * @brief Delivers the queued presses, and fires at the long press time, every repeat period and at the end
+     * of the gap.
+     *
+     * @param instance Pointer to the AccessoryPressDecoder object.
+     */
+    static void timerCallback(void * instance);
+
+    /**
+     * @brief Advances the sequence if its deadline passed, queuing the press it decodes. Must be called with
+     * m_lock held.
+     *
+     * @param nowUs AccessoryClock time in microseconds.
+     */
+    void expire(int64_t nowUs);
+
+    /**
+     * @brief Queues a decoded press for the timer service task. Must be called with m_lock held.
+     *
+     * @param pressType The decoded press.
+     * @param pressCount Number of presses of the sequence.
+     * @return True if the press was queued, false if the queue is full.
+     */
+    bool push(StatelessButtonAccessoryInterface::PressType pressType, uint8_t pressCount);
+
+    /**
+     * @brief Gets the time the timer must fire at. Must be called with m_lock held.
+     *
+     * @return AccessoryClock time in microseconds, 0 when nothing is due.
+     */
+    int64_t wakeTime();
+
+    /**
+     * @brief Arms the timer at the wake time. Must be called without m_lock held.
+     */
+    void rearm();
+
+    /**
+     * @brief Computes a deadline.
+     *
+     * @param delayMs Delay in milliseconds, 0 for no deadline.
+     * @param baseUs AccessoryClock time in microseconds the delay starts from.
+     * @return AccessoryClock time in microseconds, 0 for no deadline.
+     */
+    static int64_t deadline(uint16_t delayMs, int64_t baseUs);
+
+    /**
+     * @brief Gets the press type reporting a sequence of short presses.
+     *
+     * @param pressCount Number of presses.
+     * @return SinglePress, DoublePress or MultiPress.
+     */
+    static StatelessButtonAccessoryInterface::PressType sequenceType(uint8_t pressCount);
+
+    Callback m_callback;             ///< Function receiving decoded presses.
+    void * m_callbackParam;          ///< Parameter passed to the callback function.
+    AccessoryPressProfile m_profile; ///< Timing profile.
+    State m_state;                   ///< State of the sequence in progress.
+    uint8_t m_pressCount;            ///< Presses of the sequence in progress.
+    int64_t m_lastEdgeUs;            ///< AccessoryClock time of the last accepted edge.
+    int64_t m_deadlineUs;            ///< Long press, repeat or gap deadline of the sequence, 0 for none.
+    Pending m_pending[PENDING_SIZE]; ///< Decoded presses waiting for the timer service task.
+    uint8_t m_pendingHead;           ///< Index of the oldest queued press.
+    uint8_t m_pendingCount;          ///< Number of queued presses.
+    portMUX_TYPE m_lock;             ///< Protects the profile, the sequence state and the queued presses.
+    AccessoryTimer m_timer;          ///< Timer of the long press, repeat and gap times.
+
+    // Delete copy constructor and assignment operator
+    AccessoryPressDecoder(const AccessoryPressDecoder &)             = delete;
+    AccessoryPressDecoder & operator=(const AccessoryPressDecoder &) = delete;
+};
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <new>
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+#include <utility>
+
+#include <sdkconfig.h>
+
+#include "AccessoryEvent.hpp"
+#include "AccessoryStateStore.hpp"
+#include "BaseAccessoryInterface.hpp"
+
+/**
+ * @brief Smallest power of two of at least size, the number of buckets of the AccessoryRegistry endpoint index.
+ */
+constexpr size_t accessoryRegistryIndexSize(size_t size, size_t power = 1)
+{
+    return power >= size ? power : accessoryRegistryIndexSize(size, power * 2);
+}
+
+/**
+ * @brief Owns the accessories of a device, built in a preallocated arena and looked up by endpoint id.
+ *
+ * emplace() constructs an accessory in the arena and sets its accessory id to the endpoint id, so no accessory
+ * lives on the heap. The slot table is kept grouped by accessory type: bulk operations and per-type iteration walk
+ * a contiguous array of pointers, and accessories() can be handed to AccessoryStateStore::restore() or
+ * SceneExecutor as is. Endpoint ids are mapped to slots by an open addressing hash index, a lookup costs one or
+ * two probes.
+ *
+ * Accessories must be registered from a single task before the registry is shared. Lookups, iteration and the
+ * bulk operations do not change the registry and may then run from any task. Accessories are destroyed with the
+ * registry; there is no removal.
+ */
+class AccessoryRegistry
+{
+public:
+    static constexpr size_t MAX_ACCESSORIES = CONFIG_A_M_REGISTRY_MAX_ACCESSORIES; ///< Maximum number of accessories.
+    static constexpr size_t ARENA_SIZE      = CONFIG_A_M_REGISTRY_ARENA_SIZE;      ///< Bytes the accessories are built in.
+
+    /**
+     * @brief Gets the registry owned by the module.
+     *
+     * @return The registry instance.
+     */
+    static AccessoryRegistry & instance();
+
+    /**
+     * @brief Constructor for AccessoryRegistry.
+     */
+    AccessoryRegistry();
+
+    /**
+     * @brief Destructor for AccessoryRegistry. Destroys the accessories in the reverse order of registration.
+     */
+    ~AccessoryRegistry();
+
+    /**
+     * @brief Constructs an accessory in the arena and registers it.
+     *
+     * @tparam Accessory The concrete accessory class.
+     * @param endpointId Endpoint id of the accessory, also set as its accessory id.
+     * @param args Arguments of the accessory constructor.
+     * @return The accessory, nullptr if the endpoint id is taken or the registry or its arena is full.
+     */
+    template <typename Accessory, typename... Args>
+    Accessory * emplace(uint16_t endpointId, Args &&... args)
+    {
+        static_assert(std::is_base_of<BaseAccessoryInterface, Accessory>::value, "Accessory must implement BaseAccessoryInterface");
+        static_assert(alignof(Accessory) <= alignof(max_align_t), "Accessory is over-aligned for the arena");
+
+        void * memory = allocate(endpointId, sizeof(Accessory), alignof(Accessory));
+        if (!memory)
+        {
+            return nullptr;
+        }
+        Accessory * accessory = new (memory) Accessory(std::forward<Args>(args)...);
+        add(endpointId, accessory);
+        return accessory;
+    }
+
+    /**
+     * @brief Finds an accessory by endpoint id.
+     *
+     * @param endpointId Endpoint id of the accessory.
+     * @return The accessory, nullptr if none has the endpoint id.
+     */
+    BaseAccessoryInterface * find(uint16_t endpointId) const;
+
+    /**
+     * @brief Gets the number of accessories.
+     *
+     * @return The number of accessories.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Gets the accessories, grouped by type in AccessoryType order.
+     *
+     * @return size() accessories.
+     */
+    BaseAccessoryInterface * const * accessories() const;
+
+    /**
+     * @brief Gets the accessories of one type.
+     *
+     * @param type The accessory type.
+     * @param count Receives the number of accessories of the type.
+     * @return The first accessory of the type, followed by the others.
+     */
+    BaseAccessoryInterface * const * accessories(AccessoryType type, size_t & count) const;
+
+    /**
+     * @brief Calls a function for every accessory, grouped by type.
+     *
+     * @param function Function called with a BaseAccessoryInterface pointer.
+     */
+    template <typename Function>
+    void forEach(Function function) const
+    {
+        for (size_t i = 0; i < m_count; i++)
+        {
+            function(m_slots[i]);
+        }
+    }
+
+    /**
+     * @brief Calls a function for every accessory of one type.
+     *
+     * @param type The accessory type.
+     * @param function Function called with a BaseAccessoryInterface pointer.
+     */
+    template <typename Function>
+    void forEachOfType(AccessoryType type, Function function) const
+    {
+        uint8_t index = static_cast<uint8_t>(type);
+        for (size_t i = m_typeStart[index]; i < m_typeStart[index + 1]; i++)
+        {
+            function(m_slots[i]);
+        }
+    }
+
+    /**
+     * @brief Runs the identify pattern of every accessory.
+     */
+    void identifyAll();
+
+    /**
+     * @brief Gets the current state of every accessory that has one.
+     *
+     * @param states Receives the states, grouped by type.
+     * @param maxStates Capacity of states.
+     * @return Number of states written.
+     */
+    size_t snapshotAll(AccessoryStateRecord * states, size_t maxStates) const;
+
+    /**
+     * @brief Switches off every light, fan, switch and plugin that is on, without reporting.
+     *
+     * The accessories are driven with BaseAccessoryInterface::applyState(), so the state store is updated and the
+     * change events are passed to the callback instead of the report callbacks of the accessories.
+     *
+     * @param callback Function receiving the change event of every accessory switched off, may be nullptr.
+     * @param callbackParam Optional parameter for the callback function.
+     * @return Number of accessories switched off.
+     */
+    size_t allOff(BaseAccessoryInterface::EventCallback callback = nullptr, void * callbackParam = nullptr) const;
+
+    /**
+     * @brief Gets the bytes of the arena used by the accessories, to size CONFIG_A_M_REGISTRY_ARENA_SIZE.
+     *
+     * @return The used bytes, including alignment padding.
+     */
+    size_t getArenaUsed() const;
+
+private:
+    static constexpr size_t INDEX_SIZE  = accessoryRegistryIndexSize(2 * MAX_ACCESSORIES); ///< Index at most half full.
+    static constexpr uint16_t NO_SLOT   = 0xFFFF;                                          ///< Marks an empty bucket.
+    static constexpr size_t TYPE_BOUNDS = ACCESSORY_TYPE_COUNT + 1;                        ///< Entries of m_typeStart.
+
+    static_assert(MAX_ACCESSORIES < NO_SLOT, "Slot indices must fit the endpoint index");
+
+    /**
+     * @brief One bucket of the endpoint index.
+     */
+    struct IndexEntry
+    {
+        uint16_t endpointId; ///< Endpoint id of the accessory.
+        uint16_t slot;       ///< Its index in m_slots, NO_SLOT if the bucket is empty.
+    };
+
+    /**
+     * @brief Checks that an accessory can be registered and reserves its memory in the arena.
+     *
+     * @param endpointId Endpoint id of the accessory.
+     * @param size Size of the accessory.
+     * @param alignment Alignment of the accessory.
+     * @return The memory, nullptr if the accessory cannot be registered.
+     */
+    void * allocate(uint16_t endpointId, size_t size, size_t alignment);
+
+    /**
+     * @brief Inserts a constructed accessory in its type group and in the endpoint index.
+     *
+     * @param endpointId Endpoint id of the accessory.
+     * @param accessory The accessory.
+     */
+    void add(uint16_t endpointId, BaseAccessoryInterface * accessory);
+
+    /**
+     * @brief Gets the first bucket to probe for an endpoint id.
+     *
+     * @param endpointId The endpoint id.
+     * @return Index in m_index.
+     */
+    static size_t bucket(uint16_t endpointId);
+
+    alignas(max_align_t) uint8_t m_arena[ARENA_SIZE];    ///< Memory the accessories are constructed in.
+    size_t m_arenaUsed;                                  ///< Bytes of the arena in use.
+    BaseAccessoryInterface * m_slots[MAX_ACCESSORIES];   ///< Accessories, grouped by type.
+    BaseAccessoryInterface * m_created[MAX_ACCESSORIES]; ///< Accessories in the order they were constructed.
+    size_t m_count;                                      ///< Number of accessories.
+    uint16_t m_typeStart[TYPE_BOUNDS];                   ///< First slot of every type, then m_count.
+    IndexEntry m_index[INDEX_SIZE];                      ///< Endpoint id to slot index.
+
+    // Delete copy constructor and assignment operator
+    AccessoryRegistry(const AccessoryRegistry &)             = delete;
+    AccessoryRegistry & operator=(const AccessoryRegistry &) = delete;
+};
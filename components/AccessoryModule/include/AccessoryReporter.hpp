@@ -0,0 +1,148 @@
+#pragma once
+
+#include <atomic>
+
+#include <sdkconfig.h>
+
+#include "AccessoryEvent.hpp"
+#include "AccessoryLatencyHistogram.hpp"
+#include "BaseAccessoryInterface.hpp"
+
+/**
+ * @brief Delivers the change events of one accessory to the application.
+ *
+ * Holds the accessory identifier and both the typed event callback and the legacy report callback, which is
+ * invoked as a thin adapter after the event callback.
+ *
+ * Accessories are not copyable, so a reporter keeps a stable address for the events queued by the dispatcher.
+ */
+class AccessoryReporter
+{
+public:
+    /**
+     * @brief Constructor for AccessoryReporter.
+     *
+     * @param accessoryType Kind of accessory owning the reporter.
+     */
+    AccessoryReporter(AccessoryType accessoryType);
+
+    /**
+     * @brief Destructor for AccessoryReporter. Waits until queued events of this reporter have been delivered.
+     */
+    ~AccessoryReporter();
+
+    /**
+     * @brief Sets the legacy report callback.
+     *
+     * @param callback The callback function.
+     * @param callbackParam Optional parameter for the callback function.
+     */
+    void setReportCallback(BaseAccessoryInterface::ReportCallback callback, void * callbackParam);
+
+    /**
+     * @brief Sets the typed event callback.
+     *
+     * @param callback The callback function.
+     * @param callbackParam Optional parameter for the callback function.
+     */
+    void setEventCallback(BaseAccessoryInterface::EventCallback callback, void * callbackParam);
+
+    /**
+     * @brief Sets the identifier carried by the events.
+     *
+     * @param accessoryId The identifier.
+     */
+    void setAccessoryId(uint16_t accessoryId);
+
+    /**
+     * @brief Gets the identifier carried by the events.
+     *
+     * @return The identifier.
+     */
+    uint16_t getAccessoryId() const;
+
+    /**
+     * @brief Sets the store updated with every reported event.
+     *
+     * @param stateStore The store, nullptr to detach.
+     */
+    void setStateStore(AccessoryStateStore * stateStore);
+
+    /**
+     * @brief Gets the kind of accessory owning the reporter.
+     *
+     * @return The accessory type.
+     */
+    AccessoryType getAccessoryType() const;
+
+    /**
+     * @brief Creates an event for this accessory with no attribute flagged.
+     *
+     * @return The event, to be filled in and passed to report().
+     */
+    AccessoryEvent makeEvent() const;
+
+    /**
+     * @brief Reports an event to the application.
+     *
+     * With CONFIG_A_M_EVENT_DISPATCHER_ENABLE the event is queued for the dispatcher task, otherwise it is
+     * delivered in the calling context.
+     *
+     * @param event The event, created with makeEvent().
+     */
+    void report(const AccessoryEvent & event);
+
+    /**
+     * @brief Updates the state store with an event without delivering it, for changes reported by the caller.
+     *
+     * @param event The event, created with makeEvent().
+     */
+    void save(const AccessoryEvent & event);
+
+    /**
+     * @brief Delivers an event to the event callback, then to the report callback, in the calling context.
+     *
+     * @param event The event to deliver.
+     */
+    void deliver(const AccessoryEvent & event);
+
+#if CONFIG_A_M_LATENCY_STATS
+    /**
+     * @brief Marks the entry of a button callback, starting the actuation latency measurement.
+     */
+    void markInput();
+
+    /**
+     * @brief Marks the return of RelayModuleInterface::setPower(), completing the actuation latency measurement
+     * started by markInput() and starting the report latency measurement.
+     */
+    void markActuated();
+#else
+    void markInput() {}
+    void markActuated() {}
+#endif
+
+    /**
+     * @brief Gets the latency statistics of a path.
+     *
+     * @param path The instrumented path.
+     * @return The statistics, all zero unless CONFIG_A_M_LATENCY_STATS is enabled.
+     */
+    AccessoryLatencyStats getLatencyStats(AccessoryLatencyPath path) const;
+
+private:
+    AccessoryType m_accessoryType;                           ///< Kind of accessory owning the reporter.
+    uint16_t m_accessoryId;                                  ///< Identifier carried by the events.
+    BaseAccessoryInterface::ReportCallback m_reportCallback; ///< Legacy callback function for reporting.
+    void * m_reportCallbackParam;                            ///< Parameter passed to the report callback.
+    BaseAccessoryInterface::EventCallback m_eventCallback;   ///< Callback function receiving typed events.
+    void * m_eventCallbackParam;                             ///< Parameter passed to the event callback.
+    AccessoryStateStore * m_stateStore;                      ///< Store persisting the reported state, may be nullptr.
+
+#if CONFIG_A_M_LATENCY_STATS
+    AccessoryLatencyHistogram m_actuationLatency; ///< Button callback entry to setPower() return.
+    AccessoryLatencyHistogram m_reportLatency;    ///< setPower() return to report callback completion.
+    std::atomic<uint32_t> m_inputTime;            ///< Low 32 bits of the esp_timer time of markInput(), 0 if none.
+    std::atomic<uint32_t> m_actuatedTime;         ///< Low 32 bits of the esp_timer time of markActuated(), 0 if none.
+#endif
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <sdkconfig.h>
+
+#include "BaseAccessoryInterface.hpp"
+
+/**
+ * @brief In-flight state of one accessory, retained across warm restarts.
+ */
+struct AccessoryRetainedRecord
+{
+    uint16_t accessoryId;    ///< Identifier set with setAccessoryId().
+    uint8_t accessoryType;   ///< AccessoryType of the accessory.
+    int8_t direction;        ///< Blind motion: 1 when moving up, -1 when moving down, 0 when stopped.
+    uint16_t startPosition;  ///< Blind position at timeUs, or the resting position, in hundredths of a percent.
+    uint16_t targetPosition; ///< Blind target in hundredths of a percent.
+    int64_t timeUs;          ///< Retained clock time of the blind motion start or the door relock deadline, 0 if none.
+    uint32_t checksum;       ///< Checksum of the fields above, set by AccessoryRetainedState::save().
+};
+
+/**
+ * @brief Keeps the in-flight state of blind motions and door unlock windows in RTC slow memory.
+ *
+ * The records live in RTC_NOINIT memory, which survives software, watchdog, panic and OTA resets but not a power
+ * cycle. Every record carries its own checksum, so the garbage found after power-on and a record torn by a reset
+ * are both ignored. Saving costs a RAM write and never touches flash.
+ *
+ * Times are read from the RTC timer, which keeps counting across warm restarts. The motors stop when the chip
+ * resets, so a blind resumes from the position it had at the reset, estimated from the uptime of the new boot.
+ *
+ * With CONFIG_A_M_RETAINED_STATE disabled nothing is saved and nothing is found.
+ */
+class AccessoryRetainedState
+{
+public:
+#if CONFIG_A_M_RETAINED_STATE
+    static constexpr size_t MAX_RECORDS = CONFIG_A_M_RETAINED_STATE_MAX_RECORDS; ///< Maximum number of accessories.
+
+    /**
+     * @brief Saves the record of an accessory, replacing the previous one.
+     *
+     * Records of accessory id 0 are not saved, so every accessory needs a distinct id set first.
+     *
+     * @param record The record, its checksum is computed here.
+     */
+    static void save(const AccessoryRetainedRecord & record);
+
+    /**
+     * @brief Gets the valid record of an accessory.
+     *
+     * @param accessoryId Identifier of the accessory.
+     * @param record Receives the record.
+     * @return True if a record with a valid checksum exists, false otherwise.
+     */
+    static bool find(uint16_t accessoryId, AccessoryRetainedRecord & record);
+#else
+    static void save(const AccessoryRetainedRecord &) {}
+    static bool find(uint16_t, AccessoryRetainedRecord &) { return false; }
+#endif
+
+    /**
+     * @brief Gets the time of the clock that keeps counting across warm restarts.
+     *
+     * @return Time in microseconds.
+     */
+    static int64_t now();
+
+    /**
+     * @brief Gets the time at which the chip last reset.
+     *
+     * @return Retained clock time in microseconds.
+     */
+    static int64_t resetTime();
+
+    /**
+     * @brief Resumes the operations in flight when the chip reset, in one pass.
+     *
+     * Call after AccessoryStateStore::restore() and after setting the travel times, so the retained state, which
+     * is more recent than the stored one, wins.
+     *
+     * @param accessories The accessories, with their ids set.
+     * @param count Number of accessories.
+     * @return Number of accessories that had retained state.
+     */
+    static size_t resume(BaseAccessoryInterface * const * accessories, size_t count);
+};
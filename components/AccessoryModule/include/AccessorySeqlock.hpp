@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+#include <freertos/FreeRTOS.h>
+
+/**
+ * @brief Publishes a small trivially copyable value to reader tasks, which get a consistent copy without a lock.
+ *
+ * A sequence counter is odd while a write is in progress; read() copies the value and retries when the counter was
+ * odd or changed meanwhile, so it always returns the value of one complete write(). Writers run in a critical
+ * section: a reader never spins behind a preempted writer, and writes from several tasks are serialized. The value
+ * is kept in 32-bit atomic words stored with release and loaded with acquire ordering, without standalone fences:
+ * a reader that sees any word of a write also sees the odd counter stored before it, so the ordering is expressed
+ * on the atomics alone and ThreadSanitizer checks it.
+ *
+ * @tparam T The published value.
+ */
+template <typename T>
+class AccessorySeqlock
+{
+    static_assert(std::is_trivially_copyable<T>::value, "AccessorySeqlock publishes trivially copyable values only");
+
+public:
+    /**
+     * @brief Constructor for AccessorySeqlock.
+     *
+     * @param value The initial value.
+     */
+    explicit AccessorySeqlock(const T & value = T()) : m_sequence(0), m_writeLock(portMUX_INITIALIZER_UNLOCKED)
+    {
+        storeWords(value);
+    }
+
+    /**
+     * @brief Gets the value of the last complete write.
+     *
+     * @return A copy of the value.
+     */
+    T read() const
+    {
+        uint32_t words[WORD_COUNT];
+        uint32_t sequence;
+        do
+        {
+            sequence = m_sequence.load(std::memory_order_acquire);
+            for (size_t i = 0; i < WORD_COUNT; i++)
+            {
+                words[i] = m_words[i].load(std::memory_order_acquire);
+            }
+        } while ((sequence & 1) != 0 || m_sequence.load(std::memory_order_relaxed) != sequence);
+
+        T value;
+        memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+    /**
+     * @brief Publishes a new value.
+     *
+     * @param value The value.
+     */
+    void write(const T & value)
+    {
+        portENTER_CRITICAL(&m_writeLock);
+        uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        storeWords(value);
+        m_sequence.store(sequence + 2, std::memory_order_release);
+        portEXIT_CRITICAL(&m_writeLock);
+    }
+
+private:
+    static constexpr size_t WORD_COUNT = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t); ///< Words holding the value.
+
+    /**
+     * @brief Stores the words of a value.
+     *
+     * @param value The value.
+     */
+    void storeWords(const T & value)
+    {
+        uint32_t words[WORD_COUNT] = {};
+        memcpy(words, &value, sizeof(T));
+        for (size_t i = 0; i < WORD_COUNT; i++)
+        {
+            m_words[i].store(words[i], std::memory_order_release);
+        }
+    }
+
+    std::atomic<uint32_t> m_sequence;          ///< Even when idle, odd while a write is in progress.
+    std::atomic<uint32_t> m_words[WORD_COUNT]; ///< The value.
+    portMUX_TYPE m_writeLock;                  ///< Serializes the writers.
+
+    // Delete copy constructor and assignment operator
+    AccessorySeqlock(const AccessorySeqlock &)             = delete;
+    AccessorySeqlock & operator=(const AccessorySeqlock &) = delete;
+};
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <freertos/FreeRTOS.h>
+#include <sdkconfig.h>
+
+#include "AccessoryEvent.hpp"
+#include "AccessoryStorageInterface.hpp"
+#include "AccessoryTimer.hpp"
+#include "BaseAccessoryInterface.hpp"
+
+/**
+ * @brief Persisted state of one accessory, 8 bytes.
+ */
+struct AccessoryStateRecord
+{
+    /**
+     * @brief Bits of flags.
+     */
+    enum Flag : uint8_t
+    {
+        FLAG_POWER_ON = 1 << 0, ///< Light, fan, switch or plugin is on.
+        FLAG_UNLOCKED = 1 << 1  ///< Door lock is unlocked.
+    };
+
+    uint16_t accessoryId;     ///< Identifier set with setAccessoryId().
+    uint8_t accessoryType;    ///< AccessoryType of the accessory.
+    uint8_t flags;            ///< Flag bits.
+    uint16_t currentPosition; ///< Blind position in hundredths of a percent.
+    uint16_t targetPosition;  ///< Blind target in hundredths of a percent.
+};
+
+/**
+ * @brief Write-coalescing store of the accessory states.
+ *
+ * Accessories attached with setStateStore() update an in-memory record on every change event, including the
+ * intermediate ones flagged onlySave. Changed records are written once the accessories have been quiet for the
+ * debounce delay, so a blind move costs one write instead of one per progress report.
+ *
+ * The storage is split in two banks holding an append-only journal of 12 byte entries after an 8 byte header.
+ * When the active bank is full, the current records are compacted into the other bank, whose header is written
+ * last so a power loss during compaction leaves the previous bank valid.
+ *
+ * Records are keyed by accessory id, so every attached accessory needs a distinct id, and the store must outlive
+ * the accessories attached to it. Flushes run on the timer service task; a compaction erases half of the storage
+ * and can delay other timers by the erase time.
+ */
+class AccessoryStateStore
+{
+public:
+    static constexpr size_t MAX_RECORDS = CONFIG_A_M_STATE_STORE_MAX_RECORDS; ///< Maximum number of accessories.
+
+    /**
+     * @brief Statistics of the store.
+     */
+    struct Stats
+    {
+        uint32_t updates;     ///< Change events applied to the records.
+        uint32_t flushes;     ///< Flushes that wrote at least one entry.
+        uint32_t writes;      ///< Journal entries written.
+        uint32_t compactions; ///< Bank switches.
+        uint32_t errors;      ///< Failed storage operations.
+        uint32_t restoreUs;   ///< Duration of the last restore() in microseconds.
+        int64_t restoredAtUs; ///< Time since boot in microseconds at the end of the last restore().
+    };
+
+    /**
+     * @brief Constructor for AccessoryStateStore.
+     *
+     * @param storage Storage holding the journal. Each half must hold a header and more than MAX_RECORDS entries.
+     * @param debounceMs Quiet time in milliseconds after the last change before the records are written.
+     */
+    AccessoryStateStore(AccessoryStorageInterface * storage, uint32_t debounceMs = CONFIG_A_M_STATE_STORE_DEBOUNCE_MS);
+
+    /**
+     * @brief Destructor for AccessoryStateStore. Writes pending changes.
+     */
+    ~AccessoryStateStore();
+
+    /**
+     * @brief Reads the journal into memory. Call once before attaching accessories.
+     *
+     * @return True if a valid journal was found, false if the storage is empty or unreadable.
+     */
+    bool load();
+
+    /**
+     * @brief Gets the stored state of an accessory.
+     *
+     * @param accessoryId Identifier of the accessory.
+     * @param record Receives the state.
+     * @return True if a record exists for the accessory, false otherwise.
+     */
+    bool getRecord(uint16_t accessoryId, AccessoryStateRecord & record);
+
+    /**
+     * @brief Applies the stored state of the given accessories in one pass.
+     *
+     * Call after load() and before setting the callbacks: no report or event fires, nothing is logged per
+     * accessory and the store is not updated. Stats::restoredAtUs tells the boot-to-relay time.
+     *
+     * @param accessories The accessories, with their ids set.
+     * @param count Number of accessories.
+     * @return Number of accessories whose state was restored.
+     */
+    size_t restore(BaseAccessoryInterface * const * accessories, size_t count);
+
+    /**
+     * @brief Applies a change event to the record of its accessory and schedules a write.
+     *
+     * Called by the accessories attached with setStateStore(). Events without persisted attributes are ignored.
+     * When the timer service is full the change is written at once instead of being coalesced.
+     *
+     * @param event The change event.
+     */
+    void update(const AccessoryEvent & event);
+
+    /**
+     * @brief Writes the changed records now.
+     *
+     * @return True if every changed record was written, false otherwise.
+     */
+    bool flush();
+
+    /**
+     * @brief Gets the statistics of the store.
+     *
+     * @return The statistics.
+     */
+    Stats getStats();
+
+private:
+    /**
+     * @brief Journal entry: a record protected by a marker and a CRC.
+     */
+    struct Entry
+    {
+        uint16_t marker;             ///< ENTRY_MARKER, tells a written entry from erased storage.
+        AccessoryStateRecord record; ///< The record.
+        uint16_t crc;                ///< CRC-16 of marker and record.
+    };
+
+    /**
+     * @brief Bank header, written after the bank content.
+     */
+    struct BankHeader
+    {
+        uint32_t magic;      ///< BANK_MAGIC.
+        uint32_t generation; ///< Incremented by every compaction, the valid bank with the highest one is active.
+    };
+
+    static constexpr uint16_t ENTRY_MARKER = 0xA55A;     ///< Marker of a written entry.
+    static constexpr uint32_t BANK_MAGIC   = 0x4A534D41; ///< "AMSJ" in little endian.
+
+    /**
+     * @brief Timer callback writing the changed records once the accessories are quiet.
+     *
+     * @param instance Pointer to the instance of the class.
+     */
+    static void debounceCallback(void * instance);
+
+    /**
+     * @brief Computes the CRC of an entry.
+     *
+     * @param entry The entry.
+     * @return CRC-16/CCITT of marker and record.
+     */
+    static uint16_t entryCrc(const Entry & entry);
+
+    /**
+     * @brief Checks whether an entry location was never written since its bank was erased.
+     *
+     * @param entry The entry read from the storage.
+     * @return True if every byte is 0xFF, false otherwise.
+     */
+    static bool isErased(const Entry & entry);
+
+    /**
+     * @brief Finds the slot of an accessory, optionally creating it. Must be called with m_lock held.
+     *
+     * @param accessoryId Identifier of the accessory.
+     * @param create True to create the slot if it does not exist.
+     * @return Index of the slot, -1 if it does not exist or the store is full.
+     */
+    int findSlot(uint16_t accessoryId, bool create);
+
+    /**
+     * @brief Appends an entry to the active bank, compacting first if it is full.
+     *
+     * @param record The record to append.
+     * @return True on success, false otherwise.
+     */
+    bool append(const AccessoryStateRecord & record);
+
+    /**
+     * @brief Writes all records into the other bank and makes it active.
+     *
+     * @return True on success, false otherwise.
+     */
+    bool compact();
+
+    /**
+     * @brief Replays the entries of a bank into the records.
+     *
+     * @param bank Index of the bank.
+     * @return Offset within the bank of the first free entry.
+     */
+    size_t replay(uint8_t bank);
+
+    AccessoryStorageInterface * m_storage;       ///< Storage holding the journal.
+    uint32_t m_debounceMs;                       ///< Quiet time before writing.
+    size_t m_bankSize;                           ///< Size of each bank in bytes.
+    uint8_t m_activeBank;                        ///< Bank receiving new entries.
+    uint32_t m_generation;                       ///< Generation of the active bank, 0 if none was written yet.
+    size_t m_writeOffset;                        ///< Offset within the active bank of the next entry.
+    AccessoryStateRecord m_records[MAX_RECORDS]; ///< Latest state of every known accessory.
+    bool m_dirty[MAX_RECORDS];                   ///< True for records changed since the last flush.
+    size_t m_recordCount;                        ///< Number of used slots in m_records.
+    Stats m_stats;                               ///< Statistics of the store.
+    portMUX_TYPE m_lock;                         ///< Protects the records, dirty flags and statistics.
+    std::atomic<bool> m_flushing;                ///< Set while a flush owns the storage.
+    AccessoryTimer m_debounceTimer;              ///< Timer firing once the accessories are quiet.
+
+    // Delete copy constructor and assignment operator
+    AccessoryStateStore(const AccessoryStateStore &)             = delete;
+    AccessoryStateStore & operator=(const AccessoryStateStore &) = delete;
+};
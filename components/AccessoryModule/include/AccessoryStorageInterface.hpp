@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stddef.h>
+
+/**
+ * @brief Interface of the non-volatile storage holding the AccessoryStateStore journal.
+ *
+ * The storage follows flash semantics: erased bytes read as 0xFF and a byte is written at most once between two
+ * erases of its region.
+ */
+class AccessoryStorageInterface
+{
+public:
+    virtual ~AccessoryStorageInterface() = default;
+
+    /**
+     * @brief Gets the size of the storage.
+     *
+     * @return Size in bytes.
+     */
+    virtual size_t getSize() = 0;
+
+    /**
+     * @brief Reads bytes from the storage.
+     *
+     * @param offset Offset of the first byte.
+     * @param data Buffer receiving the bytes.
+     * @param length Number of bytes to read.
+     * @return True on success, false otherwise.
+     */
+    virtual bool read(size_t offset, void * data, size_t length) = 0;
+
+    /**
+     * @brief Writes bytes to an erased region of the storage.
+     *
+     * @param offset Offset of the first byte.
+     * @param data Bytes to write.
+     * @param length Number of bytes to write.
+     * @return True on success, false otherwise.
+     */
+    virtual bool write(size_t offset, const void * data, size_t length) = 0;
+
+    /**
+     * @brief Erases a region of the storage to 0xFF.
+     *
+     * @param offset Offset of the region, aligned to the erase size of the storage.
+     * @param length Size of the region, a multiple of the erase size of the storage.
+     * @return True on success, false otherwise.
+     */
+    virtual bool erase(size_t offset, size_t length) = 0;
+};
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <sdkconfig.h>
+
+#include "AccessoryEvent.hpp"
+
+/**
+ * @brief Tasks created by the module.
+ */
+enum class AccessoryTask : uint8_t
+{
+    TIMER_SERVICE,   ///< AccessoryTimerService task running all timer callbacks.
+    EVENT_DISPATCHER ///< AccessoryEventDispatcher task running the report and event callbacks.
+};
+
+static constexpr uint8_t ACCESSORY_TASK_COUNT = 2; ///< Number of AccessoryTask values.
+
+/**
+ * @brief Telemetry of one task created by the module.
+ */
+struct AccessoryTaskTelemetry
+{
+    const char * name;           ///< Task name, nullptr if the task was never created.
+    uint32_t stackSize;          ///< Configured stack size in bytes.
+    uint32_t stackHighWaterMark; ///< Smallest amount of free stack in bytes seen since the task started.
+    uint32_t runTime;            ///< FreeRTOS run time counter, 0 unless FreeRTOS run time stats are enabled.
+    uint32_t callbackCount;      ///< Number of accessory callbacks run by the task.
+    uint64_t callbackTimeUs;     ///< Total time in microseconds spent in accessory callbacks.
+};
+
+/**
+ * @brief Telemetry of one accessory type, aggregated over all instances.
+ */
+struct AccessoryTypeTelemetry
+{
+    uint16_t created;        ///< Number of accessories constructed.
+    uint16_t live;           ///< Number of accessories currently alive.
+    uint32_t callbackCount;  ///< Number of timer and dispatcher callbacks run for this type.
+    uint64_t callbackTimeUs; ///< Total time in microseconds spent in those callbacks.
+    uint32_t callbackMaxUs;  ///< Longest callback in microseconds.
+    uint32_t stackPeak;      ///< Deepest stack use in bytes, from the top of the task stack, measured across a callback.
+};
+
+/**
+ * @brief Aggregated telemetry of the module.
+ */
+struct AccessoryTelemetrySnapshot
+{
+    AccessoryTaskTelemetry tasks[ACCESSORY_TASK_COUNT]; ///< Indexed by AccessoryTask.
+    uint16_t tasksCreated;                              ///< Number of tasks created by the module, which never deletes them.
+    AccessoryTypeTelemetry types[ACCESSORY_TYPE_COUNT]; ///< Indexed by AccessoryType.
+};
+
+/**
+ * @brief Collects stack, CPU time and lifetime telemetry of the module tasks and the accessories they serve.
+ *
+ * Accessories share the timer service and dispatcher tasks, so stack use is attributed per accessory type by
+ * painting the unused part of the stack before each callback and scanning it afterwards. The peak of a type is
+ * the stack a task serving only accessories of that type would need.
+ *
+ * With CONFIG_A_M_TASK_TELEMETRY disabled the hooks compile to nothing and the snapshot is all zero.
+ */
+class AccessoryTelemetry
+{
+public:
+#if CONFIG_A_M_TASK_TELEMETRY
+    /**
+     * @brief Registers a task created by the module.
+     *
+     * @param task The task.
+     * @param name Name given to the task.
+     * @param handle Handle of the task.
+     * @param stackSize Stack size in bytes given to the task.
+     */
+    static void taskCreated(AccessoryTask task, const char * name, TaskHandle_t handle, uint32_t stackSize);
+
+    /**
+     * @brief Counts a constructed accessory.
+     *
+     * @param type Type of the accessory.
+     */
+    static void accessoryCreated(AccessoryType type);
+
+    /**
+     * @brief Counts a destroyed accessory.
+     *
+     * @param type Type of the accessory.
+     */
+    static void accessoryDestroyed(AccessoryType type);
+
+    /**
+     * @brief Called by a module task right before it runs an accessory callback.
+     *
+     * @param task The calling task.
+     * @return Start time to pass to endCallback().
+     */
+    static int64_t beginCallback(AccessoryTask task);
+
+    /**
+     * @brief Called by a module task right after an accessory callback returned.
+     *
+     * @param task The calling task.
+     * @param ownerType AccessoryType of the accessory served, ACCESSORY_TYPE_COUNT if unknown.
+     * @param startUs Value returned by beginCallback().
+     */
+    static void endCallback(AccessoryTask task, uint8_t ownerType, int64_t startUs);
+#else
+    static void taskCreated(AccessoryTask, const char *, TaskHandle_t, uint32_t) {}
+    static void accessoryCreated(AccessoryType) {}
+    static void accessoryDestroyed(AccessoryType) {}
+    static int64_t beginCallback(AccessoryTask) { return 0; }
+    static void endCallback(AccessoryTask, uint8_t, int64_t) {}
+#endif
+
+    /**
+     * @brief Gets a consistent copy of all counters.
+     *
+     * @return The snapshot, all zero unless CONFIG_A_M_TASK_TELEMETRY is enabled.
+     */
+    static AccessoryTelemetrySnapshot getSnapshot();
+
+    /**
+     * @brief Computes the stack size recommended for a task serving only accessories of one type.
+     *
+     * @param type The accessory type.
+     * @return Observed peak plus CONFIG_A_M_TASK_TELEMETRY_STACK_MARGIN, rounded up to 64 bytes, 0 if no callback ran.
+     */
+    static uint32_t recommendedStackSize(AccessoryType type);
+
+    /**
+     * @brief Computes the stack size recommended for a module task.
+     *
+     * @param task The task.
+     * @return Observed peak plus CONFIG_A_M_TASK_TELEMETRY_STACK_MARGIN, rounded up to 64 bytes, 0 if not created.
+     */
+    static uint32_t recommendedStackSize(AccessoryTask task);
+
+    /**
+     * @brief Logs the snapshot and the recommended stack sizes.
+     */
+    static void log();
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "AccessoryEvent.hpp"
+
+class AccessoryTimerService;
+
+/**
+ * @brief One-shot timer record scheduled on the shared AccessoryTimerService.
+ *
+ * The record is owned by the accessory that uses it, so arming a timer never allocates. Callbacks run in the
+ * context of the timer service task and may re-arm their own timer.
+ */
+class AccessoryTimer
+{
+public:
+    /**
+     * @brief Type definition for the function called when the timer expires.
+     *
+     * @param callbackParam Pointer to user-defined data.
+     */
+    using Callback = void (*)(void * callbackParam);
+
+    /**
+     * @brief Constructor for AccessoryTimer.
+     *
+     * @param callback Function called when the timer expires.
+     * @param callbackParam Parameter passed to the callback function.
+     */
+    AccessoryTimer(Callback callback, void * callbackParam);
+
+    /**
+     * @brief Destructor for AccessoryTimer. Cancels the timer and waits for a running callback to return.
+     */
+    ~AccessoryTimer();
+
+    /**
+     * @brief Arms the timer to expire after the given delay, replacing any pending expiry.
+     *
+     * @param delayMs Delay in milliseconds.
+     * @return True if the timer was armed, false if the timer service is full.
+     */
+    bool start(uint32_t delayMs);
+
+    /**
+     * @brief Arms the timer to expire at the given time, replacing any pending expiry.
+     *
+     * @param deadline AccessoryClock time in microseconds at which the timer expires.
+     * @return True if the timer was armed, false if the timer service is full.
+     */
+    bool startAt(int64_t deadline);
+
+    /**
+     * @brief Moves the expiry of an armed timer later, in constant time.
+     *
+     * The timer keeps its place in the service heap and is moved to the new expiry, without running its callback,
+     * when the previous one is reached. Behaves like start() if the timer is not armed or the new expiry is earlier.
+     *
+     * @param delayMs Delay in milliseconds from now.
+     * @return True if the timer is armed, false if the timer service is full.
+     */
+    bool extend(uint32_t delayMs);
+
+    /**
+     * @brief Cancels the timer.
+     *
+     * When called from another task while the callback is running, waits for the callback to return.
+     */
+    void cancel();
+
+    /**
+     * @brief Checks whether the timer is armed.
+     *
+     * @return True if the timer is waiting to expire, false otherwise.
+     */
+    bool isActive() const;
+
+    /**
+     * @brief Sets the type of accessory the timer serves, used to attribute its callbacks in AccessoryTelemetry.
+     *
+     * @param ownerType The accessory type.
+     */
+    void setOwner(AccessoryType ownerType);
+
+private:
+    friend class AccessoryTimerService;
+
+    Callback m_callback;    ///< Function called when the timer expires.
+    void * m_callbackParam; ///< Parameter passed to the callback function.
+    int64_t m_deadline;     ///< AccessoryClock time in microseconds at which the timer expires.
+    int64_t m_extended;     ///< Expiry set by extend(), later than m_deadline while an extension is pending.
+    int16_t m_heapIndex;    ///< Position in the timer service heap, -1 when not armed. Guarded by the service lock.
+    uint8_t m_ownerType;    ///< AccessoryType served by the timer, ACCESSORY_TYPE_COUNT if not set.
+
+    // Delete copy constructor and assignment operator
+    AccessoryTimer(const AccessoryTimer &)             = delete;
+    AccessoryTimer & operator=(const AccessoryTimer &) = delete;
+};
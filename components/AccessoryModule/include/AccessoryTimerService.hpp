@@ -0,0 +1,129 @@
+#pragma once
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "AccessoryTimer.hpp"
+
+/**
+ * @brief Single task that runs the timed behavior of all accessories.
+ *
+ * Armed timers are kept in a fixed-capacity min-heap ordered by deadline. The service task sleeps until the
+ * earliest deadline and runs the expired callbacks one after the other, so the number of tasks does not depend
+ * on the number of accessories.
+ *
+ * With CONFIG_A_M_VIRTUAL_TIME no task is created, the simulation drives the timers with advanceTo().
+ */
+class AccessoryTimerService
+{
+public:
+    /**
+     * @brief Gets the timer service, starting its task on first use.
+     *
+     * @return The timer service instance.
+     */
+    static AccessoryTimerService & instance();
+
+    /**
+     * @brief Arms a timer, replacing any pending expiry.
+     *
+     * @param timer The timer to arm.
+     * @param deadline AccessoryClock time in microseconds at which the timer expires.
+     * @return True if the timer was armed, false if the heap is full.
+     */
+    bool schedule(AccessoryTimer * timer, int64_t deadline);
+
+    /**
+     * @brief Moves the expiry of an armed timer later without touching the heap.
+     *
+     * @param timer The timer to extend.
+     * @param deadline AccessoryClock time in microseconds at which the timer expires.
+     * @return True if the timer is armed, false if it had to be scheduled and the heap is full.
+     */
+    bool extend(AccessoryTimer * timer, int64_t deadline);
+
+    /**
+     * @brief Disarms a timer and waits for its callback to return if it is running in another task.
+     *
+     * @param timer The timer to disarm.
+     */
+    void cancel(AccessoryTimer * timer);
+
+    /**
+     * @brief Checks whether a timer is armed. Its heap index moves on every sift, so it is read under the lock.
+     *
+     * @param timer The timer.
+     * @return True if the timer is waiting to expire, false otherwise.
+     */
+    bool isArmed(const AccessoryTimer * timer);
+
+    /**
+     * @brief Gets the number of armed timers.
+     *
+     * @return The number of timers waiting to expire.
+     */
+    size_t getActiveCount();
+
+#if CONFIG_A_M_VIRTUAL_TIME
+    /**
+     * @brief Moves the virtual clock forward, running every timer that expires up to the given time in order.
+     *
+     * The clock is set to each deadline before its callback runs, so callbacks observe the time they were armed
+     * for. Timers armed by callbacks for a time within the range run in the same call.
+     *
+     * @param time AccessoryClock time in microseconds to advance to.
+     */
+    void advanceTo(int64_t time);
+
+    /**
+     * @brief Gets the deadline of the earliest armed timer.
+     *
+     * @param deadline Set to the AccessoryClock time in microseconds of the earliest deadline.
+     * @return True if a timer is armed.
+     */
+    bool getNextDeadline(int64_t & deadline);
+#endif
+
+private:
+    /**
+     * @brief Constructor for AccessoryTimerService. Creates the service task.
+     */
+    AccessoryTimerService();
+
+    /**
+     * @brief Task that waits for the earliest deadline and runs expired callbacks.
+     *
+     * @param instance Pointer to the instance of the class.
+     */
+    static void serviceTask(void * instance);
+
+    /**
+     * @brief Runs the callback of an expired timer, outside the lock, with telemetry around it.
+     *
+     * @param timer The expired timer.
+     */
+    static void runCallback(AccessoryTimer * timer);
+
+    /**
+     * @brief Moves an expired timer to its extended expiry instead of running it. Must be called with m_lock held.
+     *
+     * @param timer The timer at the top of the heap.
+     * @return True if the timer was extended and moved, false if it must run.
+     */
+    bool deferExtended(AccessoryTimer * timer);
+
+    void siftUp(size_t index);
+    void siftDown(size_t index);
+    void removeAt(size_t index);
+    void place(AccessoryTimer * timer, size_t index);
+
+    AccessoryTimer * m_heap[CONFIG_A_M_TIMER_SERVICE_MAX_TIMERS]; ///< Armed timers ordered by deadline.
+    size_t m_count;                                               ///< Number of armed timers.
+    AccessoryTimer * volatile m_running;                          ///< Timer whose callback is currently running.
+    portMUX_TYPE m_lock;                                          ///< Protects the heap.
+    TaskHandle_t m_taskHandle;                                    ///< Handle of the service task.
+
+    // Delete copy constructor and assignment operator
+    AccessoryTimerService(const AccessoryTimerService &)             = delete;
+    AccessoryTimerService & operator=(const AccessoryTimerService &) = delete;
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <esp_log.h>
+#include <sdkconfig.h>
+
+#include "AccessoryEvent.hpp"
+
+/**
+ * @brief Codes of the hot path trace records. Keep in sync with tools/accessory_trace_decode.py.
+ */
+enum class AccessoryTraceCode : uint8_t
+{
+    POWER_SET = 1,      ///< Power set by the application. arg0: power.
+    POWER_GET,          ///< Power read by the application. arg0: power.
+    BUTTON_TOGGLE,      ///< Button toggled the power. arg0: new power.
+    LOCK_STATE_SET,     ///< Lock state set by the application. arg0: DoorLockState.
+    LOCK_STATE_GET,     ///< Lock state read by the application. arg0: DoorLockState.
+    DOOR_OPEN,          ///< Door unlocked. arg0: unlock window in seconds.
+    DOOR_EXTEND,        ///< Unlock window extended. arg0: unlock window in seconds.
+    DOOR_CLOSE,         ///< Door locked.
+    PRESS,              ///< Stateless button pressed. arg0: PressType, arg1: press count.
+    PRESS_TYPE_GET,     ///< Last press type read by the application. arg0: PressType.
+    BLIND_MOVE,         ///< Target set by the application. arg0: target in percent.
+    BLIND_BUTTON,       ///< Blind button pressed. arg0: 1 for up, 0 for down.
+    BLIND_POSITION_GET, ///< Current position read by the application. arg0: position in percent.
+    BLIND_TARGET_GET,   ///< Target position read by the application. arg0: target in percent.
+    BLIND_MOTOR,        ///< Motors switched. arg0: 1 up, 0 stopped, 0xFFFFFFFF down.
+    BLIND_RETARGET,     ///< Motion re-planned. arg0: position, arg1: target, both in hundredths of a percent.
+    BLIND_ARRIVED,      ///< Target reached. arg0: position in hundredths of a percent.
+    BLIND_PROGRESS      ///< Intermediate report. arg0: position in hundredths of a percent.
+};
+
+/**
+ * @brief Fixed-size binary trace record.
+ */
+struct AccessoryTraceRecord
+{
+    uint32_t timestamp;    ///< Low 32 bits of AccessoryClock::now() in microseconds.
+    uint16_t accessoryId;  ///< Identifier of the accessory.
+    uint8_t accessoryType; ///< AccessoryType of the accessory.
+    uint8_t code;          ///< AccessoryTraceCode of the record.
+    uint32_t arg0;         ///< First code specific argument.
+    uint32_t arg1;         ///< Second code specific argument.
+};
+
+static_assert(sizeof(AccessoryTraceRecord) == 16, "AccessoryTraceRecord must stay 16 bytes");
+
+#if CONFIG_A_M_TRACE_BACKEND_BINARY
+
+/**
+ * @brief RAM ring buffer of binary trace records, overwriting the oldest records when full.
+ *
+ * Recording costs a timestamp and a 16 byte copy into an AccessorySeqlock slot, so it can replace
+ * text logging on paths where UART formatting would distort timing, and readers always get whole records. The
+ * buffer is printed with dump() and rendered on the host by tools/accessory_trace_decode.py.
+ */
+class AccessoryTrace
+{
+public:
+    /**
+     * @brief Appends a record. Safe to call from several tasks at once.
+     *
+     * @param accessoryType Kind of accessory emitting the record.
+     * @param accessoryId Identifier of the accessory.
+     * @param code Code of the record.
+     * @param arg0 First code specific argument.
+     * @param arg1 Second code specific argument.
+     */
+    static void record(AccessoryType accessoryType, uint16_t accessoryId, AccessoryTraceCode code, uint32_t arg0,
+                       uint32_t arg1);
+
+    /**
+     * @brief Copies the most recent records, oldest first.
+     *
+     * @param records Destination array.
+     * @param maxRecords Capacity of the destination array.
+     * @return Number of records copied.
+     */
+    static size_t read(AccessoryTraceRecord * records, size_t maxRecords);
+
+    /**
+     * @brief Prints the buffered records as hex lines for the host decoder.
+     */
+    static void dump();
+
+    /**
+     * @brief Gets the number of records appended since start-up, including overwritten ones.
+     *
+     * @return The number of records.
+     */
+    static uint32_t getRecordCount();
+};
+
+#define A_M_TRACE_AT(level, tag, reporter, code, arg0, arg1, format, ...)                                                          \
+    do                                                                                                                             \
+    {                                                                                                                              \
+        AccessoryTrace::record((reporter).getAccessoryType(), (reporter).getAccessoryId(), AccessoryTraceCode::code,               \
+                               static_cast<uint32_t>(arg0), static_cast<uint32_t>(arg1));                                          \
+        if (0)                                                                                                                     \
+        {                                                                                                                          \
+            ESP_LOG##level(tag, format, ##__VA_ARGS__);                                                                            \
+        }                                                                                                                          \
+    } while (0)
+
+#elif CONFIG_A_M_TRACE_BACKEND_NONE
+
+#define A_M_TRACE_AT(level, tag, reporter, code, arg0, arg1, format, ...)                                                          \
+    do                                                                                                                             \
+    {                                                                                                                              \
+        if (0)                                                                                                                     \
+        {                                                                                                                          \
+            ESP_LOG##level(tag, format, ##__VA_ARGS__);                                                                            \
+        }                                                                                                                          \
+    } while (0)
+
+#else
+
+#define A_M_TRACE_AT(level, tag, reporter, code, arg0, arg1, format, ...) ESP_LOG##level(tag, format, ##__VA_ARGS__)
+
+#endif
+
+/**
+ * @brief Traces a hot path event: a binary record with the binary backend, an info log line with the text backend.
+ *
+ * With the binary and none backends the log line is compiled out, its arguments are only type-checked.
+ */
+#define A_M_TRACE(tag, reporter, code, arg0, arg1, format, ...)                                                                    \
+    A_M_TRACE_AT(I, tag, reporter, code, arg0, arg1, format, ##__VA_ARGS__)
+
+/**
+ * @brief Same as A_M_TRACE, logging at debug level with the text backend.
+ */
+#define A_M_TRACE_DEBUG(tag, reporter, code, arg0, arg1, format, ...)                                                              \
+    A_M_TRACE_AT(D, tag, reporter, code, arg0, arg1, format, ##__VA_ARGS__)
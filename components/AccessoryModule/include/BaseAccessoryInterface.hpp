@@ -1,5 +1,13 @@
 #pragma once
 
+#include <stdint.h>
+
+#include "AccessoryEvent.hpp"
+#include "AccessoryLatencyHistogram.hpp"
+
+class AccessoryStateStore;
+struct AccessoryStateRecord;
+
 /**
  * @brief Interface for base accessory functionalities.
  */
@@ -13,6 +21,14 @@ public:
      */
     using ReportCallback = void (*)(void *, bool onlySave);
 
+    /**
+     * @brief Type definition for the callback function receiving typed change events.
+     *
+     * @param event The changed attributes and their new values.
+     * @param callbackParam Pointer to user-defined data.
+     */
+    using EventCallback = void (*)(const AccessoryEvent & event, void * callbackParam);
+
     /**
      * @brief Type definition for any callback parameter type.
      */
@@ -28,8 +44,96 @@ public:
      */
     virtual void setReportCallback(ReportCallback callback, CallbackParam * callbackParam = nullptr) = 0;
 
+    /**
+     * @brief Sets the callback function receiving typed change events.
+     *
+     * Events are delivered before the report callback, which is kept for compatibility.
+     *
+     * @param callback The callback function.
+     * @param callbackParam Optional parameter for the callback function.
+     */
+    virtual void setEventCallback(EventCallback callback, CallbackParam * callbackParam = nullptr) = 0;
+
+    /**
+     * @brief Sets the identifier carried by the events of this accessory.
+     *
+     * @param accessoryId The identifier, for example the endpoint id of the accessory.
+     */
+    virtual void setAccessoryId(uint16_t accessoryId) = 0;
+
+    /**
+     * @brief Gets the identifier carried by the events of this accessory.
+     *
+     * @return The identifier set with setAccessoryId(), 0 by default.
+     */
+    virtual uint16_t getAccessoryId() = 0;
+
+    /**
+     * @brief Attaches the store persisting the state of this accessory.
+     *
+     * Every change event, including the intermediate ones flagged onlySave, updates the record of the accessory
+     * in the store, which coalesces the writes. The accessory id must be set first.
+     *
+     * @param stateStore The store, nullptr to detach.
+     */
+    virtual void setStateStore(AccessoryStateStore * stateStore) = 0;
+
+    /**
+     * @brief Applies a saved state without logging, reporting or updating the state store.
+     *
+     * Meant for boot, before the callbacks are set: relays already in the saved state are not written, so they
+     * never toggle through a default state. Records of another accessory type are ignored.
+     *
+     * @param record The saved state, usually from AccessoryStateStore::getRecord().
+     * @return True if the record was applied, false otherwise.
+     */
+    virtual bool restore(const AccessoryStateRecord & record) = 0;
+
+    /**
+     * @brief Resumes the operation in flight when the chip reset, from the state retained in RTC memory.
+     *
+     * Meant for a warm restart, after restore(): a blind finishes its motion and a door lock its unlock window.
+     * The accessory id must be set first.
+     *
+     * @return True if retained state was applied, false otherwise.
+     */
+    virtual bool resume() = 0;
+
+    /**
+     * @brief Drives the accessory to a scene state without logging or reporting, for SceneExecutor.
+     *
+     * The state store is updated; the caller reports the change together with the other accessories of the scene.
+     * Records of another accessory type are ignored.
+     *
+     * @param state The target state, its currentPosition is not used.
+     * @param event Receives the change event, with no attribute flagged if the accessory already was in the state.
+     * @return True if the state was applied, false otherwise.
+     */
+    virtual bool applyState(const AccessoryStateRecord & state, AccessoryEvent & event) = 0;
+
+    /**
+     * @brief Gets the current state of the accessory in the format of the state store, for AccessoryRegistry.
+     *
+     * @param state Receives the state, with the accessory id and type.
+     * @return True if the accessory has a state, false for stateless accessories.
+     */
+    virtual bool getState(AccessoryStateRecord & state) = 0;
+
+    /**
+     * @brief Gets the latency statistics of an instrumented path of this accessory.
+     *
+     * @param path The instrumented path.
+     * @return The statistics, all zero unless CONFIG_A_M_LATENCY_STATS is enabled.
+     */
+    virtual AccessoryLatencyStats getLatencyStats(AccessoryLatencyPath path) = 0;
+
     /**
      * @brief Identifies the accessory.
      */
     virtual void identify() = 0;
+
+    /**
+     * @brief Stops a running identification and restores the state the accessory had before it started.
+     */
+    virtual void stopIdentify() = 0;
 };
@@ -1,11 +1,13 @@
 #pragma once
 
-#include <freertos/FreeRTOS.h>
-#include <freertos/task.h>
+#include <atomic>
 
 #include <ButtonModuleInterface.hpp>
 #include <RelayModuleInterface.hpp>
 
+#include "IdentifyEngine.hpp"
+#include "AccessoryReporter.hpp"
+#include "AccessorySeqlock.hpp"
 #include "BlindAccessoryInterface.hpp"
 
 /**
@@ -53,6 +55,13 @@ public:
      */
     uint8_t getTargetPosition() override;
 
+    /**
+     * @brief Gets a snapshot of the current motion.
+     *
+     * @return The start position, target, velocity and start time of the current motion.
+     */
+    MotionSnapshot getMotionSnapshot() override;
+
     /**
      * @brief Sets the callback function for reporting to the application.
      *
@@ -61,19 +70,147 @@ public:
      */
     void setReportCallback(ReportCallback callback, CallbackParam * callbackParam = nullptr) override;
 
+    /**
+     * @brief Sets the callback function receiving typed change events.
+     *
+     * @param callback The callback function.
+     * @param callbackParam Optional parameter for the callback function.
+     */
+    void setEventCallback(EventCallback callback, CallbackParam * callbackParam = nullptr) override;
+
+    /**
+     * @brief Sets the identifier carried by the events of this accessory.
+     *
+     * @param accessoryId The identifier.
+     */
+    void setAccessoryId(uint16_t accessoryId) override;
+
+    /**
+     * @brief Gets the identifier carried by the events of this accessory.
+     *
+     * @return The identifier.
+     */
+    uint16_t getAccessoryId() override;
+
+    /**
+     * @brief Attaches the store persisting the state of this accessory.
+     *
+     * @param stateStore The store, nullptr to detach.
+     */
+    void setStateStore(AccessoryStateStore * stateStore) override;
+
+    /**
+     * @brief Applies a saved state without logging, reporting or updating the state store.
+     *
+     * Sets the resting position from the saved current position without moving the motors. Ignored while
+     * the blind is moving. The target is set at once; the motion callback takes the position shortly after.
+     *
+     * @param record The saved state.
+     * @return True if the record was applied, false otherwise.
+     */
+    bool restore(const AccessoryStateRecord & record) override;
+
+    /**
+     * @brief Resumes the operation in flight when the chip reset, from the retained state.
+     *
+     * Takes the position the blind had when the chip reset, then moves on to the retained target. Ignored
+     * while the blind is moving. Both are applied by the motion callback shortly after.
+     *
+     * @return True if retained state was applied, false otherwise.
+     */
+    bool resume() override;
+
+    /**
+     * @brief Drives the accessory to a scene state without logging or reporting.
+     *
+     * Starts moving to the target position like moveBlindTo(); the motion reports its progress as usual.
+     *
+     * @param state The target state.
+     * @param event Receives the change event.
+     * @return True if the state was applied, false otherwise.
+     */
+    bool applyState(const AccessoryStateRecord & state, AccessoryEvent & event) override;
+
+    /**
+     * @brief Gets the current state of the accessory in the format of the state store.
+     *
+     * The current position is computed for the time of the call, so it is exact while the blind moves.
+     *
+     * @param state Receives the state, with the accessory id and type.
+     * @return True if the accessory has a state, false otherwise.
+     */
+    bool getState(AccessoryStateRecord & state) override;
+
+    /**
+     * @brief Gets the latency statistics of an instrumented path of this accessory.
+     *
+     * @param path The instrumented path.
+     * @return The statistics, all zero unless CONFIG_A_M_LATENCY_STATS is enabled.
+     */
+    AccessoryLatencyStats getLatencyStats(AccessoryLatencyPath path) override;
+
     /**
      * @brief Identifies the blind accessory.
      */
     void identify() override;
 
+    /**
+     * @brief Stops a running identification and restores the previous state.
+     */
+    void stopIdentify() override;
+
+    /**
+     * @brief Sets the pattern run by identify().
+     *
+     * @param pattern The identify pattern. Its steps must outlive the accessory.
+     */
+    void setIdentifyPattern(const IdentifyPattern & pattern);
+
     /**
      * @brief Sets the default position of the blind.
      *
+     * @deprecated Use restore(), which AccessoryStateStore::restore() calls for all accessories in one pass.
+     *
      * @param defaultPosition The default position of the blind.
      */
     void setDefaultPosition(uint8_t defaultPosition) override;
 
+    /**
+     * @brief Sets the travel times of the blind with millisecond resolution.
+     *
+     * May be called from any task while the blind moves; the motion in progress keeps its travel time.
+     *
+     * @param timeToOpenMs Time in milliseconds to fully open the blind.
+     * @param timeToCloseMs Time in milliseconds to fully close the blind.
+     */
+    void setTravelTime(uint32_t timeToOpenMs, uint32_t timeToCloseMs);
+
+    /**
+     * @brief Sets how often progress is reported while the blind moves.
+     *
+     * The start and the end of a motion are always reported. In between, a report with onlySave set is issued
+     * whenever the position moved by stepPercent or intervalMs elapsed since the previous report, whichever
+     * comes first. A value of 0 disables the corresponding trigger. May be called from any task while the
+     * blind moves; the policy applies from the next wake-up of the motion.
+     *
+     * @param stepPercent Position change in percent between intermediate reports.
+     * @param intervalMs Time in milliseconds between intermediate reports.
+     */
+    void setReportPolicy(uint8_t stepPercent, uint32_t intervalMs);
+
 private:
+    /**
+     * @brief Motion of the blind, enough to compute its position at any time.
+     */
+    struct Motion
+    {
+        int64_t startTime;       ///< AccessoryClock time in microseconds at which the motion started.
+        uint32_t travelMs;       ///< Time in milliseconds of a full travel in the direction of the motion.
+        uint16_t startPosition;  ///< Position at the start of the motion, or the resting position.
+        uint16_t targetPosition; ///< Target of the motion.
+        int8_t direction;        ///< 1 when moving up, -1 when moving down, 0 when stopped.
+    };
+
     /**
      * @brief Function called when the down button is pressed.
      *
@@ -104,34 +241,127 @@ private:
     void stopMove();
 
     /**
-     * @brief Task to move the blind to the target position.
+     * @brief Timer callback that applies pending commands, issues progress reports and completes the motion.
+     *
+     * All motion state is written from this callback only. While moving, the timer is armed once for the
+     * earlier of the next progress report and the computed arrival time.
      *
      * @param instance Pointer to the instance of the class.
      */
-    static void moveBlindToTargetTask(void * instance);
+    static void motionCallback(void * instance);
+
+    /**
+     * @brief Takes the position posted by restore() or resume() as the resting position, unless the blind moves.
+     */
+    void settle();
+
+    /**
+     * @brief Applies the latest target or stop request at the current time.
+     *
+     * Settles the position reached so far, then starts, reverses or stops the motors as needed.
+     */
+    void retarget();
+
+    /**
+     * @brief Stops the motors and settles the blind at the given position, then reports it.
+     *
+     * @param position Position reached, in hundredths of a percent.
+     */
+    void stopAt(uint16_t position);
 
     /**
-     * @brief Checks if the target position has been reached.
+     * @brief Completes the current motion once the computed arrival time has passed.
+     */
+    void finishMotion();
+
+    /**
+     * @brief Posts command bits to the motion callback and wakes it up.
      *
-     * @param movingUp True if the blind is moving up, false if it is moving down.
-     * @return True if the target position has been reached, false otherwise.
+     * @param commands COMMAND_* bits, 0 to only wake the callback for bits already pending.
+     * @return True if the callback was scheduled, false if the timer service is full.
      */
-    bool targetPositionReached(bool movingUp);
+    bool post(uint8_t commands);
+
+    /**
+     * @brief Publishes m_motion to the readers of other tasks and saves it in the retained memory.
+     */
+    void publish();
+
+    /**
+     * @brief Saves the motion state in the retained memory, so a warm restart can resume it.
+     */
+    void retain();
+
+    /**
+     * @brief Issues an intermediate progress report and remembers where it happened.
+     *
+     * @param nowUs Time in microseconds as returned by AccessoryClock::now().
+     */
+    void reportProgress(int64_t nowUs);
+
+    /**
+     * @brief Delivers a change event with the given position and the current motion target.
+     *
+     * @param changedMask AccessoryEvent::Attribute bits that changed.
+     * @param position Current position in hundredths of a percent.
+     * @param onlySave True for intermediate positions that only need to be persisted.
+     */
+    void report(uint16_t changedMask, uint16_t position, bool onlySave);
+
+    /**
+     * @brief Computes when the motion timer has to fire next according to the arrival time and report policy.
+     *
+     * @return AccessoryClock time in microseconds of the next wake-up.
+     */
+    int64_t nextWakeTime() const;
+
+    /**
+     * @brief Computes the position at the given time from a motion.
+     *
+     * @param motion The motion, m_motion or a copy read from m_publishedMotion.
+     * @param nowUs Time in microseconds as returned by AccessoryClock::now().
+     * @return Position in hundredths of a percent.
+     */
+    static uint16_t positionAt(const Motion & motion, int64_t nowUs);
+
+    /**
+     * @brief Computes the time needed to travel between two positions in the given direction.
+     *
+     * @param from Start position in hundredths of a percent.
+     * @param to End position in hundredths of a percent.
+     * @return Travel time in microseconds.
+     */
+    int64_t travelTimeUs(uint16_t from, uint16_t to) const;
+
+    static constexpr uint16_t POSITION_SCALE = 100;                  ///< Fixed point units per percent.
+    static constexpr uint16_t POSITION_MAX   = 100 * POSITION_SCALE; ///< Fully open position in fixed point.
+
+    RelayModuleInterface * m_motorUp;           ///< Pointer to the relay module for moving the blind up.
+    RelayModuleInterface * m_motorDown;         ///< Pointer to the relay module for moving the blind down.
+    ButtonModuleInterface * m_buttonUp;         ///< Pointer to the button module for the up button.
+    ButtonModuleInterface * m_buttonDown;       ///< Pointer to the button module for the down button.
+    std::atomic<uint32_t> m_timeToOpenMs;       ///< Time in milliseconds to fully open the blind.
+    std::atomic<uint32_t> m_timeToCloseMs;      ///< Time in milliseconds to fully close the blind.
+    std::atomic<uint16_t> m_targetPosition;     ///< Requested target position in hundredths of a percent.
+    Motion m_motion;                            ///< Current motion, owned by the motion callback.
+    AccessorySeqlock<Motion> m_publishedMotion; ///< Last published m_motion, read by the getters from any task.
+    int64_t m_motionArrivalTime;                ///< AccessoryClock time in microseconds at which the target will be reached.
+    std::atomic<uint8_t> m_reportStepPercent;   ///< Position change in percent between intermediate reports, 0 to disable.
+    std::atomic<uint32_t> m_reportIntervalMs;   ///< Time in milliseconds between intermediate reports, 0 to disable.
+    uint16_t m_lastReportPosition;              ///< Position at the last report during the current motion.
+    int64_t m_lastReportTime;                   ///< AccessoryClock time in microseconds of the last report of the current motion.
+    std::atomic<uint8_t> m_pendingCommands;     ///< COMMAND_* bits waiting to be applied by the motion callback.
+    std::atomic<uint16_t> m_restorePosition;    ///< Resting position posted with COMMAND_RESTORE.
 
-    RelayModuleInterface * m_motorUp;     ///< Pointer to the relay module for moving the blind up.
-    RelayModuleInterface * m_motorDown;   ///< Pointer to the relay module for moving the blind down.
-    ButtonModuleInterface * m_buttonUp;   ///< Pointer to the button module for the up button.
-    ButtonModuleInterface * m_buttonDown; ///< Pointer to the button module for the down button.
-    uint8_t m_timeToOpen;                 ///< Time in seconds to fully open the blind.
-    uint8_t m_timeToClose;                ///< Time in seconds to fully close the blind.
-    uint8_t m_blindPosition;              ///< Current position of the blind.
-    uint8_t m_targetPosition;             ///< Target position of the blind.
-    TaskHandle_t m_moveBlindTaskHandle;   ///< Task handle for the move blind task.
+    static constexpr uint8_t COMMAND_MOVE    = 1 << 0; ///< Command bit: a new target position was set.
+    static constexpr uint8_t COMMAND_STOP    = 1 << 1; ///< Command bit: stop at the current position.
+    static constexpr uint8_t COMMAND_RESTORE = 1 << 2; ///< Command bit: take m_restorePosition as the resting position.
 
-    ReportCallback m_reportCallback;       ///< Callback function for reporting attributes.
-    CallbackParam * m_reportCallbackParam; ///< Parameter to be passed to the callback function.
+    AccessoryReporter m_reporter; ///< Delivers change events and reports to the application.
 
-    TaskHandle_t m_identifyHandler; ///< Task handler for the identify function.
+    IdentifyEngine m_identifyEngine;   ///< Engine running the identify pattern.
+    IdentifyPattern m_identifyPattern; ///< Pattern run by identify().
+    AccessoryTimer m_motionTimer;      ///< Timer driving the blind motion.
 
     // Delete copy constructor and assignment operator
     BlindAccessory(const BlindAccessory &)             = delete;
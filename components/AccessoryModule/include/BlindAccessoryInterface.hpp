@@ -1,5 +1,7 @@
 #pragma once
 
+#include <stdint.h>
+
 #include "BaseAccessoryInterface.hpp"
 
 /**
@@ -8,6 +10,20 @@
 class BlindAccessoryInterface : public BaseAccessoryInterface
 {
 public:
+    /**
+     * @brief Description of the current blind motion, allowing callers to interpolate the position locally.
+     *
+     * Positions are expressed in hundredths of a percent (0 - 10000). While moving, the position at time t is
+     * startPosition + velocity * (t - startTime) / 1000000, clamped to targetPosition.
+     */
+    struct MotionSnapshot
+    {
+        uint16_t startPosition;  ///< Position when the motion started, or the resting position.
+        uint16_t targetPosition; ///< Position the motion is heading to.
+        int32_t velocity;        ///< Signed speed in hundredths of a percent per second, 0 when stopped.
+        int64_t startTime;       ///< AccessoryClock time in microseconds at which the motion started.
+    };
+
     /**
      * @brief Destructor for BlindAccessoryInterface.
      */
@@ -34,6 +50,13 @@ public:
      */
     virtual uint8_t getTargetPosition() = 0;
 
+    /**
+     * @brief Gets a snapshot of the current motion.
+     *
+     * @return The start position, target, velocity and start time of the current motion.
+     */
+    virtual MotionSnapshot getMotionSnapshot() = 0;
+
     /**
      * @brief Sets the callback function for reporting to the application.
      *
@@ -50,6 +73,8 @@ public:
     /**
      * @brief Sets the default position of the blind.
      *
+     * @deprecated Use restore(), which AccessoryStateStore::restore() calls for all accessories in one pass.
+     *
      * @param defaultPosition The default position of the blind.
      */
     virtual void setDefaultPosition(uint8_t defaultPosition) = 0;
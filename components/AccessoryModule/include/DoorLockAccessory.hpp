@@ -1,12 +1,13 @@
 #pragma once
 
-#include <freertos/FreeRTOS.h>
-#include <freertos/task.h>
 
 #include <ButtonModuleInterface.hpp>
 #include <RelayModuleInterface.hpp>
 
+#include "AccessoryReporter.hpp"
+#include "AccessorySeqlock.hpp"
 #include "DoorLockAccessoryInterface.hpp"
+#include "IdentifyEngine.hpp"
 
 /**
  * @brief Implementation of the Door Lock Accessory.
@@ -50,11 +51,103 @@ public:
      */
     void setReportCallback(ReportCallback callback, CallbackParam * callbackParam = nullptr) override;
 
+    /**
+     * @brief Sets the callback function receiving typed change events.
+     *
+     * @param callback The callback function.
+     * @param callbackParam Optional parameter for the callback function.
+     */
+    void setEventCallback(EventCallback callback, CallbackParam * callbackParam = nullptr) override;
+
+    /**
+     * @brief Sets the identifier carried by the events of this accessory.
+     *
+     * @param accessoryId The identifier.
+     */
+    void setAccessoryId(uint16_t accessoryId) override;
+
+    /**
+     * @brief Gets the identifier carried by the events of this accessory.
+     *
+     * @return The identifier.
+     */
+    uint16_t getAccessoryId() override;
+
+    /**
+     * @brief Attaches the store persisting the state of this accessory.
+     *
+     * @param stateStore The store, nullptr to detach.
+     */
+    void setStateStore(AccessoryStateStore * stateStore) override;
+
+    /**
+     * @brief Applies a saved state without logging, reporting or updating the state store.
+     *
+     * An unlock window does not survive a reboot, so the door is always restored locked.
+     *
+     * @param record The saved state.
+     * @return True if the record was applied, false otherwise.
+     */
+    bool restore(const AccessoryStateRecord & record) override;
+
+    /**
+     * @brief Resumes the operation in flight when the chip reset, from the retained state.
+     *
+     * Unlocks the door again for the rest of an unlock window that had not ended, and locks it otherwise. The
+     * door is locked and false returned when the relock timer cannot be armed.
+     *
+     * @return True if retained state was applied, false otherwise.
+     */
+    bool resume() override;
+
+    /**
+     * @brief Drives the accessory to a scene state without logging or reporting.
+     *
+     * Unlocking starts the unlock window, or extends it if the door is already unlocked.
+     *
+     * @param state The target state.
+     * @param event Receives the change event.
+     * @return True if the state was applied, false otherwise.
+     */
+    bool applyState(const AccessoryStateRecord & state, AccessoryEvent & event) override;
+
+    /**
+     * @brief Gets the current state of the accessory in the format of the state store.
+     *
+     * The door is reported unlocked while its relay is on.
+     *
+     * @param state Receives the state, with the accessory id and type.
+     * @return True if the accessory has a state, false otherwise.
+     */
+    bool getState(AccessoryStateRecord & state) override;
+
+    /**
+     * @brief Gets the latency statistics of an instrumented path of this accessory.
+     *
+     * AccessoryLatencyPath::RELOCK tells how late the relock callback ran after the end of each unlock window.
+     *
+     * @param path The instrumented path.
+     * @return The statistics, all zero unless CONFIG_A_M_LATENCY_STATS is enabled.
+     */
+    AccessoryLatencyStats getLatencyStats(AccessoryLatencyPath path) override;
+
     /**
      * @brief Method to identify the door lock accessory.
      */
     void identify() override;
 
+    /**
+     * @brief Stops a running identification and restores the previous state.
+     */
+    void stopIdentify() override;
+
+    /**
+     * @brief Sets the pattern run by identify().
+     *
+     * @param pattern The identify pattern. Its steps must outlive the accessory.
+     */
+    void setIdentifyPattern(const IdentifyPattern & pattern);
+
 private:
     /**
      * @brief Static function to handle button press.
@@ -63,19 +156,59 @@ private:
      */
     static void buttonCallback(void * instance);
 
-    void openDoor();
-    static void openDoorTask(void * pvParameters);
-    void closeDoor();
+    /**
+     * @brief Unlocks the door and arms the relock timer, or re-arms it if the door is already unlocked.
+     *
+     * The door never stays unlocked without a relock timer: it stays locked, or is locked, when the timer
+     * service is full.
+     *
+     * @param report False to only save the lock state change, which the caller reports.
+     * @return True if the door is unlocked, false if the relock timer could not be armed.
+     */
+    bool openDoor(bool report = true);
+
+    /**
+     * @brief Relocks the door when the unlock window expires.
+     *
+     * @param instance Pointer to the DoorLockAccessory instance.
+     */
+    static void relockCallback(void * instance);
+
+    /**
+     * @brief Cancels the relock timer and locks the door.
+     *
+     * @param report False to only save the lock state change, which the caller reports.
+     */
+    void closeDoor(bool report = true);
+
+    /**
+     * @brief Delivers a lock state change event.
+     *
+     * @param unlocked True if the door was unlocked, false if it was locked.
+     * @param report False to only save the event in the state store.
+     */
+    void reportLockState(bool unlocked, bool report = true);
+
+    /**
+     * @brief Saves the relock deadline in the retained memory, so a warm restart can finish the unlock window.
+     *
+     * @param delayMs Time in milliseconds until the door locks, 0 when it is locked.
+     */
+    void retainRelockDeadline(uint32_t delayMs);
 
     RelayModuleInterface * m_relayModule;   ///< Pointer to the relay module.
     ButtonModuleInterface * m_buttonModule; ///< Pointer to the button module.
     uint8_t m_openDuration;                 ///< Time in seconds to keep the door open.
-    TaskHandle_t m_openDoorTaskHandle;      ///< Task handle for the open door task.
 
-    ReportCallback m_reportCallback;       ///< Callback function for reporting attributes.
-    CallbackParam * m_reportCallbackParam; ///< Parameter to be passed to the callback function.
+    AccessoryReporter m_reporter; ///< Delivers change events and reports to the application.
 
-    TaskHandle_t m_identifyHandler; ///< Task handler for the identify function.
+    IdentifyEngine m_identifyEngine;            ///< Engine running the identify pattern.
+    IdentifyPattern m_identifyPattern;          ///< Pattern run by identify().
+    AccessoryTimer m_relockTimer;               ///< Timer locking the door at the end of the unlock window.
+    AccessorySeqlock<int64_t> m_relockDeadline; ///< AccessoryClock time in microseconds at which the unlock window ends.
+#if CONFIG_A_M_LATENCY_STATS
+    AccessoryLatencyHistogram m_relockLatency; ///< Lateness of the relock after the end of the unlock window.
+#endif
 
     // Delete copy constructor and assignment operator
     DoorLockAccessory(const DoorLockAccessory &)             = delete;
@@ -1,17 +1,31 @@
 #pragma once
 
-#include "FanAccessoryInterface.hpp"
-
-#include <freertos/FreeRTOS.h>
-#include <freertos/task.h>
 #include <ButtonModuleInterface.hpp>
 #include <RelayModuleInterface.hpp>
-#include <esp_log.h>
+
+#include "FanAccessoryInterface.hpp"
+#include "RelayToggleAccessory.hpp"
+
+/**
+ * @brief Compile-time traits of FanAccessory, see RelayToggleDescriptor.
+ */
+struct FanAccessoryTraits
+{
+    using Interface = FanAccessoryInterface; ///< Interface implemented by FanAccessory.
+
+    static constexpr const char * TAG                         = "FanAccessory";                 ///< Log tag.
+    static constexpr AccessoryType TYPE                       = AccessoryType::Fan;             ///< Type of the events.
+    static constexpr const IdentifyPattern * IDENTIFY_PATTERN = &IdentifyPatterns::RELAY_BLINK; ///< Default identify pattern.
+    static constexpr bool RESTART_IDENTIFY                    = false;                          ///< Keep a running pattern.
+};
 
 /**
  * @brief Class representing a fan accessory.
+ *
+ * The accessory code is shared with the other relay toggle accessories in RelayToggleCore. Firmware that does not
+ * need FanAccessoryInterface can use StaticRelayToggleAccessory<FanAccessoryTraits> instead.
  */
-class FanAccessory : public FanAccessoryInterface
+class FanAccessory : public RelayToggleAccessory<FanAccessoryTraits>
 {
 public:
     /**
@@ -22,11 +36,6 @@ public:
      */
     FanAccessory(RelayModuleInterface * relayModule, ButtonModuleInterface * buttonModule);
 
-    /**
-     * @brief Destructor for FanAccessory.
-     */
-    ~FanAccessory();
-
     /**
      * @brief Sets the power state of the fan accessory.
      *
@@ -41,36 +50,8 @@ public:
      */
     bool getPower() override;
 
-    /**
-     * @brief Sets the callback function for reporting to the application.
-     *
-     * @param callback The callback function.
-     * @param callbackParam Optional parameter for the callback function.
-     */
-    void setReportCallback(ReportCallback callback, CallbackParam * callbackParam = nullptr) override;
-
-    /**
-     * @brief Identifies the fan accessory.
-     */
-    void identify() override;
-
 private:
-    /**
-     * @brief Function called when the button is pressed.
-     *
-     * @param instance Pointer to the instance of the class.
-     */
-    static void buttonCallback(void * instance);
-
-    RelayModuleInterface * m_relayModule;   ///< Pointer to the relay module interface.
-    ButtonModuleInterface * m_buttonModule; ///< Pointer to the button module interface.
-
-    ReportCallback m_reportCallback;       ///< Callback function for reporting.
-    CallbackParam * m_reportCallbackParam; ///< Parameter for the callback function.
-
-    TaskHandle_t m_identifyHandler; ///< Task handler for the identify function.
-
-    // Delete the copy constructor and assignment operator
+    // Delete copy constructor and assignment operator
     FanAccessory(const FanAccessory &)             = delete;
     FanAccessory & operator=(const FanAccessory &) = delete;
 };
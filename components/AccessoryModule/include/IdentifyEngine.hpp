@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+
+#include <RelayModuleInterface.hpp>
+
+#include "AccessoryTimer.hpp"
+#include "IdentifyPattern.hpp"
+
+/**
+ * @brief Runs identify patterns on up to MAX_OUTPUTS relays using the shared timer service.
+ *
+ * The level of every output is captured when a pattern starts and restored when it completes, is cancelled or
+ * cannot go on because the timer service is full.
+ */
+class IdentifyEngine
+{
+public:
+    static constexpr uint8_t MAX_OUTPUTS = 2; ///< Maximum number of outputs driven by a pattern.
+
+    /**
+     * @brief Constructor for IdentifyEngine.
+     *
+     * @param output0 Relay driven by steps with output index 0.
+     * @param output1 Relay driven by steps with output index 1.
+     */
+    IdentifyEngine(RelayModuleInterface * output0, RelayModuleInterface * output1 = nullptr);
+
+    /**
+     * @brief Destructor for IdentifyEngine. Cancels a running pattern and restores the outputs.
+     */
+    ~IdentifyEngine();
+
+    /**
+     * @brief Starts running a pattern.
+     *
+     * @param pattern The pattern to run. Its steps must outlive the run.
+     * @return True if the pattern started, false if a pattern is running, no output is set or no timer is free.
+     */
+    bool start(const IdentifyPattern & pattern);
+
+    /**
+     * @brief Cancels the running pattern, if any, and restores the outputs.
+     */
+    void cancel();
+
+    /**
+     * @brief Checks whether a pattern is running.
+     *
+     * @return True if a pattern is running, false otherwise.
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Sets the type of accessory the engine serves, used to attribute its callbacks in AccessoryTelemetry.
+     *
+     * @param ownerType The accessory type.
+     */
+    void setOwner(AccessoryType ownerType);
+
+private:
+    /**
+     * @brief Runs the next steps of the pattern up to the next one with a duration.
+     *
+     * @param instance Pointer to the IdentifyEngine object.
+     */
+    static void timerCallback(void * instance);
+
+    /**
+     * @brief Drives every output back to the level it had when the pattern started.
+     */
+    void restore();
+
+    RelayModuleInterface * m_outputs[MAX_OUTPUTS]; ///< Relays driven by the pattern.
+    bool m_savedLevels[MAX_OUTPUTS];               ///< Output levels captured when the pattern started.
+    const IdentifyStep * m_steps;                  ///< Steps of the running pattern.
+    uint8_t m_stepCount;                           ///< Number of steps of the running pattern.
+    uint8_t m_nextStep;                            ///< Index of the next step to run.
+    std::atomic<bool> m_running;                   ///< True while a pattern is running, read from any task.
+    AccessoryTimer m_timer;                        ///< Timer waiting for the current step duration.
+
+    // Delete copy constructor and assignment operator
+    IdentifyEngine(const IdentifyEngine &)             = delete;
+    IdentifyEngine & operator=(const IdentifyEngine &) = delete;
+};
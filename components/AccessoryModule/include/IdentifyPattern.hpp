@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief One step of an identify pattern: drive an output to a level, then wait.
+ */
+struct IdentifyStep
+{
+    uint8_t output;      ///< Index of the output to drive.
+    bool level;          ///< Level to drive the output to.
+    uint16_t durationMs; ///< Time in milliseconds to wait before the next step, 0 to run it immediately.
+};
+
+/**
+ * @brief Compact description of an identify sequence, run by IdentifyEngine.
+ *
+ * The pattern refers to its steps, which must outlive any run of the pattern. Patterns are intended to be
+ * built from constexpr step arrays so they live in flash.
+ */
+struct IdentifyPattern
+{
+    const IdentifyStep * steps; ///< Steps of the pattern.
+    uint8_t stepCount;          ///< Number of steps.
+
+    /**
+     * @brief Builds a pattern from a step array.
+     *
+     * @param stepArray The steps of the pattern.
+     */
+    template <size_t N>
+    constexpr IdentifyPattern(const IdentifyStep (&stepArray)[N]) : steps(stepArray), stepCount(N)
+    {
+        static_assert(N > 0 && N <= UINT8_MAX, "An identify pattern needs between 1 and 255 steps");
+    }
+};
+
+/**
+ * @brief Built-in identify patterns.
+ */
+struct IdentifyPatterns
+{
+    /**
+     * @brief Steps of RELAY_BLINK: toggle output 0 off, on, off, on, off with one second per step.
+     */
+    static constexpr IdentifyStep RELAY_BLINK_STEPS[] = {
+        { 0, false, 1000 }, { 0, true, 1000 }, { 0, false, 1000 }, { 0, true, 1000 }, { 0, false, 0 },
+    };
+
+    /**
+     * @brief Steps of BLIND_JOG: move down, up, down, up with two seconds per move, then stop.
+     *
+     * Output 0 is the up motor and output 1 the down motor. The opposite motor is always released first.
+     */
+    static constexpr IdentifyStep BLIND_JOG_STEPS[] = {
+        { 0, false, 0 }, { 1, true, 2000 }, { 1, false, 0 }, { 0, true, 2000 }, { 0, false, 0 },
+        { 1, true, 2000 }, { 1, false, 0 }, { 0, true, 2000 }, { 0, false, 0 },
+    };
+
+    static constexpr IdentifyPattern RELAY_BLINK = IdentifyPattern(RELAY_BLINK_STEPS); ///< Default single relay pattern.
+    static constexpr IdentifyPattern BLIND_JOG   = IdentifyPattern(BLIND_JOG_STEPS);   ///< Default blind pattern.
+};
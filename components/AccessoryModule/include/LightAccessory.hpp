@@ -1,31 +1,41 @@
 #pragma once
 
-#include <freertos/FreeRTOS.h>
-#include <freertos/task.h>
 #include <ButtonModuleInterface.hpp>
 #include <RelayModuleInterface.hpp>
 
 #include "LightAccessoryInterface.hpp"
+#include "RelayToggleAccessory.hpp"
+
+/**
+ * @brief Compile-time traits of LightAccessory, see RelayToggleDescriptor.
+ */
+struct LightAccessoryTraits
+{
+    using Interface = LightAccessoryInterface; ///< Interface implemented by LightAccessory.
+
+    static constexpr const char * TAG                         = "LightAccessory";               ///< Log tag.
+    static constexpr AccessoryType TYPE                       = AccessoryType::Light;           ///< Type of the events.
+    static constexpr const IdentifyPattern * IDENTIFY_PATTERN = &IdentifyPatterns::RELAY_BLINK; ///< Default identify pattern.
+    static constexpr bool RESTART_IDENTIFY                    = false;                          ///< Keep a running pattern.
+};
 
 /**
  * @brief Concrete implementation of the LightAccessoryInterface.
+ *
+ * The accessory code is shared with the other relay toggle accessories in RelayToggleCore. Firmware that does not
+ * need LightAccessoryInterface can use StaticRelayToggleAccessory<LightAccessoryTraits> instead.
  */
-class LightAccessory : public LightAccessoryInterface
+class LightAccessory : public RelayToggleAccessory<LightAccessoryTraits>
 {
 public:
     /**
-     * @brief Constructs a LightAccessory object.
+     * @brief Constructor for LightAccessory.
      *
-     * @param relayModule Pointer to the relay module.
-     * @param buttonModule Pointer to the button module.
+     * @param relayModule Pointer to the relay module interface.
+     * @param buttonModule Pointer to the button module interface.
      */
     LightAccessory(RelayModuleInterface * relayModule, ButtonModuleInterface * buttonModule);
 
-    /**
-     * @brief Destructor for LightAccessory.
-     */
-    ~LightAccessory();
-
     /**
      * @brief Sets the power state of the light accessory.
      *
@@ -40,35 +50,7 @@ public:
      */
     bool isPowerOn() override;
 
-    /**
-     * @brief Sets the callback function for reporting to the application.
-     *
-     * @param callback The callback function.
-     * @param callbackParam Optional parameter for the callback function.
-     */
-    void setReportCallback(ReportCallback callback, CallbackParam * callbackParam = nullptr) override;
-
-    /**
-     * @brief Identifies the light accessory.
-     */
-    void identify() override;
-
 private:
-    /**
-     * @brief Button callback function.
-     *
-     * @param instance Pointer to the LightAccessory object.
-     */
-    static void buttonCallback(void * instance);
-
-    RelayModuleInterface * m_relayModule;   ///< Pointer to the relay module interface.
-    ButtonModuleInterface * m_buttonModule; ///< Pointer to the button module interface.
-
-    ReportCallback m_reportCallback;       ///< Callback function for reporting attributes.
-    CallbackParam * m_reportCallbackParam; ///< Parameter to be passed to the callback function.
-
-    TaskHandle_t m_identifyHandler; ///< Task handler for the identify function.
-
     // Delete copy constructor and assignment operator
     LightAccessory(const LightAccessory &)             = delete;
     LightAccessory & operator=(const LightAccessory &) = delete;
@@ -1,16 +1,31 @@
 #pragma once
 
-#include <freertos/FreeRTOS.h>
-#include <freertos/task.h>
 #include <ButtonModuleInterface.hpp>
 #include <RelayModuleInterface.hpp>
 
 #include "PluginAccessoryInterface.hpp"
+#include "RelayToggleAccessory.hpp"
+
+/**
+ * @brief Compile-time traits of PluginAccessory, see RelayToggleDescriptor.
+ */
+struct PluginAccessoryTraits
+{
+    using Interface = PluginAccessoryInterface; ///< Interface implemented by PluginAccessory.
+
+    static constexpr const char * TAG                         = "PluginAccessory";              ///< Log tag.
+    static constexpr AccessoryType TYPE                       = AccessoryType::Plugin;          ///< Type of the events.
+    static constexpr const IdentifyPattern * IDENTIFY_PATTERN = &IdentifyPatterns::RELAY_BLINK; ///< Default identify pattern.
+    static constexpr bool RESTART_IDENTIFY                    = false;                          ///< Keep a running pattern.
+};
 
 /**
  * @brief Class representing a plugin accessory.
+ *
+ * The accessory code is shared with the other relay toggle accessories in RelayToggleCore. Firmware that does not
+ * need PluginAccessoryInterface can use StaticRelayToggleAccessory<PluginAccessoryTraits> instead.
  */
-class PluginAccessory : public PluginAccessoryInterface
+class PluginAccessory : public RelayToggleAccessory<PluginAccessoryTraits>
 {
 public:
     /**
@@ -21,11 +36,6 @@ public:
      */
     PluginAccessory(RelayModuleInterface * relayModuleInterface, ButtonModuleInterface * buttonModuleInterface);
 
-    /**
-     * @brief Destructor for PluginAccessory.
-     */
-    ~PluginAccessory();
-
     /**
      * @brief Sets the power state of the accessory.
      *
@@ -40,36 +50,8 @@ public:
      */
     bool getPower() override;
 
-    /**
-     * @brief Sets the callback function for reporting to the application.
-     *
-     * @param callback The callback function.
-     * @param callbackParam Optional parameter for the callback function.
-     */
-    void setReportCallback(ReportCallback callback, CallbackParam * callbackParam = nullptr) override;
-
-    /**
-     * @brief Identifies the accessory.
-     */
-    void identify() override;
-
 private:
-    /**
-     * @brief Function called when the button is pressed.
-     *
-     * @param instance Pointer to the instance of the class.
-     */
-    static void buttonCallback(void * instance);
-
-    RelayModuleInterface * m_relayModuleInterface;   ///< Pointer to the relay module interface.
-    ButtonModuleInterface * m_buttonModuleInterface; ///< Pointer to the button module interface.
-
-    ReportCallback m_reportCallback;       ///< Callback function for reporting.
-    CallbackParam * m_reportCallbackParam; ///< Parameter for the callback function.
-
-    TaskHandle_t m_identifyHandler; ///< Task handler for the identify function.
-
-    // Delete the copy constructor and assignment operator.
+    // Delete copy constructor and assignment operator
     PluginAccessory(const PluginAccessory &)             = delete;
     PluginAccessory & operator=(const PluginAccessory &) = delete;
 };
@@ -0,0 +1,178 @@
+#pragma once
+
+#include "RelayToggleCore.hpp"
+
+/**
+ * @brief Descriptor of the relay toggle accessories described by Traits, one constant per kind.
+ *
+ * Traits must provide:
+ * - TAG: log tag.
+ * - TYPE: the AccessoryType carried by the events.
+ * - IDENTIFY_PATTERN: pointer to the default identify pattern.
+ * - RESTART_IDENTIFY: true if identify() restarts a running pattern, false to ignore the call.
+ *
+ * RelayToggleAccessory also needs Interface, the abstract interface it implements.
+ */
+template <typename Traits>
+struct RelayToggleDescriptor
+{
+    static constexpr RelayToggleCore::Descriptor VALUE = { Traits::TAG, Traits::TYPE, Traits::IDENTIFY_PATTERN,
+                                                           Traits::RESTART_IDENTIFY };
+};
+
+/**
+ * @brief Relay toggle accessory implementing Traits::Interface.
+ *
+ * Every override forwards inline to a RelayToggleCore, so the kinds built from this template share one copy of the
+ * accessory code and only add their vtable. Subclasses implement the power methods of their interface with
+ * m_core.setPower() and m_core.getPower().
+ */
+template <typename Traits>
+class RelayToggleAccessory : public Traits::Interface
+{
+public:
+    using ReportCallback = BaseAccessoryInterface::ReportCallback; ///< Function receiving reports.
+    using EventCallback  = BaseAccessoryInterface::EventCallback;  ///< Function receiving typed change events.
+    using CallbackParam  = BaseAccessoryInterface::CallbackParam;  ///< Parameter passed to the callbacks.
+
+    /**
+     * @brief Constructor for RelayToggleAccessory.
+     *
+     * @param relayModule Pointer to the relay module.
+     * @param buttonModule Pointer to the button module, may be nullptr.
+     */
+    RelayToggleAccessory(RelayModuleInterface * relayModule, ButtonModuleInterface * buttonModule) :
+        m_core(RelayToggleDescriptor<Traits>::VALUE, relayModule, buttonModule)
+    {
+    }
+
+    /**
+     * @brief Sets the callback function for reporting to the application.
+     *
+     * @param callback The callback function.
+     * @param callbackParam Optional parameter for the callback function.
+     */
+    void setReportCallback(ReportCallback callback, CallbackParam * callbackParam = nullptr) override
+    {
+        m_core.setReportCallback(callback, callbackParam);
+    }
+
+    /**
+     * @brief Sets the callback function receiving typed change events.
+     *
+     * @param callback The callback function.
+     * @param callbackParam Optional parameter for the callback function.
+     */
+    void setEventCallback(EventCallback callback, CallbackParam * callbackParam = nullptr) override
+    {
+        m_core.setEventCallback(callback, callbackParam);
+    }
+
+    /**
+     * @brief Sets the identifier carried by the events of this accessory.
+     *
+     * @param accessoryId The identifier.
+     */
+    void setAccessoryId(uint16_t accessoryId) override { m_core.setAccessoryId(accessoryId); }
+
+    /**
+     * @brief Gets the identifier carried by the events of this accessory.
+     *
+     * @return The identifier.
+     */
+    uint16_t getAccessoryId() override { return m_core.getAccessoryId(); }
+
+    /**
+     * @brief Attaches the store persisting the state of this accessory.
+     *
+     * @param stateStore The store, nullptr to detach.
+     */
+    void setStateStore(AccessoryStateStore * stateStore) override { m_core.setStateStore(stateStore); }
+
+    /**
+     * @brief Applies a saved state without logging, reporting or updating the state store.
+     *
+     * Switches the relay only if it is not already in the saved state, so restoring at boot never toggles it.
+     *
+     * @param record The saved state.
+     * @return True if the record was applied, false otherwise.
+     */
+    bool restore(const AccessoryStateRecord & record) override { return m_core.restore(record); }
+
+    /**
+     * @brief Resumes the operation in flight when the chip reset, from the retained state.
+     *
+     * The accessory has no operation that outlives a restart, nothing is resumed.
+     *
+     * @return True if retained state was applied, false otherwise.
+     */
+    bool resume() override { return false; }
+
+    /**
+     * @brief Drives the accessory to a scene state without logging or reporting.
+     *
+     * Switches the relay only if it is not already in the target state.
+     *
+     * @param state The target state.
+     * @param event Receives the change event.
+     * @return True if the state was applied, false otherwise.
+     */
+    bool applyState(const AccessoryStateRecord & state, AccessoryEvent & event) override { return m_core.applyState(state, event); }
+
+    /**
+     * @brief Gets the current state of the accessory in the format of the state store.
+     *
+     * @param state Receives the state, with the accessory id and type.
+     * @return True if the accessory has a state, false otherwise.
+     */
+    bool getState(AccessoryStateRecord & state) override { return m_core.getState(state); }
+
+    /**
+     * @brief Gets the latency statistics of an instrumented path of this accessory.
+     *
+     * @param path The instrumented path.
+     * @return The statistics, all zero unless CONFIG_A_M_LATENCY_STATS is enabled.
+     */
+    AccessoryLatencyStats getLatencyStats(AccessoryLatencyPath path) override { return m_core.getLatencyStats(path); }
+
+    /**
+     * @brief Runs the identify pattern.
+     */
+    void identify() override { m_core.identify(); }
+
+    /**
+     * @brief Stops a running identification and restores the previous state.
+     */
+    void stopIdentify() override { m_core.stopIdentify(); }
+
+    /**
+     * @brief Sets the pattern run by identify().
+     *
+     * @param pattern The identify pattern. Its steps must outlive the accessory.
+     */
+    void setIdentifyPattern(const IdentifyPattern & pattern) { m_core.setIdentifyPattern(pattern); }
+
+protected:
+    RelayToggleCore m_core; ///< Shared implementation of the accessory.
+};
+
+/**
+ * @brief Relay toggle accessory without the abstract interfaces, for firmware that uses the concrete type only.
+ *
+ * It has no vtable: every call is a direct call into RelayToggleCore. Traits::Interface is not needed.
+ */
+template <typename Traits>
+class StaticRelayToggleAccessory : public RelayToggleCore
+{
+public:
+    /**
+     * @brief Constructor for StaticRelayToggleAccessory.
+     *
+     * @param relayModule Pointer to the relay module.
+     * @param buttonModule Pointer to the button module, may be nullptr.
+     */
+    StaticRelayToggleAccessory(RelayModuleInterface * relayModule, ButtonModuleInterface * buttonModule) :
+        RelayToggleCore(RelayToggleDescriptor<Traits>::VALUE, relayModule, buttonModule)
+    {
+    }
+};
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <ButtonModuleInterface.hpp>
+#include <RelayModuleInterface.hpp>
+
+#include "AccessoryReporter.hpp"
+#include "IdentifyEngine.hpp"
+#include "IdentifyPattern.hpp"
+
+/**
+ * @brief Shared implementation of the accessories switching one relay, toggled by a button.
+ *
+ * The class has no virtual functions and is not a template: light, fan, switch and plugin accessories share one
+ * copy of this code and differ only by their Descriptor. Firmware that does not need the abstract interfaces can
+ * use it directly through StaticRelayToggleAccessory, with plain function calls.
+ */
+class RelayToggleCore
+{
+public:
+    /**
+     * @brief What sets one kind of relay toggle accessory apart, built from compile-time traits.
+     */
+    struct Descriptor
+    {
+        const char * tag;                        ///< Log tag.
+        AccessoryType type;                      ///< Type carried by the events and checked in saved states.
+        const IdentifyPattern * identifyPattern; ///< Default pattern run by identify().
+        bool restartIdentify;                    ///< True if identify() restarts a running pattern, false to ignore it.
+    };
+
+    /**
+     * @brief Constructor for RelayToggleCore.
+     *
+     * @param descriptor Description of the accessory kind, must outlive the accessory.
+     * @param relayModule Pointer to the relay module.
+     * @param buttonModule Pointer to the button module, may be nullptr.
+     */
+    RelayToggleCore(const Descriptor & descriptor, RelayModuleInterface * relayModule, ButtonModuleInterface * buttonModule);
+
+    /**
+     * @brief Destructor for RelayToggleCore. Cancels a running identification.
+     */
+    ~RelayToggleCore();
+
+    /**
+     * @brief Switches the relay.
+     *
+     * @param power True to switch it on, false to switch it off.
+     * @return True if the relay was switched, false if identify is running or no relay is set.
+     */
+    bool setPower(bool power);
+
+    /**
+     * @brief Gets the relay state.
+     *
+     * @return True if the relay is on, false otherwise.
+     */
+    bool getPower();
+
+    /**
+     * @brief Sets the callback function for reporting to the application.
+     *
+     * @param callback The callback function.
+     * @param callbackParam Optional parameter for the callback function.
+     */
+    void setReportCallback(BaseAccessoryInterface::ReportCallback callback, void * callbackParam = nullptr);
+
+    /**
+     * @brief Sets the callback function receiving typed change events.
+     *
+     * @param callback The callback function.
+     * @param callbackParam Optional parameter for the callback function.
+     */
+    void setEventCallback(BaseAccessoryInterface::EventCallback callback, void * callbackParam = nullptr);
+
+    /**
+     * @brief Sets the identifier carried by the events of this accessory.
+     *
+     * @param accessoryId The identifier.
+     */
+    void setAccessoryId(uint16_t accessoryId);
+
+    /**
+     * @brief Gets the identifier carried by the events of this accessory.
+     *
+     * @return The identifier.
+     */
+    uint16_t getAccessoryId();
+
+    /**
+     * @brief Attaches the store persisting the state of this accessory.
+     *
+     * @param stateStore The store, nullptr to detach.
+     */
+    void setStateStore(AccessoryStateStore * stateStore);
+
+    /**
+     * @brief Applies a saved state without logging, reporting or updating the state store.
+     *
+     * Switches the relay only if it is not already in the saved state, so restoring at boot never toggles it.
+     *
+     * @param record The saved state.
+     * @return True if the record was applied, false otherwise.
+     */
+    bool restore(const AccessoryStateRecord & record);
+
+    /**
+     * @brief Drives the accessory to a scene state without logging or reporting.
+     *
+     * Switches the relay only if it is not already in the target state.
+     *
+     * @param state The target state.
+     * @param event Receives the change event.
+     * @return True if the state was applied, false otherwise.
+     */
+    bool applyState(const AccessoryStateRecord & state, AccessoryEvent & event);
+
+    /**
+     * @brief Gets the current state of the accessory in the format of the state store.
+     *
+     * @param state Receives the state, with the accessory id and type.
+     * @return True if the accessory has a state, false otherwise.
+     */
+    bool getState(AccessoryStateRecord & state);
+
+    /**
+     * @brief Gets the latency statistics of an instrumented path of this accessory.
+     *
+     * @param path The instrumented path.
+     * @return The statistics, all zero unless CONFIG_A_M_LATENCY_STATS is enabled.
+     */
+    AccessoryLatencyStats getLatencyStats(AccessoryLatencyPath path);
+
+    /**
+     * @brief Runs the identify pattern.
+     */
+    void identify();
+
+    /**
+     * @brief Stops a running identification and restores the previous state.
+     */
+    void stopIdentify();
+
+    /**
+     * @brief Sets the pattern run by identify().
+     *
+     * @param pattern The identify pattern. Its steps must outlive the accessory.
+     */
+    void setIdentifyPattern(const IdentifyPattern & pattern);
+
+private:
+    /**
+     * @brief Function called when the button is pressed.
+     *
+     * @param instance Pointer to the RelayToggleCore object.
+     */
+    static void buttonCallback(void * instance);
+
+    /**
+     * @brief Delivers a power change event.
+     *
+     * @param power The new relay state.
+     */
+    void reportPower(bool power);
+
+    const Descriptor * m_descriptor;        ///< Description of the accessory kind.
+    RelayModuleInterface * m_relayModule;   ///< Pointer to the relay module interface.
+    ButtonModuleInterface * m_buttonModule; ///< Pointer to the button module interface.
+
+    AccessoryReporter m_reporter; ///< Delivers change events and reports to the application.
+
+    IdentifyEngine m_identifyEngine;   ///< Engine running the identify pattern.
+    IdentifyPattern m_identifyPattern; ///< Pattern run by identify().
+
+    // Delete copy constructor and assignment operator
+    RelayToggleCore(const RelayToggleCore &)             = delete;
+    RelayToggleCore & operator=(const RelayToggleCore &) = delete;
+};
@@ -0,0 +1,261 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <freertos/FreeRTOS.h>
+#include <sdkconfig.h>
+
+#include "AccessoryEvent.hpp"
+#include "AccessoryLatencyHistogram.hpp"
+#include "AccessoryStateStore.hpp"
+#include "AccessoryStorageInterface.hpp"
+#include "BaseAccessoryInterface.hpp"
+
+/**
+ * @brief Applies the states of many accessories back to back and reports them once.
+ *
+ * Every accessory of a scene is driven with BaseAccessoryInterface::applyState(), which neither logs nor reports,
+ * then a single report carrying the change events of the whole scene is delivered in the calling context. The
+ * state store of every accessory is still updated.
+ *
+ * Activation is bounded: scenes hold at most MAX_ENTRIES accessories and an activation never waits, a concurrent
+ * one is rejected. Its duration is measured and checked against CONFIG_A_M_SCENE_BUDGET_US.
+ *
+ * Presets are kept in memory as 6 byte entries keyed by accessory id, and saved to or loaded from an
+ * AccessoryStorageInterface as one block. They must be changed from a single task and not while one of them is
+ * being activated.
+ */
+class SceneExecutor
+{
+public:
+    static constexpr size_t MAX_ENTRIES        = CONFIG_A_M_SCENE_MAX_ENTRIES;    ///< Maximum accessories in a scene.
+    static constexpr size_t MAX_PRESETS        = CONFIG_A_M_SCENE_MAX_PRESETS;    ///< Maximum number of presets.
+    static constexpr size_t MAX_PRESET_ENTRIES = CONFIG_A_M_SCENE_PRESET_ENTRIES; ///< Entries shared by all presets.
+
+    /**
+     * @brief Target state of one accessory of a scene.
+     */
+    struct Entry
+    {
+        BaseAccessoryInterface * accessory; ///< The accessory.
+        AccessoryStateRecord state;         ///< Its target state, currentPosition is not used.
+    };
+
+    /**
+     * @brief Aggregated report of one activation.
+     */
+    struct Report
+    {
+        uint8_t sceneId;               ///< Identifier passed to activate(), or of the preset.
+        uint16_t applied;              ///< Accessories driven to their target state.
+        uint16_t skipped;              ///< Entries not applied: unknown accessory, wrong type or identify running.
+        uint32_t durationUs;           ///< Time spent applying the states in microseconds.
+        const AccessoryEvent * events; ///< Change events of the accessories whose state changed.
+        size_t eventCount;             ///< Number of events.
+    };
+
+    /**
+     * @brief Statistics of the executor.
+     */
+    struct Stats
+    {
+        uint32_t activations; ///< Completed activations.
+        uint32_t rejected;    ///< Activations rejected because too large, unknown or concurrent.
+        uint32_t overruns;    ///< Activations that took longer than CONFIG_A_M_SCENE_BUDGET_US.
+        uint32_t lastUs;      ///< Duration of the last activation in microseconds.
+        uint32_t maxUs;       ///< Longest activation in microseconds.
+    };
+
+    /**
+     * @brief Type definition for the function receiving the aggregated report.
+     *
+     * @param report The report, its events are only valid during the call.
+     * @param callbackParam Pointer to user-defined data.
+     */
+    using ReportCallback = void (*)(const Report & report, void * callbackParam);
+
+    /**
+     * @brief Constructor for SceneExecutor.
+     *
+     * @param accessories Accessories the presets refer to by id, must outlive the executor. May be nullptr.
+     * @param count Number of accessories.
+     * @param storage Storage of the presets, nullptr to keep them in memory only.
+     */
+    SceneExecutor(BaseAccessoryInterface * const * accessories, size_t count, AccessoryStorageInterface * storage = nullptr);
+
+    /**
+     * @brief Sets the callback receiving the aggregated report of every activation.
+     *
+     * @param callback The callback function.
+     * @param callbackParam Optional parameter for the callback function.
+     */
+    void setReportCallback(ReportCallback callback, void * callbackParam = nullptr);
+
+    /**
+     * @brief Drives every accessory of a scene to its target state, then delivers one report.
+     *
+     * @param entries The accessories and their target states.
+     * @param count Number of entries, at most MAX_ENTRIES.
+     * @param sceneId Identifier carried by the report.
+     * @return True if the scene was activated, false if it was rejected.
+     */
+    bool activate(const Entry * entries, size_t count, uint8_t sceneId = 0);
+
+    /**
+     * @brief Stores a scene as a preset, replacing the preset with the same id.
+     *
+     * Accessories are stored by id, so their ids must be set first. Call savePresets() to persist the change.
+     *
+     * @param sceneId Identifier of the preset.
+     * @param entries The accessories and their target states.
+     * @param count Number of entries, at most MAX_ENTRIES.
+     * @return True if the preset was stored, false if there is no room left.
+     */
+    bool setPreset(uint8_t sceneId, const Entry * entries, size_t count);
+
+    /**
+     * @brief Removes a preset.
+     *
+     * @param sceneId Identifier of the preset.
+     * @return True if the preset existed, false otherwise.
+     */
+    bool removePreset(uint8_t sceneId);
+
+    /**
+     * @brief Activates a preset, resolving its accessories by id.
+     *
+     * @param sceneId Identifier of the preset.
+     * @return True if the scene was activated, false if the preset does not exist or the activation was rejected.
+     */
+    bool activatePreset(uint8_t sceneId);
+
+    /**
+     * @brief Replaces the presets in memory with those of the storage.
+     *
+     * @return True if valid presets were read, false if the storage is empty, invalid or unreadable.
+     */
+    bool loadPresets();
+
+    /**
+     * @brief Writes the presets in memory to the storage, erasing it first.
+     *
+     * @return True on success, false otherwise.
+     */
+    bool savePresets();
+
+    /**
+     * @brief Gets the statistics of the executor.
+     *
+     * @return The statistics.
+     */
+    Stats getStats();
+
+    /**
+     * @brief Gets the distribution of the activation durations.
+     *
+     * @return The statistics, all zero unless CONFIG_A_M_LATENCY_STATS is enabled.
+     */
+    AccessoryLatencyStats getLatencyStats() const;
+
+private:
+    /**
+     * @brief Target state of one accessory of a preset, 6 bytes.
+     */
+    struct PresetEntry
+    {
+        uint16_t accessoryId;    ///< Identifier of the accessory.
+        uint8_t accessoryType;   ///< AccessoryType of the accessory.
+        uint8_t flags;           ///< AccessoryStateRecord flag bits.
+        uint16_t targetPosition; ///< Blind target in hundredths of a percent.
+    };
+
+    /**
+     * @brief Location of one preset in m_presetEntries.
+     */
+    struct Preset
+    {
+        uint8_t sceneId;     ///< Identifier of the preset.
+        uint8_t entryCount;  ///< Number of entries.
+        uint16_t firstEntry; ///< Index of the first entry.
+    };
+
+    /**
+     * @brief Header of the presets in the storage, followed by the presets and their entries.
+     */
+    struct StorageHeader
+    {
+        uint32_t magic;       ///< STORAGE_MAGIC.
+        uint16_t presetCount; ///< Number of presets.
+        uint16_t entryCount;  ///< Number of entries.
+        uint16_t crc;         ///< CRC-16 of the presets and entries.
+        uint16_t reserved;    ///< Written as 0xFFFF.
+    };
+
+    static constexpr uint32_t STORAGE_MAGIC = 0x4353534D; ///< "MSSC" in little endian.
+
+    /**
+     * @brief Applies one target state and collects its change event.
+     *
+     * @param accessory The accessory, may be nullptr.
+     * @param state Its target state.
+     */
+    void apply(BaseAccessoryInterface * accessory, const AccessoryStateRecord & state);
+
+    /**
+     * @brief Claims the executor for an activation.
+     *
+     * @return True if no other activation is running, false otherwise.
+     */
+    bool begin();
+
+    /**
+     * @brief Measures the activation, delivers its report and releases the executor.
+     *
+     * @param sceneId Identifier carried by the report.
+     * @param startUs esp_timer time at which the activation started.
+     */
+    void finish(uint8_t sceneId, int64_t startUs);
+
+    /**
+     * @brief Finds an accessory by id.
+     *
+     * @param accessoryId Identifier of the accessory.
+     * @return The accessory, nullptr if none has the id.
+     */
+    BaseAccessoryInterface * findAccessory(uint16_t accessoryId);
+
+    /**
+     * @brief Finds a preset by id.
+     *
+     * @param sceneId Identifier of the preset.
+     * @return Index in m_presets, -1 if it does not exist.
+     */
+    int findPreset(uint8_t sceneId);
+
+    BaseAccessoryInterface * const * m_accessories;  ///< Accessories the presets refer to.
+    size_t m_accessoryCount;                         ///< Number of accessories.
+    AccessoryStorageInterface * m_storage;           ///< Storage of the presets, may be nullptr.
+    ReportCallback m_reportCallback;                 ///< Callback receiving the aggregated report.
+    void * m_reportCallbackParam;                    ///< Parameter passed to the report callback.
+    AccessoryEvent m_events[MAX_ENTRIES];            ///< Change events of the running activation.
+    size_t m_eventCount;                             ///< Number of events of the running activation.
+    uint16_t m_applied;                              ///< Applied entries of the running activation.
+    uint16_t m_skipped;                              ///< Skipped entries of the running activation.
+    Preset m_presets[MAX_PRESETS];                   ///< Presets, in the order they were stored.
+    size_t m_presetCount;                            ///< Number of presets.
+    PresetEntry m_presetEntries[MAX_PRESET_ENTRIES]; ///< Entries of all presets, contiguous per preset.
+    size_t m_presetEntryCount;                       ///< Number of used entries.
+    std::atomic<bool> m_busy;                        ///< Set while an activation runs.
+    Stats m_stats;                                   ///< Statistics of the executor.
+    portMUX_TYPE m_lock;                             ///< Protects the statistics.
+
+#if CONFIG_A_M_LATENCY_STATS
+    AccessoryLatencyHistogram m_activationLatency; ///< Duration of the activations.
+#endif
+
+    // Delete copy constructor and assignment operator
+    SceneExecutor(const SceneExecutor &)             = delete;
+    SceneExecutor & operator=(const SceneExecutor &) = delete;
+};
@@ -1,11 +1,25 @@
 #pragma once
 
+#include "AccessoryPressDecoder.hpp"
+#include "AccessoryReporter.hpp"
+#include "AccessorySeqlock.hpp"
 #include "StatelessButtonAccessoryInterface.hpp"
 #include <ButtonModuleInterface.hpp>
+#include <atomic>
 #include <esp_log.h>
+#include <sdkconfig.h>
 
 /**
  * @brief Class representing a stateless button accessory.
+ *
+ * Every press is also queued with its time and sequence number in a fixed-capacity single-producer,
+ * single-consumer queue, so presses closer together than the application reads them are not lost. The button
+ * module is the producer and the caller of drainEvents() the consumer; only one task may drain.
+ *
+ * Instead of the button module, which waits for its double press window before reporting a single press, raw
+ * edges can be fed with handleEdge() to an AccessoryPressDecoder with a per-button timing profile. Pass nullptr as
+ * the button module in that case; edges must come from a single task, and the decoded presses are numbered,
+ * queued and reported from the timer service task only.
  */
 class StatelessButtonAccessory : public StatelessButtonAccessoryInterface
 {
@@ -13,7 +27,7 @@ public:
     /**
      * @brief Constructor for StatelessButtonAccessory.
      *
-     * @param buttonModule Pointer to the button module interface.
+     * @param buttonModule Pointer to the button module interface, nullptr when edges are fed with handleEdge().
      */
     StatelessButtonAccessory(ButtonModuleInterface * buttonModule);
 
@@ -30,11 +44,93 @@ public:
      */
     void setReportCallback(ReportCallback callback, CallbackParam * callbackParam = nullptr) override;
 
+    /**
+     * @brief Sets the callback function receiving typed change events.
+     *
+     * @param callback The callback function.
+     * @param callbackParam Optional parameter for the callback function.
+     */
+    void setEventCallback(EventCallback callback, CallbackParam * callbackParam = nullptr) override;
+
+    /**
+     * @brief Sets the identifier carried by the events of this accessory.
+     *
+     * @param accessoryId The identifier.
+     */
+    void setAccessoryId(uint16_t accessoryId) override;
+
+    /**
+     * @brief Gets the identifier carried by the events of this accessory.
+     *
+     * @return The identifier.
+     */
+    uint16_t getAccessoryId() override;
+
+    /**
+     * @brief Attaches the store persisting the state of this accessory.
+     *
+     * @param stateStore The store, nullptr to detach.
+     */
+    void setStateStore(AccessoryStateStore * stateStore) override;
+
+    /**
+     * @brief Applies a saved state without logging, reporting or updating the state store.
+     *
+     * The accessory has no state, only the record type is checked.
+     *
+     * @param record The saved state.
+     * @return True if the record was applied, false otherwise.
+     */
+    bool restore(const AccessoryStateRecord & record) override;
+
+    /**
+     * @brief Resumes the operation in flight when the chip reset, from the retained state.
+     *
+     * The accessory has no operation that outlives a restart, nothing is resumed.
+     *
+     * @return True if retained state was applied, false otherwise.
+     */
+    bool resume() override;
+
+    /**
+     * @brief Drives the accessory to a scene state without logging or reporting.
+     *
+     * The accessory has no state, nothing is applied.
+     *
+     * @param state The target state.
+     * @param event Receives the change event.
+     * @return True if the state was applied, false otherwise.
+     */
+    bool applyState(const AccessoryStateRecord & state, AccessoryEvent & event) override;
+
+    /**
+     * @brief Gets the current state of the accessory in the format of the state store.
+     *
+     * A stateless button has no state: only the accessory id and type are filled.
+     *
+     * @param state Receives the state, with the accessory id and type.
+     * @return True if the accessory has a state, false otherwise.
+     */
+    bool getState(AccessoryStateRecord & state) override;
+
+    /**
+     * @brief Gets the latency statistics of an instrumented path of this accessory.
+     *
+     * @param path The instrumented path.
+     * @return The statistics, all zero unless CONFIG_A_M_LATENCY_STATS is enabled.
+     */
+    AccessoryLatencyStats getLatencyStats(AccessoryLatencyPath path) override;
+
     /**
      * @brief Identifies the stateless button accessory.
      */
     void identify() override;
 
+    /**
+     * @brief Stops the identification of the stateless button accessory.
+     */
+    void stopIdentify() override;
+
     /**
      * @brief Gets the last press type.
      *
@@ -42,21 +138,86 @@ public:
      */
     PressType getLastPressType() override;
 
+    /**
+     * @brief Gets the last press, its type, time, sequence number and count read together. Lock-free.
+     *
+     * @return The last press, with sequence number 0 before the first press.
+     */
+    PressEvent getLastPress() override;
+
+    /**
+     * @brief Moves the queued presses, oldest first, into the given array. Lock-free and silent.
+     *
+     * @param events Array receiving the presses.
+     * @param maxEvents Capacity of the array.
+     * @return Number of presses written.
+     */
+    size_t drainEvents(PressEvent * events, size_t maxEvents) override;
+
+    /**
+     * @brief Gets the number of presses dropped because the queue was full.
+     *
+     * @return The overflow count since construction.
+     */
+    uint32_t getOverflowCount() override;
+
+    /**
+     * @brief Sets the timing profile used to decode the edges fed with handleEdge().
+     *
+     * @param profile The profile.
+     */
+    void setPressProfile(const AccessoryPressProfile & profile) override;
+
+    /**
+     * @brief Feeds a raw edge of the button to the press decoder.
+     *
+     * The presses it completes are reported shortly after, from the timer service task.
+     *
+     * @param pressed True when the button went down, false when it was released.
+     */
+    void handleEdge(bool pressed) override;
+
 private:
-    ButtonModuleInterface * m_buttonModule; ///< Pointer to the button module interface.
-    PressType m_lastPressType;              ///< Stores the type of the last press.
+    static constexpr uint32_t QUEUE_SIZE = CONFIG_A_M_STATELESS_BUTTON_QUEUE_SIZE; ///< Capacity of the press queue.
+    static_assert((QUEUE_SIZE & (QUEUE_SIZE - 1)) == 0, "CONFIG_A_M_STATELESS_BUTTON_QUEUE_SIZE must be a power of two");
+
+    ButtonModuleInterface * m_buttonModule;   ///< Pointer to the button module interface.
+    AccessorySeqlock<PressEvent> m_lastPress; ///< The last press, written by the producer.
 
-    ReportCallback m_reportCallback;       ///< Callback function for reporting.
-    CallbackParam * m_reportCallbackParam; ///< Parameter for the callback function.
+    PressEvent m_queue[QUEUE_SIZE];        ///< Queued presses, indexed by position modulo QUEUE_SIZE.
+    std::atomic<uint32_t> m_writePosition; ///< Number of presses queued, written by the producer only.
+    std::atomic<uint32_t> m_readPosition;  ///< Number of presses drained, written by drainEvents() only.
+    std::atomic<uint32_t> m_overflowCount; ///< Presses dropped because the queue was full.
+    uint32_t m_sequence;                   ///< Sequence number of the last press, written by the producer only.
+
+    AccessoryReporter m_reporter;    ///< Delivers change events and reports to the application.
+    AccessoryPressDecoder m_decoder; ///< Decodes the edges fed with handleEdge().
 
     /**
      * @brief Handles the button press.
      *
      * @param instance Pointer to the StatelessButtonAccessory object.
      * @param pressType The type of the press.
+     * @param pressCount Number of presses of the sequence.
      * @param logMessage The message to log.
      */
-    static void handlePress(void * instance, PressType pressType, const char * logMessage);
+    static void handlePress(void * instance, PressType pressType, uint8_t pressCount, const char * logMessage);
+
+    /**
+     * @brief Handles a press decoded from raw edges.
+     *
+     * @param instance Pointer to the StatelessButtonAccessory object.
+     * @param pressType The type of the press.
+     * @param pressCount Number of presses of the sequence.
+     */
+    static void handleDecodedPress(void * instance, PressType pressType, uint8_t pressCount);
+
+    /**
+     * @brief Queues a press for drainEvents(), or counts it as an overflow if the queue is full.
+     *
+     * @param event The press.
+     */
+    void enqueue(const PressEvent & event);
 
     // Delete the copy constructor and assignment operator
     StatelessButtonAccessory(const StatelessButtonAccessory &)             = delete;
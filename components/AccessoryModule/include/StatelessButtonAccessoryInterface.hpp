@@ -1,7 +1,12 @@
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include "BaseAccessoryInterface.hpp"
 
+struct AccessoryPressProfile;
+
 /**
  * @brief Interface for stateless button accessory functionalities.
  */
@@ -13,9 +18,23 @@ public:
      */
     enum PressType
     {
-        SinglePress = 1, ///< Represents a single press event.
-        DoublePress = 2, ///< Represents a double press event.
-        LongPress   = 3  ///< Represents a long press event.
+        SinglePress      = 1, ///< Represents a single press event.
+        DoublePress      = 2, ///< Represents a double press event.
+        LongPress        = 3, ///< Represents a long press event.
+        MultiPress       = 4, ///< Three or more presses in a sequence, decoded from raw edges only.
+        LongPressRepeat  = 5, ///< Long press still held, decoded from raw edges only.
+        LongPressRelease = 6  ///< Long press released, decoded from raw edges only.
+    };
+
+    /**
+     * @brief A press, as queued for drainEvents().
+     */
+    struct PressEvent
+    {
+        PressType pressType; ///< Type of the press.
+        int64_t timestampUs; ///< AccessoryClock time of the press in microseconds.
+        uint32_t sequence;   ///< Number of the press since construction, starting at 1. A gap means dropped presses.
+        uint8_t pressCount;  ///< Presses of the sequence, 1 for presses reported by the button module.
     };
 
     /**
@@ -42,4 +61,41 @@ public:
      * @return The type of the last press.
      */
     virtual PressType getLastPressType() = 0;
+
+    /**
+     * @brief Gets the last press, its type, time, sequence number and count read together.
+     *
+     * @return The last press, with sequence number 0 before the first press.
+     */
+    virtual PressEvent getLastPress() = 0;
+
+    /**
+     * @brief Moves the queued presses, oldest first, into the given array.
+     *
+     * @param events Array receiving the presses.
+     * @param maxEvents Capacity of the array.
+     * @return Number of presses written.
+     */
+    virtual size_t drainEvents(PressEvent * events, size_t maxEvents) = 0;
+
+    /**
+     * @brief Gets the number of presses dropped because the queue was full.
+     *
+     * @return The overflow count since construction.
+     */
+    virtual uint32_t getOverflowCount() = 0;
+
+    /**
+     * @brief Sets the timing profile used to decode the edges fed with handleEdge().
+     *
+     * @param profile The profile.
+     */
+    virtual void setPressProfile(const AccessoryPressProfile & profile) = 0;
+
+    /**
+     * @brief Feeds a raw edge of the button to the press decoder.
+     *
+     * @param pressed True when the button went down, false when it was released.
+     */
+    virtual void handleEdge(bool pressed) = 0;
 };
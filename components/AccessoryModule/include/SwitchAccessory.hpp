@@ -1,16 +1,31 @@
 #pragma once
 
-#include "SwitchAccessoryInterface.hpp"
-
 #include <ButtonModuleInterface.hpp>
 #include <RelayModuleInterface.hpp>
-#include <freertos/FreeRTOS.h>
-#include <freertos/task.h>
+
+#include "SwitchAccessoryInterface.hpp"
+#include "RelayToggleAccessory.hpp"
+
+/**
+ * @brief Compile-time traits of SwitchAccessory, see RelayToggleDescriptor.
+ */
+struct SwitchAccessoryTraits
+{
+    using Interface = SwitchAccessoryInterface; ///< Interface implemented by SwitchAccessory.
+
+    static constexpr const char * TAG                         = "SwitchAccessory";              ///< Log tag.
+    static constexpr AccessoryType TYPE                       = AccessoryType::Switch;          ///< Type of the events.
+    static constexpr const IdentifyPattern * IDENTIFY_PATTERN = &IdentifyPatterns::RELAY_BLINK; ///< Default identify pattern.
+    static constexpr bool RESTART_IDENTIFY                    = true;                           ///< Restart a running pattern.
+};
 
 /**
  * @brief Class representing a switch accessory.
+ *
+ * The accessory code is shared with the other relay toggle accessories in RelayToggleCore. Firmware that does not
+ * need SwitchAccessoryInterface can use StaticRelayToggleAccessory<SwitchAccessoryTraits> instead.
  */
-class SwitchAccessory : public SwitchAccessoryInterface
+class SwitchAccessory : public RelayToggleAccessory<SwitchAccessoryTraits>
 {
 public:
     /**
@@ -21,11 +36,6 @@ public:
      */
     SwitchAccessory(RelayModuleInterface * relayModule, ButtonModuleInterface * buttonModule);
 
-    /**
-     * @brief Destructor for SwitchAccessory.
-     */
-    ~SwitchAccessory();
-
     /**
      * @brief Sets the power state of the switch accessory.
      *
@@ -40,36 +50,8 @@ public:
      */
     bool getPower() override;
 
-    /**
-     * @brief Sets the callback function for reporting to the application.
-     *
-     * @param callback The callback function.
-     * @param callbackParam Optional parameter for the callback function.
-     */
-    void setReportCallback(ReportCallback callback, CallbackParam * callbackParam = nullptr) override;
-
-    /**
-     * @brief Identifies the switch accessory.
-     */
-    void identify() override;
-
 private:
-    /**
-     * @brief Function called when the button is pressed.
-     *
-     * @param instance Pointer to the instance of the class.
-     */
-    static void buttonCallback(void * instance);
-
-    RelayModuleInterface * m_relayModule;   ///< Pointer to the relay module interface.
-    ButtonModuleInterface * m_buttonModule; ///< Pointer to the button module interface.
-
-    ReportCallback m_reportCallback;       ///< Callback function for reporting.
-    CallbackParam * m_reportCallbackParam; ///< Parameter for the callback function.
-
-    TaskHandle_t m_identifyHandler; ///< Task handler for the identify function.
-
-    // Delete the copy constructor and assignment operator
+    // Delete copy constructor and assignment operator
     SwitchAccessory(const SwitchAccessory &)             = delete;
     SwitchAccessory & operator=(const SwitchAccessory &) = delete;
 };
@@ -0,0 +1,28 @@
+#include "AccessoryClock.hpp"
+
+#if CONFIG_A_M_VIRTUAL_TIME
+
+#include <atomic>
+
+static std::atomic<int64_t> s_virtualTime(0);
+
+int64_t AccessoryClock::now()
+{
+    return s_virtualTime.load(std::memory_order_relaxed);
+}
+
+void AccessoryClock::set(int64_t nowUs)
+{
+    s_virtualTime.store(nowUs, std::memory_order_relaxed);
+}
+
+#else
+
+#include <esp_timer.h>
+
+int64_t AccessoryClock::now()
+{
+    return esp_timer_get_time();
+}
+
+#endif
@@ -0,0 +1,142 @@
+#include "AccessoryConfig.hpp"
+
+#include <esp_log.h>
+
+#include "AccessoryCrc.hpp"
+#include "BlindAccessory.hpp"
+#include "DoorLockAccessory.hpp"
+#include "FanAccessory.hpp"
+#include "LightAccessory.hpp"
+#include "PluginAccessory.hpp"
+#include "StatelessButtonAccessory.hpp"
+#include "SwitchAccessory.hpp"
+
+static const char * TAG = "AccessoryConfig";
+
+AccessoryConfig::AccessoryConfig(const void * image, size_t size) : m_records(nullptr), m_recordSize(0), m_recordCount(0)
+{
+    const AccessoryConfigHeader * header = static_cast<const AccessoryConfigHeader *>(image);
+    if (!image || size < sizeof(AccessoryConfigHeader) || header->magic != MAGIC)
+    {
+        ESP_LOGW(TAG, "No accessory configuration");
+        return;
+    }
+    if (header->version != VERSION)
+    {
+        ESP_LOGE(TAG, "Configuration version %d is not supported, expected %d", header->version, VERSION);
+        return;
+    }
+    // Records stay in the image: the sizes must keep their 16-bit fields aligned.
+    if (header->headerSize < sizeof(AccessoryConfigHeader) || header->recordSize < sizeof(AccessoryConfigRecord) ||
+        header->headerSize % alignof(AccessoryConfigRecord) || header->recordSize % alignof(AccessoryConfigRecord) ||
+        header->headerSize + size_t(header->recordSize) * header->recordCount > size)
+    {
+        ESP_LOGE(TAG, "Configuration layout is invalid");
+        return;
+    }
+    const uint8_t * records = static_cast<const uint8_t *>(image) + header->headerSize;
+    if (checksum(records, size_t(header->recordSize) * header->recordCount) != header->crc)
+    {
+        ESP_LOGE(TAG, "Configuration is corrupted");
+        return;
+    }
+    m_records     = records;
+    m_recordSize  = header->recordSize;
+    m_recordCount = header->recordCount;
+}
+
+bool AccessoryConfig::isValid() const
+{
+    return m_records != nullptr;
+}
+
+size_t AccessoryConfig::size() const
+{
+    return m_recordCount;
+}
+
+const AccessoryConfigRecord & AccessoryConfig::record(size_t index) const
+{
+    return *reinterpret_cast<const AccessoryConfigRecord *>(m_records + index * m_recordSize);
+}
+
+size_t AccessoryConfig::build(AccessoryRegistry & registry, RelayModuleInterface * const * relays, size_t relayCount,
+                              ButtonModuleInterface * const * buttons, size_t buttonCount) const
+{
+    size_t built = 0;
+    for (size_t i = 0; i < m_recordCount; i++)
+    {
+        if (buildRecord(record(i), registry, relays, relayCount, buttons, buttonCount))
+        {
+            built++;
+        }
+    }
+    ESP_LOGI(TAG, "Built %d of %d configured accessories", static_cast<int>(built), static_cast<int>(m_recordCount));
+    return built;
+}
+
+uint16_t AccessoryConfig::checksum(const void * data, size_t length)
+{
+    return AccessoryCrc::update(AccessoryCrc::INITIAL, data, length);
+}
+
+BaseAccessoryInterface * AccessoryConfig::buildRecord(const AccessoryConfigRecord & record, AccessoryRegistry & registry,
+                                                      RelayModuleInterface * const * relays, size_t relayCount,
+                                                      ButtonModuleInterface * const * buttons, size_t buttonCount)
+{
+    // An unused index maps to nullptr, an index outside the table is a configuration error.
+    RelayModuleInterface * relay[2]   = {};
+    ButtonModuleInterface * button[2] = {};
+    for (size_t i = 0; i < 2; i++)
+    {
+        if ((record.relays[i] != AccessoryConfigRecord::NONE && record.relays[i] >= relayCount) ||
+            (record.buttons[i] != AccessoryConfigRecord::NONE && record.buttons[i] >= buttonCount))
+        {
+            ESP_LOGE(TAG, "Endpoint %d uses a relay or button the board does not have", record.endpointId);
+            return nullptr;
+        }
+        relay[i]  = record.relays[i] == AccessoryConfigRecord::NONE ? nullptr : relays[record.relays[i]];
+        button[i] = record.buttons[i] == AccessoryConfigRecord::NONE ? nullptr : buttons[record.buttons[i]];
+    }
+
+    AccessoryType type = static_cast<AccessoryType>(record.type);
+    bool wired         = relay[0] != nullptr;
+    switch (type)
+    {
+    case AccessoryType::DoorLock:
+        wired = wired && button[0];
+        break;
+    case AccessoryType::Blind:
+        wired = wired && relay[1];
+        break;
+    case AccessoryType::StatelessButton:
+        wired = true;
+        break;
+    default:
+        break;
+    }
+    if (record.type >= ACCESSORY_TYPE_COUNT || !wired)
+    {
+        ESP_LOGE(TAG, "Endpoint %d has type %d or wiring that cannot be built", record.endpointId, record.type);
+        return nullptr;
+    }
+
+    switch (type)
+    {
+    case AccessoryType::Light:
+        return registry.emplace<LightAccessory>(record.endpointId, relay[0], button[0]);
+    case AccessoryType::Fan:
+        return registry.emplace<FanAccessory>(record.endpointId, relay[0], button[0]);
+    case AccessoryType::Switch:
+        return registry.emplace<SwitchAccessory>(record.endpointId, relay[0], button[0]);
+    case AccessoryType::Plugin:
+        return registry.emplace<PluginAccessory>(record.endpointId, relay[0], button[0]);
+    case AccessoryType::DoorLock:
+        return registry.emplace<DoorLockAccessory>(record.endpointId, relay[0], button[0], record.timing[0]);
+    case AccessoryType::Blind:
+        return registry.emplace<BlindAccessory>(record.endpointId, relay[0], relay[1], button[0], button[1], record.timing[0],
+                                                record.timing[1]);
+    default:
+        return registry.emplace<StatelessButtonAccessory>(record.endpointId, button[0]);
+    }
+}
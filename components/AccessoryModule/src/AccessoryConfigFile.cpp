@@ -0,0 +1,57 @@
+#include "AccessoryConfigFile.hpp"
+
+#if !defined(ESP_PLATFORM) || CONFIG_IDF_TARGET_LINUX
+
+#include <esp_log.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char * TAG = "AccessoryConfigFile";
+
+AccessoryConfigFile::AccessoryConfigFile(const char * path) : m_data(nullptr), m_size(0)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        ESP_LOGE(TAG, "Cannot open %s", path);
+        return;
+    }
+    struct stat status;
+    if (fstat(fd, &status) == 0 && status.st_size > 0)
+    {
+        void * data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED)
+        {
+            m_data = data;
+            m_size = static_cast<size_t>(status.st_size);
+        }
+    }
+    // The mapping keeps the file referenced.
+    close(fd);
+    if (!m_data)
+    {
+        ESP_LOGE(TAG, "Cannot map %s", path);
+    }
+}
+
+AccessoryConfigFile::~AccessoryConfigFile()
+{
+    if (m_data)
+    {
+        munmap(const_cast<void *>(m_data), m_size);
+    }
+}
+
+const void * AccessoryConfigFile::getData() const
+{
+    return m_data;
+}
+
+size_t AccessoryConfigFile::getSize() const
+{
+    return m_size;
+}
+
+#endif // !defined(ESP_PLATFORM) || CONFIG_IDF_TARGET_LINUX
@@ -0,0 +1,45 @@
+#include "AccessoryConfigPartition.hpp"
+
+#if CONFIG_A_M_CONFIG_PARTITION
+
+#include <esp_log.h>
+
+static const char * TAG = "AccessoryConfigPartition";
+
+AccessoryConfigPartition::AccessoryConfigPartition(const char * label) : m_data(nullptr), m_size(0), m_handle(0)
+{
+    const esp_partition_t * partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    if (!partition)
+    {
+        ESP_LOGE(TAG, "Partition %s not found", label);
+        return;
+    }
+    esp_err_t err = esp_partition_mmap(partition, 0, partition->size, ESP_PARTITION_MMAP_DATA, &m_data, &m_handle);
+    if (err != ESP_OK)
+    {
+        ESP_LOGE(TAG, "Cannot map partition %s: %s", label, esp_err_to_name(err));
+        m_data = nullptr;
+        return;
+    }
+    m_size = partition->size;
+}
+
+AccessoryConfigPartition::~AccessoryConfigPartition()
+{
+    if (m_data)
+    {
+        esp_partition_munmap(m_handle);
+    }
+}
+
+const void * AccessoryConfigPartition::getData() const
+{
+    return m_data;
+}
+
+size_t AccessoryConfigPartition::getSize() const
+{
+    return m_size;
+}
+
+#endif // CONFIG_A_M_CONFIG_PARTITION
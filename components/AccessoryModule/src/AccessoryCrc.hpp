@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF) of the state store journal, the scene presets and
+ * the configuration images. Internal to the component.
+ */
+class AccessoryCrc
+{
+public:
+    static constexpr uint16_t INITIAL = 0xFFFF; ///< CRC of an empty buffer.
+
+    /**
+     * @brief Continues a CRC over a buffer.
+     *
+     * @param crc CRC of the preceding buffers, INITIAL for the first one.
+     * @param data The buffer.
+     * @param length Size of the buffer.
+     * @return CRC including the buffer.
+     */
+    static uint16_t update(uint16_t crc, const void * data, size_t length);
+};
@@ -0,0 +1,151 @@
+#include "AccessoryEventDispatcher.hpp"
+
+#if CONFIG_A_M_EVENT_DISPATCHER_ENABLE
+
+#include <esp_log.h>
+
+#include "AccessoryReporter.hpp"
+#include "AccessoryTelemetry.hpp"
+
+static const char * TAG = "AccessoryEventDispatcher";
+
+AccessoryEventDispatcher & AccessoryEventDispatcher::instance()
+{
+    static AccessoryEventDispatcher dispatcher;
+    return dispatcher;
+}
+
+AccessoryEventDispatcher::AccessoryEventDispatcher() :
+    m_enqueuePosition(0), m_dequeuePosition(0), m_deliveredCount(0), m_droppedCount(0), m_highWater(0), m_taskHandle(nullptr)
+{
+    ESP_LOGI(TAG, "Starting event dispatcher with %d slots", CONFIG_A_M_EVENT_DISPATCHER_QUEUE_SIZE);
+    for (size_t i = 0; i < CAPACITY; i++)
+    {
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        m_slots[i].reporter = nullptr;
+    }
+
+#if CONFIG_A_M_TIMER_SERVICE_STATIC_ALLOCATION
+    static StackType_t stack[CONFIG_A_M_EVENT_DISPATCHER_STACK_SIZE];
+    static StaticTask_t taskBuffer;
+    m_taskHandle = xTaskCreateStaticPinnedToCore(dispatcherTask, "accessoryEvents", CONFIG_A_M_EVENT_DISPATCHER_STACK_SIZE, this,
+                                                 CONFIG_A_M_EVENT_DISPATCHER_PRIORITY, stack, &taskBuffer, tskNO_AFFINITY);
+#else
+    xTaskCreatePinnedToCore(dispatcherTask, "accessoryEvents", CONFIG_A_M_EVENT_DISPATCHER_STACK_SIZE, this,
+                            CONFIG_A_M_EVENT_DISPATCHER_PRIORITY, &m_taskHandle, tskNO_AFFINITY);
+#endif
+    AccessoryTelemetry::taskCreated(AccessoryTask::EVENT_DISPATCHER, "accessoryEvents", m_taskHandle,
+                                    CONFIG_A_M_EVENT_DISPATCHER_STACK_SIZE);
+}
+
+bool AccessoryEventDispatcher::post(AccessoryReporter * reporter, const AccessoryEvent & event)
+{
+    size_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+    Slot * slot;
+
+    for (;;)
+    {
+        slot             = &m_slots[position & (CAPACITY - 1)];
+        size_t sequence  = slot->sequence.load(std::memory_order_acquire);
+        intptr_t pending = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+        if (pending == 0)
+        {
+            if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (pending < 0)
+        {
+            m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        else
+        {
+            position = m_enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->reporter = reporter;
+    slot->event    = event;
+    slot->sequence.store(position + 1, std::memory_order_release);
+
+    // The dispatcher may already have consumed this event, in which case the depth is not positive.
+    intptr_t depth     = static_cast<intptr_t>(position + 1 - m_dequeuePosition.load(std::memory_order_relaxed));
+    uint32_t highWater = m_highWater.load(std::memory_order_relaxed);
+    while (depth > static_cast<intptr_t>(highWater) &&
+           !m_highWater.compare_exchange_weak(highWater, static_cast<uint32_t>(depth), std::memory_order_relaxed))
+    {
+    }
+
+    if (m_taskHandle)
+    {
+        xTaskNotifyGive(m_taskHandle);
+    }
+    return true;
+}
+
+void AccessoryEventDispatcher::drain(AccessoryReporter * reporter)
+{
+    if (xTaskGetCurrentTaskHandle() == m_taskHandle)
+    {
+        // The dispatcher cannot wait for itself. Only producers run meanwhile, and they never touch a filled slot.
+        size_t end = m_enqueuePosition.load(std::memory_order_acquire);
+        for (size_t position = m_dequeuePosition.load(std::memory_order_relaxed); position != end; position++)
+        {
+            Slot & slot = m_slots[position & (CAPACITY - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) == position + 1 && slot.reporter == reporter)
+            {
+                slot.reporter = nullptr;
+            }
+        }
+        return;
+    }
+
+    size_t target = m_enqueuePosition.load(std::memory_order_acquire);
+    while (static_cast<intptr_t>(target - m_deliveredCount.load(std::memory_order_acquire)) > 0)
+    {
+        vTaskDelay(1);
+    }
+}
+
+AccessoryEventDispatcher::Stats AccessoryEventDispatcher::getStats() const
+{
+    Stats stats;
+    stats.enqueued  = m_enqueuePosition.load(std::memory_order_relaxed);
+    stats.dropped   = m_droppedCount.load(std::memory_order_relaxed);
+    stats.highWater = m_highWater.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void AccessoryEventDispatcher::dispatcherTask(void * instance)
+{
+    AccessoryEventDispatcher * dispatcher = static_cast<AccessoryEventDispatcher *>(instance);
+    ESP_LOGI(TAG, "Event dispatcher task started");
+
+    for (;;)
+    {
+        size_t position = dispatcher->m_dequeuePosition.load(std::memory_order_relaxed);
+        Slot * slot     = &dispatcher->m_slots[position & (CAPACITY - 1)];
+        if (slot->sequence.load(std::memory_order_acquire) != position + 1)
+        {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        AccessoryReporter * reporter = slot->reporter;
+        AccessoryEvent event         = slot->event;
+        slot->sequence.store(position + CAPACITY, std::memory_order_release);
+        dispatcher->m_dequeuePosition.store(position + 1, std::memory_order_relaxed);
+
+        if (reporter)
+        {
+            int64_t start = AccessoryTelemetry::beginCallback(AccessoryTask::EVENT_DISPATCHER);
+            reporter->deliver(event);
+            AccessoryTelemetry::endCallback(AccessoryTask::EVENT_DISPATCHER, static_cast<uint8_t>(event.accessoryType), start);
+        }
+        dispatcher->m_deliveredCount.fetch_add(1, std::memory_order_release);
+    }
+}
+
+#endif // CONFIG_A_M_EVENT_DISPATCHER_ENABLE
@@ -0,0 +1,74 @@
+#include "AccessoryFileStorage.hpp"
+
+#include <esp_log.h>
+#include <stdint.h>
+#include <string.h>
+
+static const char * TAG = "AccessoryFileStorage";
+
+AccessoryFileStorage::AccessoryFileStorage(const char * path, size_t size) : m_file(fopen(path, "r+b")), m_size(size)
+{
+    if (!m_file)
+    {
+        ESP_LOGI(TAG, "Creating %s with %d bytes", path, static_cast<int>(size));
+        m_file = fopen(path, "w+b");
+        if (!m_file || !erase(0, size))
+        {
+            ESP_LOGE(TAG, "Cannot create %s", path);
+        }
+    }
+}
+
+AccessoryFileStorage::~AccessoryFileStorage()
+{
+    if (m_file)
+    {
+        fclose(m_file);
+    }
+}
+
+size_t AccessoryFileStorage::getSize()
+{
+    return m_size;
+}
+
+bool AccessoryFileStorage::read(size_t offset, void * data, size_t length)
+{
+    if (!m_file || offset + length > m_size || fseek(m_file, static_cast<long>(offset), SEEK_SET) != 0)
+    {
+        return false;
+    }
+    size_t got = fread(data, 1, length, m_file);
+    // A file shorter than the storage reads as erased beyond its end.
+    memset(static_cast<uint8_t *>(data) + got, 0xFF, length - got);
+    return true;
+}
+
+bool AccessoryFileStorage::write(size_t offset, const void * data, size_t length)
+{
+    if (!m_file || offset + length > m_size || fseek(m_file, static_cast<long>(offset), SEEK_SET) != 0)
+    {
+        return false;
+    }
+    return fwrite(data, 1, length, m_file) == length && fflush(m_file) == 0;
+}
+
+bool AccessoryFileStorage::erase(size_t offset, size_t length)
+{
+    if (!m_file || offset + length > m_size || fseek(m_file, static_cast<long>(offset), SEEK_SET) != 0)
+    {
+        return false;
+    }
+    uint8_t erased[64];
+    memset(erased, 0xFF, sizeof(erased));
+    while (length > 0)
+    {
+        size_t chunk = length < sizeof(erased) ? length : sizeof(erased);
+        if (fwrite(erased, 1, chunk, m_file) != chunk)
+        {
+            return false;
+        }
+        length -= chunk;
+    }
+    return fflush(m_file) == 0;
+}
@@ -0,0 +1,70 @@
+#include "AccessoryLatencyHistogram.hpp"
+
+AccessoryLatencyHistogram::AccessoryLatencyHistogram()
+{
+    reset();
+}
+
+void AccessoryLatencyHistogram::record(uint32_t latencyUs)
+{
+    size_t bucket = latencyUs == 0 ? 0 : 32 - __builtin_clz(latencyUs);
+    if (bucket >= BUCKET_COUNT)
+    {
+        bucket = BUCKET_COUNT - 1;
+    }
+    m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+
+    uint32_t max = m_max.load(std::memory_order_relaxed);
+    while (latencyUs > max && !m_max.compare_exchange_weak(max, latencyUs, std::memory_order_relaxed))
+    {
+    }
+}
+
+uint32_t AccessoryLatencyHistogram::percentile(uint8_t percent) const
+{
+    uint32_t count = m_count.load(std::memory_order_relaxed);
+    uint32_t max   = m_max.load(std::memory_order_relaxed);
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    // Rank of the sample at the percentile, rounded up so that p100 is the largest sample.
+    uint64_t rank       = (static_cast<uint64_t>(count) * percent + 99) / 100;
+    uint64_t cumulative = 0;
+    for (size_t bucket = 0; bucket < BUCKET_COUNT; bucket++)
+    {
+        cumulative += m_buckets[bucket].load(std::memory_order_relaxed);
+        if (cumulative >= rank)
+        {
+            if (bucket == BUCKET_COUNT - 1)
+            {
+                return max;
+            }
+            uint32_t upperBound = bucket == 0 ? 0 : (1u << bucket) - 1;
+            return upperBound < max ? upperBound : max;
+        }
+    }
+    return max;
+}
+
+AccessoryLatencyStats AccessoryLatencyHistogram::getStats() const
+{
+    AccessoryLatencyStats stats;
+    stats.count = m_count.load(std::memory_order_relaxed);
+    stats.p50Us = percentile(50);
+    stats.p99Us = percentile(99);
+    stats.maxUs = m_max.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void AccessoryLatencyHistogram::reset()
+{
+    for (size_t bucket = 0; bucket < BUCKET_COUNT; bucket++)
+    {
+        m_buckets[bucket].store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,38 @@
+#include "AccessoryPartitionStorage.hpp"
+
+#if CONFIG_A_M_STATE_STORE_PARTITION
+
+#include <esp_log.h>
+
+static const char * TAG = "AccessoryPartitionStorage";
+
+AccessoryPartitionStorage::AccessoryPartitionStorage(const char * label) :
+    m_partition(esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label))
+{
+    if (!m_partition)
+    {
+        ESP_LOGE(TAG, "Partition %s not found", label);
+    }
+}
+
+size_t AccessoryPartitionStorage::getSize()
+{
+    return m_partition ? m_partition->size : 0;
+}
+
+bool AccessoryPartitionStorage::read(size_t offset, void * data, size_t length)
+{
+    return m_partition && esp_partition_read(m_partition, offset, data, length) == ESP_OK;
+}
+
+bool AccessoryPartitionStorage::write(size_t offset, const void * data, size_t length)
+{
+    return m_partition && esp_partition_write(m_partition, offset, data, length) == ESP_OK;
+}
+
+bool AccessoryPartitionStorage::erase(size_t offset, size_t length)
+{
+    return m_partition && esp_partition_erase_range(m_partition, offset, length) == ESP_OK;
+}
+
+#endif // CONFIG_A_M_STATE_STORE_PARTITION
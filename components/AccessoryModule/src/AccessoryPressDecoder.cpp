@@ -0,0 +1,231 @@
+#include "AccessoryPressDecoder.hpp"
+
+#include "AccessoryClock.hpp"
+#include <esp_log.h>
+
+static const char * TAG = "AccessoryPressDecoder";
+
+AccessoryPressDecoder::AccessoryPressDecoder(Callback callback, void * callbackParam) :
+    m_callback(callback), m_callbackParam(callbackParam), m_profile(), m_state(State::Idle), m_pressCount(0),
+    m_lastEdgeUs(INT64_MIN / 2), m_deadlineUs(0), m_pending{}, m_pendingHead(0), m_pendingCount(0),
+    m_lock(portMUX_INITIALIZER_UNLOCKED), m_timer(timerCallback, this)
+{
+}
+
+void AccessoryPressDecoder::setProfile(const AccessoryPressProfile & profile)
+{
+    portENTER_CRITICAL(&m_lock);
+    m_profile = profile;
+    portEXIT_CRITICAL(&m_lock);
+}
+
+AccessoryPressProfile AccessoryPressDecoder::getProfile()
+{
+    portENTER_CRITICAL(&m_lock);
+    AccessoryPressProfile profile = m_profile;
+    portEXIT_CRITICAL(&m_lock);
+    return profile;
+}
+
+void AccessoryPressDecoder::edge(bool pressed)
+{
+    int64_t nowUs = AccessoryClock::now();
+    bool dropped  = false;
+
+    portENTER_CRITICAL(&m_lock);
+    if (nowUs - m_lastEdgeUs < int64_t(m_profile.debounceMs) * 1000)
+    {
+        portEXIT_CRITICAL(&m_lock);
+        return;
+    }
+
+    if (pressed && (m_state == State::Idle || m_state == State::Released))
+    {
+        m_lastEdgeUs = nowUs;
+        m_pressCount = m_state == State::Idle ? 1 : (m_pressCount < UINT8_MAX ? m_pressCount + 1 : m_pressCount);
+        if (m_profile.maxPresses <= 1 && m_profile.longPressMs == 0)
+        {
+            // Nothing can follow: report on the down edge.
+            dropped      = !push(StatelessButtonAccessoryInterface::SinglePress, 1);
+            m_state      = State::Reported;
+            m_deadlineUs = 0;
+        }
+        else
+        {
+            m_state      = State::Pressed;
+            m_deadlineUs = deadline(m_profile.longPressMs, nowUs);
+        }
+    }
+    else if (!pressed && m_state == State::Pressed)
+    {
+        m_lastEdgeUs = nowUs;
+        if (m_pressCount >= m_profile.maxPresses)
+        {
+            dropped      = !push(sequenceType(m_pressCount), m_pressCount);
+            m_state      = State::Idle;
+            m_deadlineUs = 0;
+        }
+        else
+        {
+            m_state      = State::Released;
+            m_deadlineUs = deadline(m_profile.multiPressGapMs, nowUs);
+        }
+    }
+    else if (!pressed && m_state == State::Holding)
+    {
+        m_lastEdgeUs = nowUs;
+        dropped      = !push(StatelessButtonAccessoryInterface::LongPressRelease, m_pressCount);
+        m_state      = State::Idle;
+        m_deadlineUs = 0;
+    }
+    else if (!pressed && m_state == State::Reported)
+    {
+        m_lastEdgeUs = nowUs;
+        m_state      = State::Idle;
+    }
+    portEXIT_CRITICAL(&m_lock);
+
+    if (dropped)
+    {
+        ESP_LOGW(TAG, "Press dropped, %d presses waiting for the timer service", PENDING_SIZE);
+    }
+    rearm();
+}
+
+void AccessoryPressDecoder::reset()
+{
+    portENTER_CRITICAL(&m_lock);
+    m_state        = State::Idle;
+    m_pressCount   = 0;
+    m_deadlineUs   = 0;
+    m_pendingCount = 0;
+    portEXIT_CRITICAL(&m_lock);
+    m_timer.cancel();
+}
+
+void AccessoryPressDecoder::setOwner(AccessoryType ownerType)
+{
+    m_timer.setOwner(ownerType);
+}
+
+void AccessoryPressDecoder::timerCallback(void * instance)
+{
+    AccessoryPressDecoder * decoder = static_cast<AccessoryPressDecoder *>(instance);
+
+    // Presses queued by edge() and by expiries are emitted here only, in the order they were decoded.
+    for (;;)
+    {
+        portENTER_CRITICAL(&decoder->m_lock);
+        decoder->expire(AccessoryClock::now());
+        if (decoder->m_pendingCount == 0)
+        {
+            portEXIT_CRITICAL(&decoder->m_lock);
+            break;
+        }
+        Pending press            = decoder->m_pending[decoder->m_pendingHead];
+        decoder->m_pendingHead   = (decoder->m_pendingHead + 1) % PENDING_SIZE;
+        decoder->m_pendingCount -= 1;
+        portEXIT_CRITICAL(&decoder->m_lock);
+
+        if (decoder->m_callback)
+        {
+            decoder->m_callback(decoder->m_callbackParam, press.pressType, press.pressCount);
+        }
+    }
+    decoder->rearm();
+}
+
+void AccessoryPressDecoder::expire(int64_t nowUs)
+{
+    int64_t deadlineUs = m_deadlineUs;
+    if (deadlineUs == 0 || nowUs < deadlineUs)
+    {
+        return;
+    }
+
+    switch (m_state)
+    {
+    case State::Pressed:
+        push(StatelessButtonAccessoryInterface::LongPress, m_pressCount);
+        m_state      = State::Holding;
+        m_deadlineUs = deadline(m_profile.repeatMs, deadlineUs);
+        break;
+    case State::Holding:
+        push(StatelessButtonAccessoryInterface::LongPressRepeat, m_pressCount);
+        m_deadlineUs = deadline(m_profile.repeatMs, deadlineUs);
+        break;
+    case State::Released:
+        push(sequenceType(m_pressCount), m_pressCount);
+        m_state      = State::Idle;
+        m_deadlineUs = 0;
+        break;
+    default:
+        m_deadlineUs = 0;
+        break;
+    }
+}
+
+bool AccessoryPressDecoder::push(StatelessButtonAccessoryInterface::PressType pressType, uint8_t pressCount)
+{
+    if (m_pendingCount == PENDING_SIZE)
+    {
+        return false;
+    }
+    m_pending[(m_pendingHead + m_pendingCount) % PENDING_SIZE] = { pressType, pressCount };
+    m_pendingCount += 1;
+    return true;
+}
+
+int64_t AccessoryPressDecoder::wakeTime()
+{
+    // Queued presses are due at once, the edge that queued them is in the past.
+    return m_pendingCount > 0 ? m_lastEdgeUs : m_deadlineUs;
+}
+
+void AccessoryPressDecoder::rearm()
+{
+    // Never cancel here: cancel() waits for a running callback. A disarmed timer that still fires finds nothing due.
+    // Arming happens outside m_lock, so the edge task and the timer task may arm in either order: whoever arms
+    // last checks the wake time again and arms once more if the other changed it in between.
+    int64_t armedUs = 0;
+    for (;;)
+    {
+        portENTER_CRITICAL(&m_lock);
+        int64_t wakeUs = wakeTime();
+        portEXIT_CRITICAL(&m_lock);
+        if (wakeUs == 0 || wakeUs == armedUs)
+        {
+            return;
+        }
+        if (!m_timer.startAt(wakeUs))
+        {
+            ESP_LOGE(TAG, "Timer service full, abandoning the press sequence");
+            portENTER_CRITICAL(&m_lock);
+            m_state        = State::Idle;
+            m_pressCount   = 0;
+            m_deadlineUs   = 0;
+            m_pendingCount = 0;
+            portEXIT_CRITICAL(&m_lock);
+            return;
+        }
+        armedUs = wakeUs;
+    }
+}
+
+int64_t AccessoryPressDecoder::deadline(uint16_t delayMs, int64_t baseUs)
+{
+    return delayMs == 0 ? 0 : baseUs + int64_t(delayMs) * 1000;
+}
+
+StatelessButtonAccessoryInterface::PressType AccessoryPressDecoder::sequenceType(uint8_t pressCount)
+{
+    switch (pressCount)
+    {
+    case 1:
+        return StatelessButtonAccessoryInterface::SinglePress;
+    case 2:
+        return StatelessButtonAccessoryInterface::DoublePress;
+    default:
+        return StatelessButtonAccessoryInterface::MultiPress;
+    }
+}
@@ -0,0 +1,177 @@
+#include "AccessoryRegistry.hpp"
+
+#include <esp_log.h>
+#include <string.h>
+
+static const char * TAG = "AccessoryRegistry";
+
+AccessoryRegistry & AccessoryRegistry::instance()
+{
+    static AccessoryRegistry registry;
+    return registry;
+}
+
+AccessoryRegistry::AccessoryRegistry() : m_arenaUsed(0), m_slots{}, m_created{}, m_count(0), m_typeStart{}
+{
+    for (size_t i = 0; i < INDEX_SIZE; i++)
+    {
+        m_index[i].endpointId = 0;
+        m_index[i].slot       = NO_SLOT;
+    }
+}
+
+AccessoryRegistry::~AccessoryRegistry()
+{
+    for (size_t i = m_count; i > 0; i--)
+    {
+        m_created[i - 1]->~BaseAccessoryInterface();
+    }
+}
+
+BaseAccessoryInterface * AccessoryRegistry::find(uint16_t endpointId) const
+{
+    for (size_t i = bucket(endpointId);; i = (i + 1) & (INDEX_SIZE - 1))
+    {
+        const IndexEntry & entry = m_index[i];
+        if (entry.slot == NO_SLOT)
+        {
+            return nullptr;
+        }
+        if (entry.endpointId == endpointId)
+        {
+            return m_slots[entry.slot];
+        }
+    }
+}
+
+size_t AccessoryRegistry::size() const
+{
+    return m_count;
+}
+
+BaseAccessoryInterface * const * AccessoryRegistry::accessories() const
+{
+    return m_slots;
+}
+
+BaseAccessoryInterface * const * AccessoryRegistry::accessories(AccessoryType type, size_t & count) const
+{
+    uint8_t index = static_cast<uint8_t>(type);
+    count         = m_typeStart[index + 1] - m_typeStart[index];
+    return &m_slots[m_typeStart[index]];
+}
+
+void AccessoryRegistry::identifyAll()
+{
+    ESP_LOGI(TAG, "Identifying %d accessories", static_cast<int>(m_count));
+    for (size_t i = 0; i < m_count; i++)
+    {
+        m_slots[i]->identify();
+    }
+}
+
+size_t AccessoryRegistry::snapshotAll(AccessoryStateRecord * states, size_t maxStates) const
+{
+    size_t written = 0;
+    for (size_t i = 0; i < m_count && written < maxStates; i++)
+    {
+        if (m_slots[i]->getState(states[written]))
+        {
+            written++;
+        }
+    }
+    return written;
+}
+
+size_t AccessoryRegistry::allOff(BaseAccessoryInterface::EventCallback callback, void * callbackParam) const
+{
+    AccessoryStateRecord off = {};
+    size_t switchedOff       = 0;
+    for (uint8_t type = static_cast<uint8_t>(AccessoryType::Light); type <= static_cast<uint8_t>(AccessoryType::Plugin); type++)
+    {
+        off.accessoryType = type;
+        for (size_t i = m_typeStart[type]; i < m_typeStart[type + 1]; i++)
+        {
+            AccessoryEvent event;
+            if (m_slots[i]->applyState(off, event) && event.changedMask)
+            {
+                switchedOff++;
+                if (callback)
+                {
+                    callback(event, callbackParam);
+                }
+            }
+        }
+    }
+    ESP_LOGI(TAG, "Switched off %d accessories", static_cast<int>(switchedOff));
+    return switchedOff;
+}
+
+size_t AccessoryRegistry::getArenaUsed() const
+{
+    return m_arenaUsed;
+}
+
+void * AccessoryRegistry::allocate(uint16_t endpointId, size_t size, size_t alignment)
+{
+    if (find(endpointId))
+    {
+        ESP_LOGE(TAG, "Endpoint %d is already registered", endpointId);
+        return nullptr;
+    }
+    if (m_count >= MAX_ACCESSORIES)
+    {
+        ESP_LOGE(TAG, "No slot left for endpoint %d, at most %d accessories are supported", endpointId,
+                 static_cast<int>(MAX_ACCESSORIES));
+        return nullptr;
+    }
+    size_t offset = (m_arenaUsed + alignment - 1) & ~(alignment - 1);
+    if (offset + size > ARENA_SIZE)
+    {
+        ESP_LOGE(TAG, "No room left in the arena for endpoint %d, %d of %d bytes used", endpointId, static_cast<int>(m_arenaUsed),
+                 static_cast<int>(ARENA_SIZE));
+        return nullptr;
+    }
+    m_arenaUsed = offset + size;
+    return &m_arena[offset];
+}
+
+void AccessoryRegistry::add(uint16_t endpointId, BaseAccessoryInterface * accessory)
+{
+    accessory->setAccessoryId(endpointId);
+    AccessoryStateRecord state;
+    accessory->getState(state);
+    uint8_t type = state.accessoryType < ACCESSORY_TYPE_COUNT ? state.accessoryType : ACCESSORY_TYPE_COUNT - 1;
+
+    // Append to the group of the type: move the slots of the following types up by one.
+    uint16_t slot = m_typeStart[type + 1];
+    memmove(&m_slots[slot + 1], &m_slots[slot], (m_count - slot) * sizeof(m_slots[0]));
+    m_slots[slot]        = accessory;
+    m_created[m_count++] = accessory;
+    for (size_t i = type + 1; i < TYPE_BOUNDS; i++)
+    {
+        m_typeStart[i]++;
+    }
+    for (size_t i = 0; i < INDEX_SIZE; i++)
+    {
+        if (m_index[i].slot != NO_SLOT && m_index[i].slot >= slot)
+        {
+            m_index[i].slot++;
+        }
+    }
+
+    size_t i = bucket(endpointId);
+    while (m_index[i].slot != NO_SLOT)
+    {
+        i = (i + 1) & (INDEX_SIZE - 1);
+    }
+    m_index[i].endpointId = endpointId;
+    m_index[i].slot       = slot;
+    ESP_LOGI(TAG, "Endpoint %d registered, type %d, %d bytes of the arena used", endpointId, type, static_cast<int>(m_arenaUsed));
+}
+
+size_t AccessoryRegistry::bucket(uint16_t endpointId)
+{
+    // Multiplying by an odd constant permutes the low bits: INDEX_SIZE consecutive endpoint ids never collide.
+    return (static_cast<uint32_t>(endpointId) * 2654435769u) & (INDEX_SIZE - 1);
+}
@@ -0,0 +1,158 @@
+#include "AccessoryReporter.hpp"
+#include "AccessoryEventDispatcher.hpp"
+#include "AccessoryStateStore.hpp"
+#include "AccessoryTelemetry.hpp"
+
+#if CONFIG_A_M_LATENCY_STATS
+#include <esp_timer.h>
+
+/**
+ * @brief Gets the low 32 bits of the esp_timer time, never 0 so that 0 can mean "not marked".
+ */
+static uint32_t latencyTimestamp()
+{
+    return static_cast<uint32_t>(esp_timer_get_time()) | 1;
+}
+#endif
+
+AccessoryReporter::AccessoryReporter(AccessoryType accessoryType) :
+    m_accessoryType(accessoryType), m_accessoryId(0), m_reportCallback(nullptr), m_reportCallbackParam(nullptr),
+    m_eventCallback(nullptr), m_eventCallbackParam(nullptr), m_stateStore(nullptr)
+{
+#if CONFIG_A_M_LATENCY_STATS
+    m_inputTime.store(0, std::memory_order_relaxed);
+    m_actuatedTime.store(0, std::memory_order_relaxed);
+#endif
+#if CONFIG_A_M_EVENT_DISPATCHER_ENABLE
+    AccessoryEventDispatcher::instance();
+#endif
+    AccessoryTelemetry::accessoryCreated(accessoryType);
+}
+
+AccessoryReporter::~AccessoryReporter()
+{
+#if CONFIG_A_M_EVENT_DISPATCHER_ENABLE
+    AccessoryEventDispatcher::instance().drain(this);
+#endif
+    AccessoryTelemetry::accessoryDestroyed(m_accessoryType);
+}
+
+void AccessoryReporter::setReportCallback(BaseAccessoryInterface::ReportCallback callback, void * callbackParam)
+{
+    m_reportCallback      = callback;
+    m_reportCallbackParam = callbackParam;
+}
+
+void AccessoryReporter::setEventCallback(BaseAccessoryInterface::EventCallback callback, void * callbackParam)
+{
+    m_eventCallback      = callback;
+    m_eventCallbackParam = callbackParam;
+}
+
+void AccessoryReporter::setAccessoryId(uint16_t accessoryId)
+{
+    m_accessoryId = accessoryId;
+}
+
+uint16_t AccessoryReporter::getAccessoryId() const
+{
+    return m_accessoryId;
+}
+
+void AccessoryReporter::setStateStore(AccessoryStateStore * stateStore)
+{
+    m_stateStore = stateStore;
+}
+
+AccessoryType AccessoryReporter::getAccessoryType() const
+{
+    return m_accessoryType;
+}
+
+AccessoryEvent AccessoryReporter::makeEvent() const
+{
+    AccessoryEvent event = {};
+    event.accessoryId    = m_accessoryId;
+    event.accessoryType  = m_accessoryType;
+    return event;
+}
+
+void AccessoryReporter::report(const AccessoryEvent & event)
+{
+    if (m_stateStore)
+    {
+        m_stateStore->update(event);
+    }
+#if CONFIG_A_M_EVENT_DISPATCHER_ENABLE
+    if (m_eventCallback || m_reportCallback)
+    {
+        AccessoryEventDispatcher::instance().post(this, event);
+    }
+#else
+    deliver(event);
+#endif
+}
+
+void AccessoryReporter::save(const AccessoryEvent & event)
+{
+    if (m_stateStore)
+    {
+        m_stateStore->update(event);
+    }
+}
+
+void AccessoryReporter::deliver(const AccessoryEvent & event)
+{
+    if (m_eventCallback)
+    {
+        m_eventCallback(event, m_eventCallbackParam);
+    }
+    if (m_reportCallback)
+    {
+        m_reportCallback(m_reportCallbackParam, event.onlySave);
+    }
+
+#if CONFIG_A_M_LATENCY_STATS
+    uint32_t actuatedTime = m_actuatedTime.exchange(0, std::memory_order_relaxed);
+    if (actuatedTime != 0 && (m_eventCallback || m_reportCallback))
+    {
+        m_reportLatency.record(latencyTimestamp() - actuatedTime);
+    }
+#endif
+}
+
+#if CONFIG_A_M_LATENCY_STATS
+void AccessoryReporter::markInput()
+{
+    m_inputTime.store(latencyTimestamp(), std::memory_order_relaxed);
+}
+
+void AccessoryReporter::markActuated()
+{
+    uint32_t now       = latencyTimestamp();
+    uint32_t inputTime = m_inputTime.exchange(0, std::memory_order_relaxed);
+    if (inputTime != 0)
+    {
+        m_actuationLatency.record(now - inputTime);
+    }
+    m_actuatedTime.store(now, std::memory_order_relaxed);
+}
+#endif
+
+AccessoryLatencyStats AccessoryReporter::getLatencyStats(AccessoryLatencyPath path) const
+{
+#if CONFIG_A_M_LATENCY_STATS
+    switch (path)
+    {
+    case AccessoryLatencyPath::ACTUATION:
+        return m_actuationLatency.getStats();
+    case AccessoryLatencyPath::REPORT:
+        return m_reportLatency.getStats();
+    default:
+        return AccessoryLatencyStats{};
+    }
+#else
+    (void) path;
+    return AccessoryLatencyStats{};
+#endif
+}
@@ -0,0 +1,110 @@
+#include "AccessoryRetainedState.hpp"
+
+#include <esp_log.h>
+#include <esp_rtc_time.h>
+#include <esp_timer.h>
+#include <stddef.h>
+
+static const char * TAG = "AccessoryRetainedState";
+
+#if CONFIG_A_M_RETAINED_STATE
+
+#include <esp_attr.h>
+#include <freertos/FreeRTOS.h>
+
+static constexpr uint32_t CHECKSUM_SEED = 0x4D415352; ///< Makes an all zero record invalid.
+
+/// Survives warm restarts; holds garbage after power-on, which the checksums reject.
+static RTC_NOINIT_ATTR AccessoryRetainedRecord s_records[AccessoryRetainedState::MAX_RECORDS];
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED; ///< Protects s_records.
+
+/**
+ * @brief Computes the FNV-1a checksum of the fields before the checksum of a record.
+ */
+static uint32_t checksum(const AccessoryRetainedRecord & record)
+{
+    const uint8_t * bytes = reinterpret_cast<const uint8_t *>(&record);
+    uint32_t hash         = 2166136261u ^ CHECKSUM_SEED;
+    for (size_t i = 0; i < offsetof(AccessoryRetainedRecord, checksum); i++)
+    {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+void AccessoryRetainedState::save(const AccessoryRetainedRecord & record)
+{
+    if (record.accessoryId == 0)
+    {
+        return;
+    }
+
+    int slot = -1;
+    portENTER_CRITICAL(&s_lock);
+    for (size_t i = 0; i < MAX_RECORDS; i++)
+    {
+        bool valid = s_records[i].checksum == checksum(s_records[i]);
+        if (valid && s_records[i].accessoryId == record.accessoryId)
+        {
+            slot = static_cast<int>(i);
+            break;
+        }
+        if (!valid && slot < 0)
+        {
+            slot = static_cast<int>(i);
+        }
+    }
+    if (slot >= 0)
+    {
+        s_records[slot]          = record;
+        s_records[slot].checksum = checksum(record);
+    }
+    portEXIT_CRITICAL(&s_lock);
+
+    if (slot < 0)
+    {
+        ESP_LOGE(TAG, "No record left for accessory %d", record.accessoryId);
+    }
+}
+
+bool AccessoryRetainedState::find(uint16_t accessoryId, AccessoryRetainedRecord & record)
+{
+    bool found = false;
+    portENTER_CRITICAL(&s_lock);
+    for (size_t i = 0; i < MAX_RECORDS && !found; i++)
+    {
+        if (s_records[i].accessoryId == accessoryId && s_records[i].checksum == checksum(s_records[i]))
+        {
+            record = s_records[i];
+            found  = true;
+        }
+    }
+    portEXIT_CRITICAL(&s_lock);
+    return found && accessoryId != 0;
+}
+
+#endif
+
+int64_t AccessoryRetainedState::now()
+{
+    return static_cast<int64_t>(esp_rtc_get_time_us());
+}
+
+int64_t AccessoryRetainedState::resetTime()
+{
+    return now() - esp_timer_get_time();
+}
+
+size_t AccessoryRetainedState::resume(BaseAccessoryInterface * const * accessories, size_t count)
+{
+    size_t resumed = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (accessories[i] && accessories[i]->resume())
+        {
+            resumed++;
+        }
+    }
+    ESP_LOGI(TAG, "Resumed %d of %d accessories", static_cast<int>(resumed), static_cast<int>(count));
+    return resumed;
+}
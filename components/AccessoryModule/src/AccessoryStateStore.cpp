@@ -0,0 +1,364 @@
+#include "AccessoryStateStore.hpp"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/task.h>
+#include <string.h>
+
+#include "AccessoryCrc.hpp"
+
+static const char * TAG = "AccessoryStateStore";
+
+static_assert(sizeof(AccessoryStateRecord) == 8, "AccessoryStateRecord must stay 8 bytes");
+
+AccessoryStateStore::AccessoryStateStore(AccessoryStorageInterface * storage, uint32_t debounceMs) :
+    m_storage(storage), m_debounceMs(debounceMs), m_bankSize(storage->getSize() / 2), m_activeBank(0), m_generation(0),
+    m_writeOffset(sizeof(BankHeader)), m_records{}, m_dirty{}, m_recordCount(0), m_stats{}, m_lock(portMUX_INITIALIZER_UNLOCKED),
+    m_flushing(false), m_debounceTimer(debounceCallback, this)
+{
+    ESP_LOGI(TAG, "AccessoryStateStore created with %d byte banks", static_cast<int>(m_bankSize));
+    if (m_bankSize < sizeof(BankHeader) + (MAX_RECORDS + 1) * sizeof(Entry))
+    {
+        ESP_LOGE(TAG, "Storage too small for %d records", static_cast<int>(MAX_RECORDS));
+    }
+}
+
+AccessoryStateStore::~AccessoryStateStore()
+{
+    m_debounceTimer.cancel();
+    flush();
+}
+
+bool AccessoryStateStore::load()
+{
+    BankHeader headers[2];
+    bool valid[2];
+    for (uint8_t bank = 0; bank < 2; bank++)
+    {
+        valid[bank] = m_storage->read(bank * m_bankSize, &headers[bank], sizeof(BankHeader)) &&
+            headers[bank].magic == BANK_MAGIC && headers[bank].generation != 0xFFFFFFFF;
+    }
+    if (!valid[0] && !valid[1])
+    {
+        ESP_LOGI(TAG, "No journal found");
+        return false;
+    }
+
+    m_activeBank  = valid[0] && (!valid[1] || headers[0].generation > headers[1].generation) ? 0 : 1;
+    m_generation  = headers[m_activeBank].generation;
+    m_recordCount = 0;
+    m_writeOffset = replay(m_activeBank);
+    ESP_LOGI(TAG, "Loaded %d records from bank %d, generation %lu", static_cast<int>(m_recordCount), m_activeBank,
+             (unsigned long) m_generation);
+    return true;
+}
+
+bool AccessoryStateStore::getRecord(uint16_t accessoryId, AccessoryStateRecord & record)
+{
+    portENTER_CRITICAL(&m_lock);
+    int slot = findSlot(accessoryId, false);
+    if (slot >= 0)
+    {
+        record = m_records[slot];
+    }
+    portEXIT_CRITICAL(&m_lock);
+    return slot >= 0;
+}
+
+size_t AccessoryStateStore::restore(BaseAccessoryInterface * const * accessories, size_t count)
+{
+    int64_t startUs = esp_timer_get_time();
+    size_t restored = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        AccessoryStateRecord record;
+        if (accessories[i] && getRecord(accessories[i]->getAccessoryId(), record) && accessories[i]->restore(record))
+        {
+            restored++;
+        }
+    }
+    int64_t endUs = esp_timer_get_time();
+
+    portENTER_CRITICAL(&m_lock);
+    m_stats.restoreUs    = static_cast<uint32_t>(endUs - startUs);
+    m_stats.restoredAtUs = endUs;
+    portEXIT_CRITICAL(&m_lock);
+    ESP_LOGI(TAG, "Restored %d of %d accessories in %lu us, %lld us after boot", static_cast<int>(restored),
+             static_cast<int>(count), (unsigned long) (endUs - startUs), (long long) endUs);
+    return restored;
+}
+
+void AccessoryStateStore::update(const AccessoryEvent & event)
+{
+    static constexpr uint16_t PERSISTED = AccessoryEvent::ATTRIBUTE_POWER | AccessoryEvent::ATTRIBUTE_LOCK_STATE |
+        AccessoryEvent::ATTRIBUTE_CURRENT_POSITION | AccessoryEvent::ATTRIBUTE_TARGET_POSITION;
+    if ((event.changedMask & PERSISTED) == 0)
+    {
+        return;
+    }
+
+    portENTER_CRITICAL(&m_lock);
+    int slot = findSlot(event.accessoryId, true);
+    if (slot >= 0)
+    {
+        AccessoryStateRecord & record = m_records[slot];
+        record.accessoryType          = static_cast<uint8_t>(event.accessoryType);
+        if (event.changedMask & AccessoryEvent::ATTRIBUTE_POWER)
+        {
+            record.flags = event.powerOn ? record.flags | AccessoryStateRecord::FLAG_POWER_ON
+                                         : record.flags & ~AccessoryStateRecord::FLAG_POWER_ON;
+        }
+        if (event.changedMask & AccessoryEvent::ATTRIBUTE_LOCK_STATE)
+        {
+            record.flags = event.unlocked ? record.flags | AccessoryStateRecord::FLAG_UNLOCKED
+                                          : record.flags & ~AccessoryStateRecord::FLAG_UNLOCKED;
+        }
+        if (event.changedMask & AccessoryEvent::ATTRIBUTE_CURRENT_POSITION)
+        {
+            record.currentPosition = event.currentPosition;
+        }
+        if (event.changedMask & AccessoryEvent::ATTRIBUTE_TARGET_POSITION)
+        {
+            record.targetPosition = event.targetPosition;
+        }
+        m_dirty[slot] = true;
+        m_stats.updates++;
+    }
+    portEXIT_CRITICAL(&m_lock);
+
+    if (slot < 0)
+    {
+        ESP_LOGE(TAG, "No record left for accessory %d", event.accessoryId);
+        return;
+    }
+    // Re-arming on every change writes once the accessories are quiet.
+    if (!m_debounceTimer.start(m_debounceMs))
+    {
+        ESP_LOGE(TAG, "Cannot arm the flush timer, writing the change at once");
+        flush();
+    }
+}
+
+bool AccessoryStateStore::flush()
+{
+    while (m_flushing.exchange(true, std::memory_order_acquire))
+    {
+        vTaskDelay(1);
+    }
+
+    bool success  = true;
+    bool anyWrite = false;
+    for (size_t slot = 0; slot < MAX_RECORDS; slot++)
+    {
+        portENTER_CRITICAL(&m_lock);
+        bool dirty                  = slot < m_recordCount && m_dirty[slot];
+        AccessoryStateRecord record = m_records[slot];
+        m_dirty[slot]               = false;
+        portEXIT_CRITICAL(&m_lock);
+
+        if (!dirty)
+        {
+            continue;
+        }
+        anyWrite = true;
+        if (!append(record))
+        {
+            portENTER_CRITICAL(&m_lock);
+            m_dirty[slot] = true;
+            m_stats.errors++;
+            portEXIT_CRITICAL(&m_lock);
+            success = false;
+        }
+    }
+
+    if (anyWrite)
+    {
+        portENTER_CRITICAL(&m_lock);
+        m_stats.flushes++;
+        portEXIT_CRITICAL(&m_lock);
+    }
+    m_flushing.store(false, std::memory_order_release);
+    return success;
+}
+
+AccessoryStateStore::Stats AccessoryStateStore::getStats()
+{
+    portENTER_CRITICAL(&m_lock);
+    Stats stats = m_stats;
+    portEXIT_CRITICAL(&m_lock);
+    return stats;
+}
+
+void AccessoryStateStore::debounceCallback(void * instance)
+{
+    AccessoryStateStore * store = static_cast<AccessoryStateStore *>(instance);
+    if (!store->flush())
+    {
+        ESP_LOGW(TAG, "Flush failed, retrying later");
+        if (!store->m_debounceTimer.start(store->m_debounceMs))
+        {
+            ESP_LOGE(TAG, "Cannot arm the flush timer, the changes wait for the next update");
+        }
+    }
+}
+
+uint16_t AccessoryStateStore::entryCrc(const Entry & entry)
+{
+    return AccessoryCrc::update(AccessoryCrc::INITIAL, &entry, offsetof(Entry, crc));
+}
+
+bool AccessoryStateStore::isErased(const Entry & entry)
+{
+    const uint8_t * bytes = reinterpret_cast<const uint8_t *>(&entry);
+    for (size_t i = 0; i < sizeof(Entry); i++)
+    {
+        if (bytes[i] != 0xFF)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+int AccessoryStateStore::findSlot(uint16_t accessoryId, bool create)
+{
+    for (size_t slot = 0; slot < m_recordCount; slot++)
+    {
+        if (m_records[slot].accessoryId == accessoryId)
+        {
+            return static_cast<int>(slot);
+        }
+    }
+    if (!create || m_recordCount == MAX_RECORDS)
+    {
+        return -1;
+    }
+    m_records[m_recordCount]             = AccessoryStateRecord{};
+    m_records[m_recordCount].accessoryId = accessoryId;
+    return static_cast<int>(m_recordCount++);
+}
+
+bool AccessoryStateStore::append(const AccessoryStateRecord & record)
+{
+    if (m_generation == 0 || m_writeOffset + sizeof(Entry) > m_bankSize)
+    {
+        // The compacted bank already holds the latest version of every record, including this one.
+        return compact();
+    }
+
+    Entry entry  = {};
+    entry.marker = ENTRY_MARKER;
+    entry.record = record;
+    entry.crc    = entryCrc(entry);
+    if (!m_storage->write(m_activeBank * m_bankSize + m_writeOffset, &entry, sizeof(entry)))
+    {
+        ESP_LOGE(TAG, "Cannot write entry at %d", static_cast<int>(m_writeOffset));
+        // The location may be partially written, never reuse it.
+        m_writeOffset += sizeof(Entry);
+        return false;
+    }
+    m_writeOffset += sizeof(Entry);
+
+    portENTER_CRITICAL(&m_lock);
+    m_stats.writes++;
+    portEXIT_CRITICAL(&m_lock);
+    return true;
+}
+
+bool AccessoryStateStore::compact()
+{
+    uint8_t bank   = m_activeBank ^ 1;
+    size_t base    = bank * m_bankSize;
+    size_t offset  = sizeof(BankHeader);
+    uint32_t count = 0;
+
+    // A journal that was never loaded or written starts over in bank 0, without stale entries in bank 1.
+    if (m_generation == 0)
+    {
+        bank = 0;
+        base = 0;
+        if (!m_storage->erase(m_bankSize, m_bankSize))
+        {
+            ESP_LOGE(TAG, "Cannot erase bank 1");
+            return false;
+        }
+    }
+    if (!m_storage->erase(base, m_bankSize))
+    {
+        ESP_LOGE(TAG, "Cannot erase bank %d", bank);
+        return false;
+    }
+
+    for (size_t slot = 0; slot < MAX_RECORDS; slot++)
+    {
+        portENTER_CRITICAL(&m_lock);
+        bool used    = slot < m_recordCount;
+        Entry entry  = {};
+        entry.marker = ENTRY_MARKER;
+        entry.record = m_records[slot];
+        // Every record is written here, so pending changes of other slots are saved too.
+        if (used)
+        {
+            m_dirty[slot] = false;
+        }
+        portEXIT_CRITICAL(&m_lock);
+
+        if (!used)
+        {
+            break;
+        }
+        entry.crc = entryCrc(entry);
+        if (offset + sizeof(Entry) > m_bankSize || !m_storage->write(base + offset, &entry, sizeof(entry)))
+        {
+            ESP_LOGE(TAG, "Cannot write compacted entry %d", static_cast<int>(slot));
+            return false;
+        }
+        offset += sizeof(Entry);
+        count++;
+    }
+
+    BankHeader header = { BANK_MAGIC, m_generation + 1 };
+    if (!m_storage->write(base, &header, sizeof(header)))
+    {
+        ESP_LOGE(TAG, "Cannot write header of bank %d", bank);
+        return false;
+    }
+    m_activeBank  = bank;
+    m_generation  = header.generation;
+    m_writeOffset = offset;
+
+    portENTER_CRITICAL(&m_lock);
+    m_stats.writes += count;
+    m_stats.compactions++;
+    portEXIT_CRITICAL(&m_lock);
+    ESP_LOGI(TAG, "Compacted %lu records into bank %d, generation %lu", (unsigned long) count, bank, (unsigned long) m_generation);
+    return true;
+}
+
+size_t AccessoryStateStore::replay(uint8_t bank)
+{
+    size_t offset = sizeof(BankHeader);
+    while (offset + sizeof(Entry) <= m_bankSize)
+    {
+        Entry entry;
+        if (!m_storage->read(bank * m_bankSize + offset, &entry, sizeof(entry)) || isErased(entry))
+        {
+            break;
+        }
+        offset += sizeof(Entry);
+        // A torn write leaves a bad marker or CRC; skip the entry and never write over it.
+        if (entry.marker != ENTRY_MARKER || entry.crc != entryCrc(entry))
+        {
+            ESP_LOGW(TAG, "Skipping corrupt entry at %d", static_cast<int>(offset - sizeof(Entry)));
+            continue;
+        }
+        portENTER_CRITICAL(&m_lock);
+        int slot = findSlot(entry.record.accessoryId, true);
+        if (slot >= 0)
+        {
+            m_records[slot] = entry.record;
+        }
+        portEXIT_CRITICAL(&m_lock);
+    }
+    return offset;
+}
@@ -0,0 +1,221 @@
+#include "AccessoryTelemetry.hpp"
+
+#include <esp_log.h>
+#include <string.h>
+
+static const char * TAG = "AccessoryTelemetry";
+
+static const char * const TYPE_NAMES[ACCESSORY_TYPE_COUNT] = { "Light",    "Fan",   "Switch",         "Plugin",
+                                                               "DoorLock", "Blind", "StatelessButton" };
+
+#if CONFIG_A_M_TASK_TELEMETRY
+
+#include <esp_timer.h>
+
+static constexpr uint8_t STACK_FILL_BYTE    = 0xa5; ///< Value FreeRTOS paints unused stack with.
+static constexpr uint32_t STACK_PAINT_GUARD = 256;  ///< Bytes below the stack pointer left untouched when painting.
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED; ///< Protects every variable below.
+static AccessoryTelemetrySnapshot s_snapshot;              ///< Counters, task high water marks are filled in on read.
+static TaskHandle_t s_handles[ACCESSORY_TASK_COUNT];       ///< Handles of the registered tasks.
+static uint8_t * s_stackStarts[ACCESSORY_TASK_COUNT];      ///< Lowest stack address of each task, nullptr if unknown.
+static uint32_t s_stackPeaks[ACCESSORY_TASK_COUNT];        ///< Deepest stack use of each task across repaints.
+
+/**
+ * @brief Gets the deepest stack use of a task since its stack was last painted.
+ *
+ * @return Bytes used from the top of the stack, 0 if the stack cannot be inspected.
+ */
+static uint32_t scanStackDepth(uint8_t task)
+{
+    uint8_t * start = s_stackStarts[task];
+    if (!start)
+    {
+        return 0;
+    }
+    uint32_t unused = 0;
+    while (unused < s_snapshot.tasks[task].stackSize && start[unused] == STACK_FILL_BYTE)
+    {
+        unused++;
+    }
+    return s_snapshot.tasks[task].stackSize - unused;
+}
+
+void AccessoryTelemetry::taskCreated(AccessoryTask task, const char * name, TaskHandle_t handle, uint32_t stackSize)
+{
+    uint8_t index = static_cast<uint8_t>(task);
+    portENTER_CRITICAL(&s_lock);
+    s_handles[index]                  = handle;
+    s_stackStarts[index]              = pxTaskGetStackStart(handle);
+    s_snapshot.tasks[index].name      = name;
+    s_snapshot.tasks[index].stackSize = stackSize;
+    s_snapshot.tasksCreated++;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void AccessoryTelemetry::accessoryCreated(AccessoryType type)
+{
+    portENTER_CRITICAL(&s_lock);
+    s_snapshot.types[static_cast<uint8_t>(type)].created++;
+    s_snapshot.types[static_cast<uint8_t>(type)].live++;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+void AccessoryTelemetry::accessoryDestroyed(AccessoryType type)
+{
+    portENTER_CRITICAL(&s_lock);
+    s_snapshot.types[static_cast<uint8_t>(type)].live--;
+    portEXIT_CRITICAL(&s_lock);
+}
+
+int64_t AccessoryTelemetry::beginCallback(AccessoryTask task)
+{
+    uint8_t index   = static_cast<uint8_t>(task);
+    uint8_t * start = s_stackStarts[index];
+    if (start)
+    {
+        // Keep the use of the task loop since the previous callback, then repaint so the callback is measured alone.
+        uint32_t depth = scanStackDepth(index);
+        portENTER_CRITICAL(&s_lock);
+        if (depth > s_stackPeaks[index])
+        {
+            s_stackPeaks[index] = depth;
+        }
+        portEXIT_CRITICAL(&s_lock);
+        uint8_t marker;
+        uintptr_t limit = reinterpret_cast<uintptr_t>(&marker) - STACK_PAINT_GUARD;
+        if (limit > reinterpret_cast<uintptr_t>(start))
+        {
+            memset(start, STACK_FILL_BYTE, limit - reinterpret_cast<uintptr_t>(start));
+        }
+    }
+    return esp_timer_get_time();
+}
+
+void AccessoryTelemetry::endCallback(AccessoryTask task, uint8_t ownerType, int64_t startUs)
+{
+    uint32_t durationUs = static_cast<uint32_t>(esp_timer_get_time() - startUs);
+    uint8_t index       = static_cast<uint8_t>(task);
+    uint32_t depth      = scanStackDepth(index);
+
+    portENTER_CRITICAL(&s_lock);
+    if (depth > s_stackPeaks[index])
+    {
+        s_stackPeaks[index] = depth;
+    }
+    s_snapshot.tasks[index].callbackCount++;
+    s_snapshot.tasks[index].callbackTimeUs += durationUs;
+    if (ownerType < ACCESSORY_TYPE_COUNT)
+    {
+        AccessoryTypeTelemetry & type = s_snapshot.types[ownerType];
+        type.callbackCount++;
+        type.callbackTimeUs += durationUs;
+        if (durationUs > type.callbackMaxUs)
+        {
+            type.callbackMaxUs = durationUs;
+        }
+        if (depth > type.stackPeak)
+        {
+            type.stackPeak = depth;
+        }
+    }
+    portEXIT_CRITICAL(&s_lock);
+}
+
+AccessoryTelemetrySnapshot AccessoryTelemetry::getSnapshot()
+{
+    uint32_t stackPeaks[ACCESSORY_TASK_COUNT];
+    portENTER_CRITICAL(&s_lock);
+    AccessoryTelemetrySnapshot snapshot = s_snapshot;
+    memcpy(stackPeaks, s_stackPeaks, sizeof(stackPeaks));
+    portEXIT_CRITICAL(&s_lock);
+
+    for (uint8_t i = 0; i < ACCESSORY_TASK_COUNT; i++)
+    {
+        AccessoryTaskTelemetry & task = snapshot.tasks[i];
+        if (!task.name)
+        {
+            continue;
+        }
+        // Repainting resets the FreeRTOS high water mark, so combine it with the peaks kept across repaints.
+        uint32_t highWaterMark  = uxTaskGetStackHighWaterMark(s_handles[i]);
+        uint32_t peak           = stackPeaks[i];
+        task.stackHighWaterMark = peak > 0 && task.stackSize - peak < highWaterMark ? task.stackSize - peak : highWaterMark;
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY && CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+        TaskStatus_t status;
+        vTaskGetInfo(s_handles[i], &status, pdFALSE, eInvalid);
+        task.runTime = status.ulRunTimeCounter;
+#endif
+    }
+    return snapshot;
+}
+
+/**
+ * @brief Adds the configured margin to a stack peak and rounds it up to 64 bytes.
+ */
+static uint32_t withMargin(uint32_t peak)
+{
+    return (peak + CONFIG_A_M_TASK_TELEMETRY_STACK_MARGIN + 63) & ~uint32_t(63);
+}
+
+uint32_t AccessoryTelemetry::recommendedStackSize(AccessoryType type)
+{
+    AccessoryTypeTelemetry telemetry = getSnapshot().types[static_cast<uint8_t>(type)];
+    return telemetry.callbackCount > 0 ? withMargin(telemetry.stackPeak) : 0;
+}
+
+uint32_t AccessoryTelemetry::recommendedStackSize(AccessoryTask task)
+{
+    AccessoryTaskTelemetry telemetry = getSnapshot().tasks[static_cast<uint8_t>(task)];
+    return telemetry.name ? withMargin(telemetry.stackSize - telemetry.stackHighWaterMark) : 0;
+}
+
+#else
+
+AccessoryTelemetrySnapshot AccessoryTelemetry::getSnapshot()
+{
+    return AccessoryTelemetrySnapshot{};
+}
+
+uint32_t AccessoryTelemetry::recommendedStackSize(AccessoryType type)
+{
+    (void) type;
+    return 0;
+}
+
+uint32_t AccessoryTelemetry::recommendedStackSize(AccessoryTask task)
+{
+    (void) task;
+    return 0;
+}
+
+#endif
+
+void AccessoryTelemetry::log()
+{
+    AccessoryTelemetrySnapshot snapshot = getSnapshot();
+
+    ESP_LOGI(TAG, "tasks created %u", snapshot.tasksCreated);
+    for (uint8_t i = 0; i < ACCESSORY_TASK_COUNT; i++)
+    {
+        const AccessoryTaskTelemetry & task = snapshot.tasks[i];
+        if (task.name)
+        {
+            ESP_LOGI(TAG, "task %s: stack %lu, free min %lu, recommended %lu, run time %lu, callbacks %lu, %llu us", task.name,
+                     (unsigned long) task.stackSize, (unsigned long) task.stackHighWaterMark,
+                     (unsigned long) recommendedStackSize(static_cast<AccessoryTask>(i)), (unsigned long) task.runTime,
+                     (unsigned long) task.callbackCount, (unsigned long long) task.callbackTimeUs);
+        }
+    }
+    for (uint8_t i = 0; i < ACCESSORY_TYPE_COUNT; i++)
+    {
+        const AccessoryTypeTelemetry & type = snapshot.types[i];
+        if (type.created)
+        {
+            ESP_LOGI(TAG, "%s: live %u of %u, callbacks %lu, %llu us, max %lu us, stack peak %lu, recommended %lu", TYPE_NAMES[i],
+                     type.live, type.created, (unsigned long) type.callbackCount, (unsigned long long) type.callbackTimeUs,
+                     (unsigned long) type.callbackMaxUs, (unsigned long) type.stackPeak,
+                     (unsigned long) recommendedStackSize(static_cast<AccessoryType>(i)));
+        }
+    }
+}
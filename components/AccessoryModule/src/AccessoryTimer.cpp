@@ -0,0 +1,47 @@
+#include "AccessoryTimer.hpp"
+#include "AccessoryTimerService.hpp"
+
+#include "AccessoryClock.hpp"
+
+AccessoryTimer::AccessoryTimer(Callback callback, void * callbackParam) :
+    m_callback(callback), m_callbackParam(callbackParam), m_deadline(0), m_extended(0), m_heapIndex(-1),
+    m_ownerType(ACCESSORY_TYPE_COUNT)
+{
+    // Start the service while the owner is being constructed, so arming a timer later never creates the task.
+    AccessoryTimerService::instance();
+}
+
+AccessoryTimer::~AccessoryTimer()
+{
+    cancel();
+}
+
+bool AccessoryTimer::start(uint32_t delayMs)
+{
+    return startAt(AccessoryClock::now() + int64_t(delayMs) * 1000);
+}
+
+bool AccessoryTimer::startAt(int64_t deadline)
+{
+    return AccessoryTimerService::instance().schedule(this, deadline);
+}
+
+bool AccessoryTimer::extend(uint32_t delayMs)
+{
+    return AccessoryTimerService::instance().extend(this, AccessoryClock::now() + int64_t(delayMs) * 1000);
+}
+
+void AccessoryTimer::cancel()
+{
+    AccessoryTimerService::instance().cancel(this);
+}
+
+bool AccessoryTimer::isActive() const
+{
+    return AccessoryTimerService::instance().isArmed(this);
+}
+
+void AccessoryTimer::setOwner(AccessoryType ownerType)
+{
+    m_ownerType = static_cast<uint8_t>(ownerType);
+}
@@ -0,0 +1,298 @@
+#include "AccessoryTimerService.hpp"
+
+#include <esp_log.h>
+
+#include "AccessoryClock.hpp"
+#include "AccessoryTelemetry.hpp"
+
+static const char * TAG = "AccessoryTimerService";
+
+#if CONFIG_A_M_TIMER_SERVICE_CORE_ID < 0
+#define A_M_TIMER_SERVICE_CORE tskNO_AFFINITY
+#else
+#define A_M_TIMER_SERVICE_CORE CONFIG_A_M_TIMER_SERVICE_CORE_ID
+#endif
+
+AccessoryTimerService & AccessoryTimerService::instance()
+{
+    static AccessoryTimerService service;
+    return service;
+}
+
+AccessoryTimerService::AccessoryTimerService() :
+    m_count(0), m_running(nullptr), m_lock(portMUX_INITIALIZER_UNLOCKED), m_taskHandle(nullptr)
+{
+#if CONFIG_A_M_VIRTUAL_TIME
+    ESP_LOGI(TAG, "Starting timer service on virtual time");
+#else
+    ESP_LOGI(TAG, "Starting timer service");
+#if CONFIG_A_M_TIMER_SERVICE_STATIC_ALLOCATION
+    static StackType_t stack[CONFIG_A_M_TIMER_SERVICE_STACK_SIZE];
+    static StaticTask_t taskBuffer;
+    m_taskHandle = xTaskCreateStaticPinnedToCore(serviceTask, "accessoryTimer", CONFIG_A_M_TIMER_SERVICE_STACK_SIZE, this,
+                                                 CONFIG_A_M_TIMER_SERVICE_PRIORITY, stack, &taskBuffer, A_M_TIMER_SERVICE_CORE);
+#else
+    xTaskCreatePinnedToCore(serviceTask, "accessoryTimer", CONFIG_A_M_TIMER_SERVICE_STACK_SIZE, this,
+                            CONFIG_A_M_TIMER_SERVICE_PRIORITY, &m_taskHandle, A_M_TIMER_SERVICE_CORE);
+#endif
+    AccessoryTelemetry::taskCreated(AccessoryTask::TIMER_SERVICE, "accessoryTimer", m_taskHandle,
+                                    CONFIG_A_M_TIMER_SERVICE_STACK_SIZE);
+#endif
+}
+
+bool AccessoryTimerService::schedule(AccessoryTimer * timer, int64_t deadline)
+{
+    bool newEarliest;
+
+    portENTER_CRITICAL(&m_lock);
+    if (timer->m_heapIndex >= 0)
+    {
+        removeAt(timer->m_heapIndex);
+    }
+    if (m_count == CONFIG_A_M_TIMER_SERVICE_MAX_TIMERS)
+    {
+        portEXIT_CRITICAL(&m_lock);
+        ESP_LOGE(TAG, "Timer heap full, cannot schedule timer");
+        return false;
+    }
+    timer->m_deadline = deadline;
+    timer->m_extended = deadline;
+    place(timer, m_count++);
+    siftUp(timer->m_heapIndex);
+    newEarliest = m_heap[0] == timer;
+    portEXIT_CRITICAL(&m_lock);
+
+    if (newEarliest && m_taskHandle && xTaskGetCurrentTaskHandle() != m_taskHandle)
+    {
+        xTaskNotifyGive(m_taskHandle);
+    }
+    return true;
+}
+
+bool AccessoryTimerService::extend(AccessoryTimer * timer, int64_t deadline)
+{
+    portENTER_CRITICAL(&m_lock);
+    bool armed = timer->m_heapIndex >= 0 && deadline >= timer->m_deadline;
+    if (armed)
+    {
+        timer->m_extended = deadline;
+    }
+    portEXIT_CRITICAL(&m_lock);
+
+    return armed || schedule(timer, deadline);
+}
+
+void AccessoryTimerService::cancel(AccessoryTimer * timer)
+{
+#if CONFIG_A_M_VIRTUAL_TIME
+    // Callbacks run in the thread advancing the clock, so a running callback is the caller itself.
+    bool inService = true;
+#else
+    bool inService = xTaskGetCurrentTaskHandle() == m_taskHandle;
+#endif
+
+    // A running callback may re-arm its own timer, so keep disarming until the callback has returned.
+    for (;;)
+    {
+        portENTER_CRITICAL(&m_lock);
+        if (timer->m_heapIndex >= 0)
+        {
+            removeAt(timer->m_heapIndex);
+        }
+        bool running = m_running == timer;
+        portEXIT_CRITICAL(&m_lock);
+
+        if (!running || inService)
+        {
+            return;
+        }
+        vTaskDelay(1);
+    }
+}
+
+bool AccessoryTimerService::isArmed(const AccessoryTimer * timer)
+{
+    portENTER_CRITICAL(&m_lock);
+    bool armed = timer->m_heapIndex >= 0;
+    portEXIT_CRITICAL(&m_lock);
+    return armed;
+}
+
+size_t AccessoryTimerService::getActiveCount()
+{
+    portENTER_CRITICAL(&m_lock);
+    size_t count = m_count;
+    portEXIT_CRITICAL(&m_lock);
+    return count;
+}
+
+#if CONFIG_A_M_VIRTUAL_TIME
+void AccessoryTimerService::advanceTo(int64_t time)
+{
+    portENTER_CRITICAL(&m_lock);
+    while (m_count > 0 && m_heap[0]->m_deadline <= time)
+    {
+        AccessoryTimer * timer = m_heap[0];
+        if (deferExtended(timer))
+        {
+            continue;
+        }
+        removeAt(0);
+        m_running = timer;
+        if (timer->m_deadline > AccessoryClock::now())
+        {
+            AccessoryClock::set(timer->m_deadline);
+        }
+        portEXIT_CRITICAL(&m_lock);
+
+        runCallback(timer);
+
+        portENTER_CRITICAL(&m_lock);
+        m_running = nullptr;
+    }
+    portEXIT_CRITICAL(&m_lock);
+
+    if (time > AccessoryClock::now())
+    {
+        AccessoryClock::set(time);
+    }
+}
+
+bool AccessoryTimerService::getNextDeadline(int64_t & deadline)
+{
+    portENTER_CRITICAL(&m_lock);
+    bool armed = m_count > 0;
+    if (armed)
+    {
+        deadline = m_heap[0]->m_deadline;
+    }
+    portEXIT_CRITICAL(&m_lock);
+    return armed;
+}
+#endif
+
+void AccessoryTimerService::serviceTask(void * instance)
+{
+    AccessoryTimerService * service = static_cast<AccessoryTimerService *>(instance);
+    ESP_LOGI(TAG, "Timer service task started");
+
+    for (;;)
+    {
+        TickType_t timeout = portMAX_DELAY;
+
+        portENTER_CRITICAL(&service->m_lock);
+        int64_t now = AccessoryClock::now();
+        while (service->m_count > 0 && service->m_heap[0]->m_deadline <= now)
+        {
+            AccessoryTimer * timer = service->m_heap[0];
+            if (service->deferExtended(timer))
+            {
+                continue;
+            }
+            service->removeAt(0);
+            service->m_running = timer;
+            portEXIT_CRITICAL(&service->m_lock);
+
+            runCallback(timer);
+
+            portENTER_CRITICAL(&service->m_lock);
+            service->m_running = nullptr;
+            now                = AccessoryClock::now();
+        }
+        if (service->m_count > 0)
+        {
+            int64_t remainingUs = service->m_heap[0]->m_deadline - now;
+            int64_t ticks       = (remainingUs + 1000 * portTICK_PERIOD_MS - 1) / (1000 * portTICK_PERIOD_MS);
+            timeout             = ticks < portMAX_DELAY ? static_cast<TickType_t>(ticks) : portMAX_DELAY - 1;
+        }
+        portEXIT_CRITICAL(&service->m_lock);
+
+        ulTaskNotifyTake(pdTRUE, timeout);
+    }
+}
+
+void AccessoryTimerService::runCallback(AccessoryTimer * timer)
+{
+    int64_t start = AccessoryTelemetry::beginCallback(AccessoryTask::TIMER_SERVICE);
+    timer->m_callback(timer->m_callbackParam);
+    AccessoryTelemetry::endCallback(AccessoryTask::TIMER_SERVICE, timer->m_ownerType, start);
+}
+
+bool AccessoryTimerService::deferExtended(AccessoryTimer * timer)
+{
+    if (timer->m_extended <= timer->m_deadline)
+    {
+        return false;
+    }
+    timer->m_deadline = timer->m_extended;
+    siftDown(timer->m_heapIndex);
+    return true;
+}
+
+void AccessoryTimerService::siftUp(size_t index)
+{
+    AccessoryTimer * timer = m_heap[index];
+    while (index > 0)
+    {
+        size_t parent = (index - 1) / 2;
+        if (m_heap[parent]->m_deadline <= timer->m_deadline)
+        {
+            break;
+        }
+        place(m_heap[parent], index);
+        index = parent;
+    }
+    place(timer, index);
+}
+
+void AccessoryTimerService::siftDown(size_t index)
+{
+    AccessoryTimer * timer = m_heap[index];
+    for (;;)
+    {
+        size_t child = 2 * index + 1;
+        if (child >= m_count)
+        {
+            break;
+        }
+        if (child + 1 < m_count && m_heap[child + 1]->m_deadline < m_heap[child]->m_deadline)
+        {
+            child++;
+        }
+        if (timer->m_deadline <= m_heap[child]->m_deadline)
+        {
+            break;
+        }
+        place(m_heap[child], index);
+        index = child;
+    }
+    place(timer, index);
+}
+
+void AccessoryTimerService::removeAt(size_t index)
+{
+    AccessoryTimer * removed = m_heap[index];
+    removed->m_heapIndex     = -1;
+
+    m_count--;
+    if (index == m_count)
+    {
+        return;
+    }
+
+    place(m_heap[m_count], index);
+    if (index > 0 && m_heap[index]->m_deadline < m_heap[(index - 1) / 2]->m_deadline)
+    {
+        siftUp(index);
+    }
+    else
+    {
+        siftDown(index);
+    }
+}
+
+void AccessoryTimerService::place(AccessoryTimer * timer, size_t index)
+{
+    m_heap[index]      = timer;
+    timer->m_heapIndex = static_cast<int16_t>(index);
+}
@@ -0,0 +1,81 @@
+#include "AccessoryTrace.hpp"
+
+#if CONFIG_A_M_TRACE_BACKEND_BINARY
+
+#include <atomic>
+
+#include "AccessoryClock.hpp"
+#include "AccessorySeqlock.hpp"
+
+static const char * TAG = "AccessoryTrace";
+
+static constexpr uint32_t TRACE_CAPACITY = CONFIG_A_M_TRACE_BUFFER_RECORDS;
+static_assert((TRACE_CAPACITY & (TRACE_CAPACITY - 1)) == 0, "CONFIG_A_M_TRACE_BUFFER_RECORDS must be a power of two");
+
+// Every slot is published like the accessory state, so readers never copy a record that is half written and writers
+// that lap the whole buffer onto the same slot are serialized.
+static AccessorySeqlock<AccessoryTraceRecord> s_records[TRACE_CAPACITY];
+static std::atomic<uint32_t> s_recordCount(0);
+
+void AccessoryTrace::record(AccessoryType accessoryType, uint16_t accessoryId, AccessoryTraceCode code, uint32_t arg0,
+                            uint32_t arg1)
+{
+    uint32_t index              = s_recordCount.fetch_add(1, std::memory_order_relaxed) & (TRACE_CAPACITY - 1);
+    AccessoryTraceRecord record = {};
+    record.timestamp            = static_cast<uint32_t>(AccessoryClock::now());
+    record.accessoryId          = accessoryId;
+    record.accessoryType        = static_cast<uint8_t>(accessoryType);
+    record.code                 = static_cast<uint8_t>(code);
+    record.arg0                 = arg0;
+    record.arg1                 = arg1;
+    s_records[index].write(record);
+}
+
+size_t AccessoryTrace::read(AccessoryTraceRecord * records, size_t maxRecords)
+{
+    uint32_t count     = s_recordCount.load(std::memory_order_relaxed);
+    uint32_t available = count < TRACE_CAPACITY ? count : TRACE_CAPACITY;
+    if (available > maxRecords)
+    {
+        available = maxRecords;
+    }
+
+    // Records are copied whole; one appended meanwhile may replace the oldest ones, or still be the previous lap.
+    for (uint32_t i = 0; i < available; i++)
+    {
+        records[i] = s_records[(count - available + i) & (TRACE_CAPACITY - 1)].read();
+    }
+    return available;
+}
+
+void AccessoryTrace::dump()
+{
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+
+    uint32_t count = s_recordCount.load(std::memory_order_relaxed);
+    ESP_LOGI(TAG, "AMTRACE-BEGIN %lu", static_cast<unsigned long>(count));
+
+    uint32_t available = count < TRACE_CAPACITY ? count : TRACE_CAPACITY;
+    for (uint32_t i = 0; i < available; i++)
+    {
+        AccessoryTraceRecord record = s_records[(count - available + i) & (TRACE_CAPACITY - 1)].read();
+        const uint8_t * bytes       = reinterpret_cast<const uint8_t *>(&record);
+        char hex[2 * sizeof(record) + 1];
+        for (size_t j = 0; j < sizeof(record); j++)
+        {
+            hex[2 * j]     = HEX_DIGITS[bytes[j] >> 4];
+            hex[2 * j + 1] = HEX_DIGITS[bytes[j] & 0x0F];
+        }
+        hex[2 * sizeof(record)] = '\0';
+        ESP_LOGI(TAG, "AMTRACE:%s", hex);
+    }
+
+    ESP_LOGI(TAG, "AMTRACE-END");
+}
+
+uint32_t AccessoryTrace::getRecordCount()
+{
+    return s_recordCount.load(std::memory_order_relaxed);
+}
+
+#endif // CONFIG_A_M_TRACE_BACKEND_BINARY
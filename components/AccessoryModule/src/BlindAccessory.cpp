@@ -1,15 +1,25 @@
 #include "BlindAccessory.hpp"
+#include "AccessoryClock.hpp"
+#include "AccessoryRetainedState.hpp"
+#include "AccessoryStateStore.hpp"
+#include "AccessoryTrace.hpp"
 #include "esp_log.h"
+#include <sdkconfig.h>
 
 static const char * TAG = "BlindAccessory";
 
 BlindAccessory::BlindAccessory(RelayModuleInterface * motorUp, RelayModuleInterface * motorDown, ButtonModuleInterface * buttonUp,
                                ButtonModuleInterface * buttonDown, uint8_t timeToOpen, uint8_t timeToClose) :
-    m_motorUp(motorUp), m_motorDown(motorDown), m_buttonUp(buttonUp), m_buttonDown(buttonDown), m_timeToOpen(timeToOpen),
-    m_timeToClose(timeToClose), m_blindPosition(0), m_targetPosition(0), m_moveBlindTaskHandle(nullptr), m_reportCallback(nullptr),
-    m_reportCallbackParam(nullptr), m_identifyHandler(nullptr)
+    m_motorUp(motorUp), m_motorDown(motorDown), m_buttonUp(buttonUp), m_buttonDown(buttonDown), m_timeToOpenMs(timeToOpen * 1000),
+    m_timeToCloseMs(timeToClose * 1000), m_targetPosition(0), m_motion{}, m_publishedMotion(m_motion), m_motionArrivalTime(0),
+    m_reportStepPercent(CONFIG_A_M_BLIND_ACCESSORY_REPORT_STEP_PERCENT),
+    m_reportIntervalMs(CONFIG_A_M_BLIND_ACCESSORY_REPORT_INTERVAL_MS), m_lastReportPosition(0), m_lastReportTime(0),
+    m_pendingCommands(0), m_restorePosition(0), m_reporter(AccessoryType::Blind), m_identifyEngine(motorUp, motorDown),
+    m_identifyPattern(IdentifyPatterns::BLIND_JOG), m_motionTimer(motionCallback, this)
 {
     ESP_LOGI(TAG, "Creating BlindAccessory with timeToOpen: %d, timeToClose: %d", timeToOpen, timeToClose);
+    m_identifyEngine.setOwner(AccessoryType::Blind);
+    m_motionTimer.setOwner(AccessoryType::Blind);
 
     if (m_buttonUp)
     {
@@ -25,19 +35,20 @@ BlindAccessory::~BlindAccessory()
 {
     ESP_LOGI(TAG, "Destroying BlindAccessory");
 
-    if (m_moveBlindTaskHandle)
-    {
-        ESP_LOGI(TAG, "Deleting existing moveBlindTask");
-        vTaskDelete(m_moveBlindTaskHandle);
-        m_moveBlindTaskHandle = nullptr;
-    }
+    m_identifyEngine.cancel();
+    m_motionTimer.cancel();
+    stopMove();
+    // A restarted accessory with the same id must not resume a motion stopped on purpose.
+    m_motion.startPosition = positionAt(m_motion, AccessoryClock::now());
+    m_motion.direction     = 0;
+    retain();
 }
 
 void BlindAccessory::moveBlindTo(uint8_t newPosition)
 {
-    ESP_LOGI(TAG, "moveBlindTo called with newPosition: %d", newPosition);
+    A_M_TRACE(TAG, m_reporter, BLIND_MOVE, newPosition, 0, "moveBlindTo called with newPosition: %d", newPosition);
 
-    if (m_identifyHandler)
+    if (m_identifyEngine.isRunning())
     {
         ESP_LOGW(TAG, "setPower called, but identify in progress");
         return;
@@ -49,79 +60,190 @@ void BlindAccessory::moveBlindTo(uint8_t newPosition)
         newPosition = 100;
     }
 
-    if (m_moveBlindTaskHandle)
-    {
-        ESP_LOGI(TAG, "Deleting existing moveBlindTask");
-        vTaskDelete(m_moveBlindTaskHandle);
-        m_moveBlindTaskHandle = nullptr;
-    }
-
-    m_targetPosition = newPosition;
-    xTaskCreate(moveBlindToTargetTask, "moveBlindToTask", CONFIG_A_M_BLIND_ACCESSORY_MOVING_STACK_SIZE, this,
-                CONFIG_A_M_BLIND_ACCESSORY_MOVING_PRIORITY, &m_moveBlindTaskHandle);
+    m_targetPosition = newPosition * POSITION_SCALE;
+    post(COMMAND_MOVE);
 }
 
 uint8_t BlindAccessory::getCurrentPosition()
 {
-    ESP_LOGD(TAG, "getCurrentPosition called, returning: %d", m_blindPosition);
-    return m_blindPosition;
+    Motion motion    = m_publishedMotion.read();
+    uint8_t position = (positionAt(motion, AccessoryClock::now()) + POSITION_SCALE / 2) / POSITION_SCALE;
+    A_M_TRACE_DEBUG(TAG, m_reporter, BLIND_POSITION_GET, position, 0, "getCurrentPosition called, returning: %d", position);
+    return position;
 }
 
 uint8_t BlindAccessory::getTargetPosition()
 {
-    ESP_LOGD(TAG, "getTargetPosition called, returning: %d", m_targetPosition);
-    return m_targetPosition;
+    uint8_t position = (m_targetPosition.load() + POSITION_SCALE / 2) / POSITION_SCALE;
+    A_M_TRACE_DEBUG(TAG, m_reporter, BLIND_TARGET_GET, position, 0, "getTargetPosition called, returning: %d", position);
+    return position;
+}
+
+BlindAccessoryInterface::MotionSnapshot BlindAccessory::getMotionSnapshot()
+{
+    Motion motion = m_publishedMotion.read();
+    MotionSnapshot snapshot;
+    snapshot.startPosition  = motion.startPosition;
+    snapshot.targetPosition = motion.direction != 0 ? motion.targetPosition : motion.startPosition;
+    snapshot.startTime      = motion.startTime;
+    snapshot.velocity       = 0;
+    if (motion.direction != 0 && motion.travelMs != 0)
+    {
+        snapshot.velocity = motion.direction * static_cast<int32_t>(int64_t(POSITION_MAX) * 1000 / motion.travelMs);
+    }
+    return snapshot;
 }
 
 void BlindAccessory::setReportCallback(ReportCallback callback, CallbackParam * callbackParam)
 {
     ESP_LOGI(TAG, "setReportCallback called ");
-    m_reportCallback      = callback;
-    m_reportCallbackParam = callbackParam;
+    m_reporter.setReportCallback(callback, callbackParam);
+}
+
+void BlindAccessory::setEventCallback(EventCallback callback, CallbackParam * callbackParam)
+{
+    ESP_LOGI(TAG, "setEventCallback called");
+    m_reporter.setEventCallback(callback, callbackParam);
+}
+
+void BlindAccessory::setAccessoryId(uint16_t accessoryId)
+{
+    ESP_LOGI(TAG, "setAccessoryId called, accessoryId: %d", accessoryId);
+    m_reporter.setAccessoryId(accessoryId);
+}
+
+uint16_t BlindAccessory::getAccessoryId()
+{
+    return m_reporter.getAccessoryId();
+}
+
+void BlindAccessory::setStateStore(AccessoryStateStore * stateStore)
+{
+    ESP_LOGI(TAG, "Setting state store");
+    m_reporter.setStateStore(stateStore);
+}
+
+bool BlindAccessory::restore(const AccessoryStateRecord & record)
+{
+    if (record.accessoryType != static_cast<uint8_t>(AccessoryType::Blind) || m_identifyEngine.isRunning() ||
+        m_publishedMotion.read().direction != 0 || (m_pendingCommands.load() & ~COMMAND_RESTORE) != 0)
+    {
+        return false;
+    }
+    uint16_t position = record.currentPosition > POSITION_MAX ? POSITION_MAX : record.currentPosition;
+    m_restorePosition = position;
+    m_targetPosition  = position;
+    return post(COMMAND_RESTORE);
+}
+
+bool BlindAccessory::resume()
+{
+    AccessoryRetainedRecord record;
+    if (!AccessoryRetainedState::find(m_reporter.getAccessoryId(), record) ||
+        record.accessoryType != static_cast<uint8_t>(AccessoryType::Blind) || m_identifyEngine.isRunning() ||
+        m_publishedMotion.read().direction != 0 || (m_pendingCommands.load() & ~COMMAND_RESTORE) != 0)
+    {
+        return false;
+    }
+
+    int32_t position = record.startPosition > POSITION_MAX ? POSITION_MAX : record.startPosition;
+    int32_t target   = record.targetPosition > POSITION_MAX ? POSITION_MAX : record.targetPosition;
+    if (record.direction != 0)
+    {
+        // The motors stopped with the chip, so the motion ran from its start until the reset.
+        uint32_t travelMs = record.direction > 0 ? m_timeToOpenMs.load() : m_timeToCloseMs.load();
+        int64_t elapsedUs = AccessoryRetainedState::resetTime() - record.timeUs;
+        int64_t moved     = travelMs ? elapsedUs * POSITION_MAX / (int64_t(travelMs) * 1000) : POSITION_MAX;
+        moved             = moved < 0 ? 0 : moved > POSITION_MAX ? POSITION_MAX : moved;
+        position += record.direction * static_cast<int32_t>(moved);
+        if (record.direction * (position - target) > 0)
+        {
+            position = target;
+        }
+    }
+
+    m_restorePosition = static_cast<uint16_t>(position);
+    m_targetPosition  = static_cast<uint16_t>(target);
+    return post(position != target ? COMMAND_RESTORE | COMMAND_MOVE : COMMAND_RESTORE);
+}
+
+bool BlindAccessory::applyState(const AccessoryStateRecord & state, AccessoryEvent & event)
+{
+    event = m_reporter.makeEvent();
+    if (state.accessoryType != static_cast<uint8_t>(AccessoryType::Blind) || m_identifyEngine.isRunning())
+    {
+        return false;
+    }
+    uint16_t target = state.targetPosition > POSITION_MAX ? POSITION_MAX : state.targetPosition;
+    if (target != m_targetPosition)
+    {
+        m_targetPosition = target;
+        if (!post(COMMAND_MOVE))
+        {
+            return false;
+        }
+        event.changedMask    = AccessoryEvent::ATTRIBUTE_TARGET_POSITION;
+        event.targetPosition = target;
+    }
+    return true;
+}
+
+bool BlindAccessory::getState(AccessoryStateRecord & state)
+{
+    state                 = {};
+    state.accessoryId     = m_reporter.getAccessoryId();
+    state.accessoryType   = static_cast<uint8_t>(AccessoryType::Blind);
+    state.currentPosition = positionAt(m_publishedMotion.read(), AccessoryClock::now());
+    state.targetPosition  = m_targetPosition.load();
+    return true;
+}
+
+AccessoryLatencyStats BlindAccessory::getLatencyStats(AccessoryLatencyPath path)
+{
+    return m_reporter.getLatencyStats(path);
 }
 
 void BlindAccessory::identify()
 {
     ESP_LOGI(TAG, "identify called");
 
-    if (m_identifyHandler)
+    if (m_identifyEngine.isRunning())
     {
         ESP_LOGW(TAG, "Identify task already running");
         return;
     }
 
-    xTaskCreate(
-        [](void * instance) {
-            ESP_LOGD(TAG, "Starting identification sequence");
+    if (m_publishedMotion.read().direction != 0)
+    {
+        ESP_LOGW(TAG, "Blind is moving, cannot identify");
+        return;
+    }
 
-            BlindAccessory * blindAccessory = static_cast<BlindAccessory *>(instance);
-            blindAccessory->startMoveDown();
-            vTaskDelay(2000 / portTICK_PERIOD_MS);
-            blindAccessory->startMoveUp();
-            vTaskDelay(2000 / portTICK_PERIOD_MS);
-            blindAccessory->startMoveDown();
-            vTaskDelay(2000 / portTICK_PERIOD_MS);
-            blindAccessory->startMoveUp();
-            vTaskDelay(2000 / portTICK_PERIOD_MS);
-            blindAccessory->stopMove();
+    m_identifyEngine.start(m_identifyPattern);
+}
 
-            ESP_LOGD(TAG, "Identification sequence complete");
+void BlindAccessory::stopIdentify()
+{
+    ESP_LOGI(TAG, "Stopping identification");
+    m_identifyEngine.cancel();
+}
 
-            blindAccessory->m_identifyHandler = nullptr;
-            vTaskDelete(nullptr);
-        },
-        "identify", CONFIG_A_M_BLIND_ACCESSORY_IDENTIFY_STACK_SIZE, this, CONFIG_A_M_BLIND_ACCESSORY_IDENTIFY_PRIORITY,
-        &m_identifyHandler);
+void BlindAccessory::setIdentifyPattern(const IdentifyPattern & pattern)
+{
+    ESP_LOGI(TAG, "Setting identify pattern with %d steps", pattern.stepCount);
+    m_identifyEngine.cancel();
+    m_identifyPattern = pattern;
 }
 
 void BlindAccessory::buttonDownCallback(void * instance)
 {
     BlindAccessory * blindAccessory = static_cast<BlindAccessory *>(instance);
-    ESP_LOGI(TAG, "buttonDownCallback called");
+    blindAccessory->m_reporter.markInput();
+    A_M_TRACE(TAG, blindAccessory->m_reporter, BLIND_BUTTON, 0, 0, "buttonDownCallback called");
 
-    if (blindAccessory->m_blindPosition != blindAccessory->m_targetPosition)
+    if (blindAccessory->m_publishedMotion.read().direction != 0)
     {
-        blindAccessory->moveBlindTo(blindAccessory->m_blindPosition);
+        blindAccessory->post(COMMAND_STOP);
     }
     else
     {
@@ -132,11 +254,12 @@ void BlindAccessory::buttonDownCallback(void * instance)
 void BlindAccessory::buttonUpCallback(void * instance)
 {
     BlindAccessory * blindAccessory = static_cast<BlindAccessory *>(instance);
-    ESP_LOGI(TAG, "buttonUpCallback called");
+    blindAccessory->m_reporter.markInput();
+    A_M_TRACE(TAG, blindAccessory->m_reporter, BLIND_BUTTON, 1, 0, "buttonUpCallback called");
 
-    if (blindAccessory->m_blindPosition != blindAccessory->m_targetPosition)
+    if (blindAccessory->m_publishedMotion.read().direction != 0)
     {
-        blindAccessory->moveBlindTo(blindAccessory->m_blindPosition);
+        blindAccessory->post(COMMAND_STOP);
     }
     else
     {
@@ -146,7 +269,7 @@ void BlindAccessory::buttonUpCallback(void * instance)
 
 void BlindAccessory::startMoveUp()
 {
-    ESP_LOGI(TAG, "startMoveUp called");
+    A_M_TRACE(TAG, m_reporter, BLIND_MOTOR, 1, 0, "startMoveUp called");
     if (m_motorDown)
     {
         m_motorDown->setPower(false);
@@ -155,11 +278,12 @@ void BlindAccessory::startMoveUp()
     {
         m_motorUp->setPower(true);
     }
+    m_reporter.markActuated();
 }
 
 void BlindAccessory::startMoveDown()
 {
-    ESP_LOGI(TAG, "startMoveDown called");
+    A_M_TRACE(TAG, m_reporter, BLIND_MOTOR, -1, 0, "startMoveDown called");
     if (m_motorUp)
     {
         m_motorUp->setPower(false);
@@ -168,11 +292,12 @@ void BlindAccessory::startMoveDown()
     {
         m_motorDown->setPower(true);
     }
+    m_reporter.markActuated();
 }
 
 void BlindAccessory::stopMove()
 {
-    ESP_LOGI(TAG, "stopMove called");
+    A_M_TRACE(TAG, m_reporter, BLIND_MOTOR, 0, 0, "stopMove called");
     if (m_motorUp)
     {
         m_motorUp->setPower(false);
@@ -181,98 +306,260 @@ void BlindAccessory::stopMove()
     {
         m_motorDown->setPower(false);
     }
+    m_reporter.markActuated();
 }
 
-void BlindAccessory::moveBlindToTargetTask(void * instance)
+void BlindAccessory::motionCallback(void * instance)
 {
     BlindAccessory * blindAccessory = static_cast<BlindAccessory *>(instance);
-    ESP_LOGI(TAG, "moveBlindToTargetTask called");
+    uint8_t commands                = blindAccessory->m_pendingCommands.exchange(0);
+    int64_t now                     = AccessoryClock::now();
 
-    if (blindAccessory->m_blindPosition == blindAccessory->m_targetPosition)
+    if (commands & COMMAND_RESTORE)
     {
-        ESP_LOGI(TAG, "Blind is already at the target position: %d", blindAccessory->m_targetPosition);
-        blindAccessory->stopMove();
-        if (blindAccessory->m_reportCallback)
-        {
-            blindAccessory->m_reportCallback(blindAccessory->m_reportCallbackParam, false);
-        }
-        blindAccessory->m_moveBlindTaskHandle = nullptr;
-        vTaskDelete(nullptr);
+        blindAccessory->settle();
+    }
+
+    if (commands & COMMAND_STOP)
+    {
+        blindAccessory->m_targetPosition = positionAt(blindAccessory->m_motion, now);
+    }
+
+    if (commands & (COMMAND_MOVE | COMMAND_STOP))
+    {
+        blindAccessory->retarget();
+    }
+    else if (blindAccessory->m_motion.direction != 0 && now >= blindAccessory->m_motionArrivalTime)
+    {
+        blindAccessory->finishMotion();
+    }
+    else if (blindAccessory->m_motion.direction != 0)
+    {
+        blindAccessory->reportProgress(now);
+    }
+
+    if (blindAccessory->m_motion.direction != 0 && !blindAccessory->m_motionTimer.startAt(blindAccessory->nextWakeTime()))
+    {
+        // Nothing would stop the motors at the target.
+        ESP_LOGE(TAG, "Cannot arm the motion timer, stopping the blind");
+        uint16_t position                = positionAt(blindAccessory->m_motion, AccessoryClock::now());
+        blindAccessory->m_targetPosition = position;
+        blindAccessory->stopAt(position);
+    }
+    // A command posted while this callback was running must not wait for the next scheduled wake-up.
+    if (blindAccessory->m_pendingCommands.load() != 0)
+    {
+        blindAccessory->post(0);
+    }
+}
+
+void BlindAccessory::settle()
+{
+    if (m_motion.direction != 0)
+    {
+        // A command moved the blind after restore() or resume() checked it was at rest.
         return;
     }
+    m_motion.startPosition  = m_restorePosition;
+    m_motion.targetPosition = m_motion.startPosition;
+    publish();
+}
 
-    bool isMovingUp = blindAccessory->m_targetPosition > blindAccessory->m_blindPosition;
+void BlindAccessory::retarget()
+{
+    int64_t now       = AccessoryClock::now();
+    uint16_t position = positionAt(m_motion, now);
+    uint16_t target   = m_targetPosition;
+    A_M_TRACE(TAG, m_reporter, BLIND_RETARGET, position, target, "retarget called, position: %d, target: %d", position, target);
 
-    uint32_t checkInterval;
-    if (isMovingUp)
+    if (position == target)
     {
-        checkInterval = 1000 * (blindAccessory->m_timeToOpen) / 100;
+        stopAt(position);
+        return;
     }
-    else
+
+    int8_t direction = target > position ? 1 : -1;
+    bool starting    = m_motion.direction == 0;
+    if (direction != m_motion.direction)
     {
-        checkInterval = 1000 * (blindAccessory->m_timeToClose) / 100;
+        if (direction > 0)
+        {
+            startMoveUp();
+        }
+        else
+        {
+            startMoveDown();
+        }
     }
 
-    ESP_LOGI(TAG, "Starting to move the blind %s", isMovingUp ? "up" : "down");
-    if (isMovingUp)
+    m_motion.startTime      = now;
+    m_motion.travelMs       = direction > 0 ? m_timeToOpenMs.load() : m_timeToCloseMs.load();
+    m_motion.startPosition  = position;
+    m_motion.targetPosition = target;
+    m_motion.direction      = direction;
+    m_motionArrivalTime     = now + travelTimeUs(position, target);
+    publish();
+
+    if (starting)
     {
-        blindAccessory->startMoveUp();
+        m_lastReportPosition = position;
+        m_lastReportTime     = now;
+        report(AccessoryEvent::ATTRIBUTE_CURRENT_POSITION | AccessoryEvent::ATTRIBUTE_TARGET_POSITION, position, false);
     }
-    else
+}
+
+void BlindAccessory::stopAt(uint16_t position)
+{
+    stopMove();
+    m_motion.startPosition = position;
+    m_motion.direction     = 0;
+    publish();
+    report(AccessoryEvent::ATTRIBUTE_CURRENT_POSITION | AccessoryEvent::ATTRIBUTE_TARGET_POSITION, position, false);
+}
+
+void BlindAccessory::finishMotion()
+{
+    stopMove();
+    m_motion.startPosition = m_motion.targetPosition;
+    m_motion.direction     = 0;
+    publish();
+    A_M_TRACE(TAG, m_reporter, BLIND_ARRIVED, m_motion.targetPosition, 0, "Blind reached the target position: %d",
+              m_motion.targetPosition);
+    report(AccessoryEvent::ATTRIBUTE_CURRENT_POSITION | AccessoryEvent::ATTRIBUTE_TARGET_POSITION, m_motion.targetPosition, false);
+}
+
+bool BlindAccessory::post(uint8_t commands)
+{
+    m_pendingCommands.fetch_or(commands);
+    if (!m_motionTimer.start(0))
     {
-        blindAccessory->startMoveDown();
+        // The bits stay pending and are applied with the next command that can be scheduled.
+        ESP_LOGE(TAG, "Cannot arm the motion timer, the timer service is full");
+        return false;
     }
+    return true;
+}
 
-    TickType_t xLastWakeTime    = xTaskGetTickCount();
-    const TickType_t xFrequency = checkInterval / portTICK_PERIOD_MS;
+void BlindAccessory::publish()
+{
+    m_publishedMotion.write(m_motion);
+    retain();
+}
 
-    bool firstRun = true;
+void BlindAccessory::retain()
+{
+#if CONFIG_A_M_RETAINED_STATE
+    AccessoryRetainedRecord record = {};
+    record.accessoryId             = m_reporter.getAccessoryId();
+    record.accessoryType           = static_cast<uint8_t>(AccessoryType::Blind);
+    record.direction               = m_motion.direction;
+    record.startPosition           = m_motion.startPosition;
+    record.targetPosition          = m_motion.direction != 0 ? m_motion.targetPosition : m_motion.startPosition;
+    record.timeUs = m_motion.direction != 0 ? AccessoryRetainedState::now() + (m_motion.startTime - AccessoryClock::now()) : 0;
+    AccessoryRetainedState::save(record);
+#endif
+}
 
-    while (!blindAccessory->targetPositionReached(isMovingUp))
+void BlindAccessory::reportProgress(int64_t nowUs)
+{
+    m_lastReportPosition = positionAt(m_motion, nowUs);
+    m_lastReportTime     = nowUs;
+    A_M_TRACE_DEBUG(TAG, m_reporter, BLIND_PROGRESS, m_lastReportPosition, 0, "Reporting progress at position: %d",
+                    m_lastReportPosition);
+    report(AccessoryEvent::ATTRIBUTE_CURRENT_POSITION, m_lastReportPosition, true);
+}
+
+void BlindAccessory::report(uint16_t changedMask, uint16_t position, bool onlySave)
+{
+    AccessoryEvent event  = m_reporter.makeEvent();
+    event.changedMask     = changedMask;
+    event.onlySave        = onlySave;
+    event.currentPosition = position;
+    event.targetPosition  = m_motion.targetPosition;
+    m_reporter.report(event);
+}
+
+int64_t BlindAccessory::nextWakeTime() const
+{
+    int64_t wakeTime    = m_motionArrivalTime;
+    uint32_t intervalMs = m_reportIntervalMs.load();
+    uint8_t stepPercent = m_reportStepPercent.load();
+
+    if (intervalMs != 0)
     {
-        xTaskDelayUntil(&xLastWakeTime, xFrequency);
-        blindAccessory->m_blindPosition += isMovingUp ? 1 : -1;
-        if (blindAccessory->m_reportCallback)
+        int64_t intervalWake = m_lastReportTime + int64_t(intervalMs) * 1000;
+        wakeTime             = intervalWake < wakeTime ? intervalWake : wakeTime;
+    }
+
+    if (stepPercent != 0)
+    {
+        int32_t stepPosition = m_lastReportPosition + m_motion.direction * stepPercent * POSITION_SCALE;
+        int32_t toTarget     = m_motion.direction * (int32_t(m_motion.targetPosition) - stepPosition);
+        if (toTarget > 0)
         {
-            if (firstRun)
-            {
-                firstRun = false;
-                blindAccessory->m_reportCallback(blindAccessory->m_reportCallbackParam, false);
-            }
-            else
+            bool ahead       = m_motion.direction * (stepPosition - int32_t(m_motion.startPosition)) > 0;
+            int64_t stepWake = m_motion.startTime;
+            if (ahead)
             {
-                blindAccessory->m_reportCallback(blindAccessory->m_reportCallbackParam, true);
+                stepWake += travelTimeUs(m_motion.startPosition, static_cast<uint16_t>(stepPosition));
             }
+            wakeTime = stepWake < wakeTime ? stepWake : wakeTime;
         }
     }
 
-    blindAccessory->stopMove();
-    ESP_LOGI(TAG, "Blind reached the target position: %d", blindAccessory->m_targetPosition);
-    if (blindAccessory->m_reportCallback)
-    {
-        blindAccessory->m_reportCallback(blindAccessory->m_reportCallbackParam, false);
-    }
-    blindAccessory->m_moveBlindTaskHandle = nullptr;
-    vTaskDelete(nullptr);
+    return wakeTime;
 }
 
-bool BlindAccessory::targetPositionReached(bool movingUp)
+uint16_t BlindAccessory::positionAt(const Motion & motion, int64_t nowUs)
 {
-    ESP_LOGD(TAG, "targetPositionReached called, movingUp: %d, current: %d, target: %d", movingUp, m_blindPosition,
-             m_targetPosition);
-    if (movingUp)
+    if (motion.direction == 0)
     {
-        return m_blindPosition >= m_targetPosition;
+        return motion.startPosition;
     }
-    else
+
+    // A reader may have taken nowUs just before the motion callback published a newer motion.
+    int64_t elapsedUs = nowUs > motion.startTime ? nowUs - motion.startTime : 0;
+    int64_t moved     = motion.travelMs ? elapsedUs * POSITION_MAX / (int64_t(motion.travelMs) * 1000) : POSITION_MAX;
+    int64_t position  = motion.startPosition + motion.direction * moved;
+
+    if (motion.direction > 0 && position > motion.targetPosition)
+    {
+        position = motion.targetPosition;
+    }
+    else if (motion.direction < 0 && position < motion.targetPosition)
     {
-        return m_blindPosition <= m_targetPosition;
+        position = motion.targetPosition;
     }
+    return static_cast<uint16_t>(position);
+}
+
+int64_t BlindAccessory::travelTimeUs(uint16_t from, uint16_t to) const
+{
+    uint32_t travelMs = to > from ? m_timeToOpenMs.load() : m_timeToCloseMs.load();
+    uint16_t distance = to > from ? to - from : from - to;
+    return int64_t(distance) * travelMs * 1000 / POSITION_MAX;
 }
 
 void BlindAccessory::setDefaultPosition(uint8_t defaultPosition)
 {
     ESP_LOGI(TAG, "setDefaultPosition called with defaultPosition: %d", defaultPosition);
-    m_blindPosition  = defaultPosition;
-    m_targetPosition = defaultPosition;
+    AccessoryStateRecord record = {};
+    record.accessoryType        = static_cast<uint8_t>(AccessoryType::Blind);
+    record.currentPosition      = defaultPosition * POSITION_SCALE;
+    restore(record);
+}
+
+void BlindAccessory::setReportPolicy(uint8_t stepPercent, uint32_t intervalMs)
+{
+    ESP_LOGI(TAG, "setReportPolicy called with stepPercent: %d, intervalMs: %lu", stepPercent, (unsigned long) intervalMs);
+    m_reportStepPercent = stepPercent;
+    m_reportIntervalMs  = intervalMs;
+}
+
+void BlindAccessory::setTravelTime(uint32_t timeToOpenMs, uint32_t timeToCloseMs)
+{
+    ESP_LOGI(TAG, "setTravelTime called with timeToOpenMs: %lu, timeToCloseMs: %lu", (unsigned long) timeToOpenMs,
+             (unsigned long) timeToCloseMs);
+    m_timeToOpenMs  = timeToOpenMs;
+    m_timeToCloseMs = timeToCloseMs;
 }
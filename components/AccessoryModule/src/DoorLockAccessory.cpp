@@ -1,17 +1,22 @@
 #include "DoorLockAccessory.hpp"
+#include "AccessoryClock.hpp"
+#include "AccessoryRetainedState.hpp"
+#include "AccessoryStateStore.hpp"
+#include "AccessoryTrace.hpp"
 
 #include <esp_log.h>
-#include <freertos/FreeRTOS.h>
-#include <freertos/task.h>
 
 static const char * TAG = "DoorLockAccessory";
 
 DoorLockAccessory::DoorLockAccessory(RelayModuleInterface * relayModule, ButtonModuleInterface * buttonModule,
                                      uint8_t openDuration) :
-    m_relayModule(relayModule), m_buttonModule(buttonModule), m_openDuration(openDuration), m_openDoorTaskHandle(nullptr),
-    m_reportCallback(nullptr), m_reportCallbackParam(nullptr), m_identifyHandler(nullptr)
+    m_relayModule(relayModule), m_buttonModule(buttonModule), m_openDuration(openDuration), m_reporter(AccessoryType::DoorLock),
+    m_identifyEngine(relayModule), m_identifyPattern(IdentifyPatterns::RELAY_BLINK), m_relockTimer(relockCallback, this),
+    m_relockDeadline(0)
 {
     ESP_LOGI(TAG, "DoorLockAccessory created");
+    m_identifyEngine.setOwner(AccessoryType::DoorLock);
+    m_relockTimer.setOwner(AccessoryType::DoorLock);
     m_buttonModule->setSinglePressCallback(buttonCallback, this);
 }
 
@@ -22,8 +27,9 @@ DoorLockAccessory::~DoorLockAccessory()
 
 void DoorLockAccessory::setState(DoorLockState state)
 {
-    ESP_LOGI(TAG, "Setting state to %s", state == DoorLockState::LOCKED ? "LOCKED" : "UNLOCKED");
-    if (m_identifyHandler)
+    A_M_TRACE(TAG, m_reporter, LOCK_STATE_SET, state, 0, "Setting state to %s",
+              state == DoorLockState::LOCKED ? "LOCKED" : "UNLOCKED");
+    if (m_identifyEngine.isRunning())
     {
         ESP_LOGW(TAG, "setPower called, but identify in progress");
         return;
@@ -32,108 +38,255 @@ void DoorLockAccessory::setState(DoorLockState state)
     {
         closeDoor();
     }
-    else
+    else if (!openDoor())
     {
-        openDoor();
+        ESP_LOGE(TAG, "Door not unlocked");
     }
 }
 
 DoorLockAccessoryInterface::DoorLockState DoorLockAccessory::getState()
 {
     DoorLockState state = m_relayModule->isOn() ? DoorLockState::UNLOCKED : DoorLockState::LOCKED;
-    ESP_LOGI(TAG, "Current state is %s", state == DoorLockState::LOCKED ? "LOCKED" : "UNLOCKED");
+    A_M_TRACE(TAG, m_reporter, LOCK_STATE_GET, state, 0, "Current state is %s",
+              state == DoorLockState::LOCKED ? "LOCKED" : "UNLOCKED");
     return state;
 }
 
 void DoorLockAccessory::setReportCallback(ReportCallback callback, CallbackParam * callbackParam)
 {
     ESP_LOGI(TAG, "Setting report callback");
-    m_reportCallback      = callback;
-    m_reportCallbackParam = callbackParam;
+    m_reporter.setReportCallback(callback, callbackParam);
 }
 
-void DoorLockAccessory::identify()
+void DoorLockAccessory::setEventCallback(EventCallback callback, CallbackParam * callbackParam)
 {
-    ESP_LOGI(TAG, "Identifying DoorLockAccessory");
+    ESP_LOGI(TAG, "Setting event callback");
+    m_reporter.setEventCallback(callback, callbackParam);
+}
+
+void DoorLockAccessory::setAccessoryId(uint16_t accessoryId)
+{
+    ESP_LOGI(TAG, "Setting accessory id: %d", accessoryId);
+    m_reporter.setAccessoryId(accessoryId);
+}
+
+uint16_t DoorLockAccessory::getAccessoryId()
+{
+    return m_reporter.getAccessoryId();
+}
+
+void DoorLockAccessory::setStateStore(AccessoryStateStore * stateStore)
+{
+    ESP_LOGI(TAG, "Setting state store");
+    m_reporter.setStateStore(stateStore);
+}
+
+bool DoorLockAccessory::restore(const AccessoryStateRecord & record)
+{
+    if (record.accessoryType != static_cast<uint8_t>(AccessoryType::DoorLock))
+    {
+        return false;
+    }
+    m_identifyEngine.cancel();
+    m_relockTimer.cancel();
+    if (m_relayModule->isOn())
+    {
+        m_relayModule->setPower(false);
+    }
+    return true;
+}
+
+bool DoorLockAccessory::resume()
+{
+    AccessoryRetainedRecord record;
+    if (!AccessoryRetainedState::find(m_reporter.getAccessoryId(), record) ||
+        record.accessoryType != static_cast<uint8_t>(AccessoryType::DoorLock) || record.timeUs == 0)
+    {
+        return false;
+    }
+
+    int64_t remainingUs = record.timeUs - AccessoryRetainedState::now();
+    if (remainingUs <= 0)
+    {
+        // The unlock window ended while the chip was down.
+        if (m_relayModule->isOn())
+        {
+            m_relayModule->setPower(false);
+        }
+        retainRelockDeadline(0);
+        return true;
+    }
+
+    m_relockDeadline.write(AccessoryClock::now() + remainingUs);
+    if (!m_relockTimer.startAt(m_relockDeadline.read()))
+    {
+        ESP_LOGE(TAG, "Cannot arm the relock timer, locking the door");
+        if (m_relayModule->isOn())
+        {
+            m_relayModule->setPower(false);
+        }
+        retainRelockDeadline(0);
+        return false;
+    }
+    if (!m_relayModule->isOn())
+    {
+        m_relayModule->setPower(true);
+    }
+    return true;
+}
+
+bool DoorLockAccessory::applyState(const AccessoryStateRecord & state, AccessoryEvent & event)
+{
+    event = m_reporter.makeEvent();
+    if (state.accessoryType != static_cast<uint8_t>(AccessoryType::DoorLock) || m_identifyEngine.isRunning())
+    {
+        return false;
+    }
+    bool unlocked = state.flags & AccessoryStateRecord::FLAG_UNLOCKED;
+    bool changed  = unlocked != m_relayModule->isOn();
+    if (unlocked && !openDoor(false))
+    {
+        return false;
+    }
+    else if (changed)
+    {
+        closeDoor(false);
+    }
+    if (changed)
+    {
+        event.changedMask = AccessoryEvent::ATTRIBUTE_LOCK_STATE;
+        event.unlocked    = unlocked;
+    }
+    return true;
+}
 
-    if (m_identifyHandler != nullptr)
+bool DoorLockAccessory::getState(AccessoryStateRecord & state)
+{
+    state               = {};
+    state.accessoryId   = m_reporter.getAccessoryId();
+    state.accessoryType = static_cast<uint8_t>(AccessoryType::DoorLock);
+    state.flags         = m_relayModule && m_relayModule->isOn() ? AccessoryStateRecord::FLAG_UNLOCKED : 0;
+    return true;
+}
+
+AccessoryLatencyStats DoorLockAccessory::getLatencyStats(AccessoryLatencyPath path)
+{
+#if CONFIG_A_M_LATENCY_STATS
+    if (path == AccessoryLatencyPath::RELOCK)
     {
-        vTaskDelete(m_identifyHandler);
-        m_identifyHandler = nullptr;
+        return m_relockLatency.getStats();
     }
-    xTaskCreate(
-        [](void * instance) {
-            ESP_LOGD(TAG, "Starting identification sequence");
-            DoorLockAccessory * doorLockAccessory = static_cast<DoorLockAccessory *>(instance);
-            doorLockAccessory->m_relayModule->setPower(false);
-            vTaskDelay(1000 / portTICK_PERIOD_MS);
-            doorLockAccessory->m_relayModule->setPower(true);
-            vTaskDelay(1000 / portTICK_PERIOD_MS);
-            doorLockAccessory->m_relayModule->setPower(false);
-            vTaskDelay(1000 / portTICK_PERIOD_MS);
-            doorLockAccessory->m_relayModule->setPower(true);
-            vTaskDelay(1000 / portTICK_PERIOD_MS);
-            doorLockAccessory->m_relayModule->setPower(false);
+#endif
+    return m_reporter.getLatencyStats(path);
+}
 
-            ESP_LOGD(TAG, "Identification sequence complete");
+void DoorLockAccessory::identify()
+{
+    ESP_LOGI(TAG, "Identifying DoorLockAccessory");
 
-            doorLockAccessory->m_identifyHandler = nullptr;
-            vTaskDelete(nullptr);
-        },
-        "identify", CONFIG_A_M_DOOR_ACCESSORY_IDENTIFY_STACK_SIZE, this, CONFIG_A_M_DOOR_ACCESSORY_IDENTIFY_PRIORITY,
-        &m_identifyHandler);
+    m_identifyEngine.cancel();
+    m_identifyEngine.start(m_identifyPattern);
+}
+
+void DoorLockAccessory::stopIdentify()
+{
+    ESP_LOGI(TAG, "Stopping identification");
+    m_identifyEngine.cancel();
+}
+
+void DoorLockAccessory::setIdentifyPattern(const IdentifyPattern & pattern)
+{
+    ESP_LOGI(TAG, "Setting identify pattern with %d steps", pattern.stepCount);
+    m_identifyEngine.cancel();
+    m_identifyPattern = pattern;
 }
 
 void DoorLockAccessory::buttonCallback(void * instance)
 {
     DoorLockAccessory * doorLockAccessory = static_cast<DoorLockAccessory *>(instance);
+    doorLockAccessory->m_reporter.markInput();
     doorLockAccessory->setState(doorLockAccessory->getState() == DoorLockState::LOCKED ? DoorLockState::UNLOCKED
                                                                                        : DoorLockState::LOCKED);
 }
 
-void DoorLockAccessory::openDoor()
+bool DoorLockAccessory::openDoor(bool report)
 {
     if (getState() == DoorLockState::LOCKED)
     {
-        ESP_LOGI(TAG, "Opening door");
-        m_relayModule->setPower(true);
-        if (m_reportCallback)
+        A_M_TRACE(TAG, m_reporter, DOOR_OPEN, m_openDuration, 0, "Opening door");
+        m_relockDeadline.write(AccessoryClock::now() + int64_t(m_openDuration) * 1000000);
+        if (!m_relockTimer.startAt(m_relockDeadline.read()))
         {
-            m_reportCallback(m_reportCallbackParam, false);
+            ESP_LOGE(TAG, "Cannot arm the relock timer, keeping the door locked");
+            return false;
         }
-        xTaskCreate(openDoorTask, "openDoor", CONFIG_A_M_DOOR_ACCESSORY_OPENING_STACK_SIZE, this,
-                    CONFIG_A_M_DOOR_ACCESSORY_OPENING_PRIORITY, &m_openDoorTaskHandle);
+        m_relayModule->setPower(true);
+        m_reporter.markActuated();
+        reportLockState(true, report);
+        retainRelockDeadline(m_openDuration * 1000);
     }
-    else if (getState() == DoorLockState::UNLOCKED && m_openDoorTaskHandle != nullptr)
+    else if (m_relockTimer.isActive())
     {
-        vTaskDelete(m_openDoorTaskHandle);
-        m_openDoorTaskHandle = nullptr;
-        m_relayModule->setPower(true);
-        xTaskCreate(openDoorTask, "openDoor", CONFIG_A_M_DOOR_ACCESSORY_OPENING_STACK_SIZE, this,
-                    CONFIG_A_M_DOOR_ACCESSORY_OPENING_PRIORITY, &m_openDoorTaskHandle);
+        A_M_TRACE(TAG, m_reporter, DOOR_EXTEND, m_openDuration, 0, "Extending unlock window");
+        // A badge reader may re-trigger many times per window; extending never reorders the timer heap.
+        m_relockDeadline.write(AccessoryClock::now() + int64_t(m_openDuration) * 1000000);
+        if (!m_relockTimer.extend(m_openDuration * 1000))
+        {
+            ESP_LOGE(TAG, "Cannot re-arm the relock timer, locking the door");
+            closeDoor(report);
+            return false;
+        }
+        retainRelockDeadline(m_openDuration * 1000);
     }
+    return true;
 }
 
-void DoorLockAccessory::openDoorTask(void * pvParameters)
+void DoorLockAccessory::relockCallback(void * instance)
 {
-    DoorLockAccessory * doorLockAccessory = static_cast<DoorLockAccessory *>(pvParameters);
-    vTaskDelay(doorLockAccessory->m_openDuration * 1000 / portTICK_PERIOD_MS);
+    DoorLockAccessory * doorLockAccessory = static_cast<DoorLockAccessory *>(instance);
+#if CONFIG_A_M_LATENCY_STATS
+    int64_t lateUs = AccessoryClock::now() - doorLockAccessory->m_relockDeadline.read();
+    doorLockAccessory->m_relockLatency.record(lateUs > 0 ? static_cast<uint32_t>(lateUs) : 0);
+#endif
+    // Identify would restore the unlocked level when it ends, so it must not outlive the unlock window.
+    doorLockAccessory->m_identifyEngine.cancel();
     doorLockAccessory->closeDoor();
-    doorLockAccessory->m_openDoorTaskHandle = nullptr;
-    vTaskDelete(nullptr);
 }
 
-void DoorLockAccessory::closeDoor()
+void DoorLockAccessory::closeDoor(bool report)
 {
-    if (m_openDoorTaskHandle != nullptr)
+    m_relockTimer.cancel();
+    A_M_TRACE(TAG, m_reporter, DOOR_CLOSE, 0, 0, "Closing door");
+    m_relayModule->setPower(false);
+    m_reporter.markActuated();
+    retainRelockDeadline(0);
+    reportLockState(false, report);
+}
+
+void DoorLockAccessory::retainRelockDeadline(uint32_t delayMs)
+{
+#if CONFIG_A_M_RETAINED_STATE
+    AccessoryRetainedRecord record = {};
+    record.accessoryId             = m_reporter.getAccessoryId();
+    record.accessoryType           = static_cast<uint8_t>(AccessoryType::DoorLock);
+    record.timeUs                  = delayMs ? AccessoryRetainedState::now() + int64_t(delayMs) * 1000 : 0;
+    AccessoryRetainedState::save(record);
+#else
+    (void) delayMs;
+#endif
+}
+
+void DoorLockAccessory::reportLockState(bool unlocked, bool report)
+{
+    AccessoryEvent event = m_reporter.makeEvent();
+    event.changedMask    = AccessoryEvent::ATTRIBUTE_LOCK_STATE;
+    event.unlocked       = unlocked;
+    if (report)
     {
-        vTaskDelete(m_openDoorTaskHandle);
-        m_openDoorTaskHandle = nullptr;
+        m_reporter.report(event);
     }
-    ESP_LOGI(TAG, "Closing door");
-    m_relayModule->setPower(false);
-    if (m_reportCallback)
+    else
     {
-        m_reportCallback(m_reportCallbackParam, false);
+        m_reporter.save(event);
     }
 }
@@ -0,0 +1,114 @@
+#include "IdentifyEngine.hpp"
+
+#include <esp_log.h>
+
+static const char * TAG = "IdentifyEngine";
+
+constexpr IdentifyStep IdentifyPatterns::RELAY_BLINK_STEPS[];
+constexpr IdentifyStep IdentifyPatterns::BLIND_JOG_STEPS[];
+constexpr IdentifyPattern IdentifyPatterns::RELAY_BLINK;
+constexpr IdentifyPattern IdentifyPatterns::BLIND_JOG;
+
+IdentifyEngine::IdentifyEngine(RelayModuleInterface * output0, RelayModuleInterface * output1) :
+    m_outputs{ output0, output1 }, m_savedLevels{ false, false }, m_steps(nullptr), m_stepCount(0), m_nextStep(0),
+    m_running(false), m_timer(timerCallback, this)
+{
+}
+
+IdentifyEngine::~IdentifyEngine()
+{
+    cancel();
+}
+
+bool IdentifyEngine::start(const IdentifyPattern & pattern)
+{
+    if (m_running)
+    {
+        ESP_LOGW(TAG, "Identify pattern already running");
+        return false;
+    }
+    if (!m_outputs[0] && !m_outputs[1])
+    {
+        ESP_LOGW(TAG, "No output set, cannot identify");
+        return false;
+    }
+
+    for (uint8_t i = 0; i < MAX_OUTPUTS; i++)
+    {
+        m_savedLevels[i] = m_outputs[i] ? m_outputs[i]->isOn() : false;
+    }
+
+    ESP_LOGD(TAG, "Starting identify pattern with %d steps", pattern.stepCount);
+    m_steps     = pattern.steps;
+    m_stepCount = pattern.stepCount;
+    m_nextStep  = 0;
+    m_running   = true;
+    if (!m_timer.start(0))
+    {
+        ESP_LOGE(TAG, "Cannot arm the identify timer, the timer service is full");
+        restore();
+        m_running = false;
+        return false;
+    }
+    return true;
+}
+
+void IdentifyEngine::cancel()
+{
+    m_timer.cancel();
+    if (m_running)
+    {
+        ESP_LOGD(TAG, "Identify pattern cancelled");
+        restore();
+        m_running = false;
+    }
+}
+
+bool IdentifyEngine::isRunning() const
+{
+    return m_running;
+}
+
+void IdentifyEngine::setOwner(AccessoryType ownerType)
+{
+    m_timer.setOwner(ownerType);
+}
+
+void IdentifyEngine::timerCallback(void * instance)
+{
+    IdentifyEngine * engine = static_cast<IdentifyEngine *>(instance);
+
+    while (engine->m_nextStep < engine->m_stepCount)
+    {
+        const IdentifyStep & step = engine->m_steps[engine->m_nextStep++];
+        if (step.output < MAX_OUTPUTS && engine->m_outputs[step.output])
+        {
+            engine->m_outputs[step.output]->setPower(step.level);
+        }
+        if (step.durationMs != 0)
+        {
+            if (engine->m_timer.start(step.durationMs))
+            {
+                return;
+            }
+            // Stopping early beats leaving the outputs at a step level and the accessory locked out.
+            ESP_LOGE(TAG, "Cannot arm the identify timer, ending the pattern");
+            break;
+        }
+    }
+
+    ESP_LOGD(TAG, "Identify pattern complete");
+    engine->restore();
+    engine->m_running = false;
+}
+
+void IdentifyEngine::restore()
+{
+    for (uint8_t i = 0; i < MAX_OUTPUTS; i++)
+    {
+        if (m_outputs[i])
+        {
+            m_outputs[i]->setPower(m_savedLevels[i]);
+        }
+    }
+}
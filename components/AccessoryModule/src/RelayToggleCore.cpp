@@ -0,0 +1,200 @@
+#include "RelayToggleCore.hpp"
+#include "AccessoryStateStore.hpp"
+#include "AccessoryTrace.hpp"
+#include <esp_log.h>
+
+RelayToggleCore::RelayToggleCore(const Descriptor & descriptor, RelayModuleInterface * relayModule,
+                                 ButtonModuleInterface * buttonModule) :
+    m_descriptor(&descriptor), m_relayModule(relayModule), m_buttonModule(buttonModule), m_reporter(descriptor.type),
+    m_identifyEngine(relayModule), m_identifyPattern(*descriptor.identifyPattern)
+{
+    ESP_LOGI(m_descriptor->tag, "Accessory created");
+    m_identifyEngine.setOwner(m_descriptor->type);
+    if (m_buttonModule)
+    {
+        m_buttonModule->setSinglePressCallback(buttonCallback, this);
+    }
+}
+
+RelayToggleCore::~RelayToggleCore()
+{
+    ESP_LOGI(m_descriptor->tag, "Accessory destroyed");
+
+    m_identifyEngine.cancel();
+}
+
+bool RelayToggleCore::setPower(bool power)
+{
+    const char * TAG = m_descriptor->tag;
+    A_M_TRACE(TAG, m_reporter, POWER_SET, power, 0, "Setting power to %s", power ? "ON" : "OFF");
+    if (m_identifyEngine.isRunning())
+    {
+        ESP_LOGW(TAG, "setPower called, but identify in progress");
+        return false;
+    }
+
+    if (m_relayModule)
+    {
+        m_relayModule->setPower(power);
+        m_reporter.markActuated();
+        return true;
+    }
+    else
+    {
+        ESP_LOGW(TAG, "setPower called, but m_relayModule is nullptr");
+        return false;
+    }
+}
+
+bool RelayToggleCore::getPower()
+{
+    const char * TAG = m_descriptor->tag;
+    if (m_relayModule)
+    {
+        bool powerState = m_relayModule->isOn();
+        A_M_TRACE(TAG, m_reporter, POWER_GET, powerState, 0, "Getting power state: %s", powerState ? "ON" : "OFF");
+        return powerState;
+    }
+    else
+    {
+        ESP_LOGW(TAG, "getPower called, but m_relayModule is nullptr");
+        return false;
+    }
+}
+
+void RelayToggleCore::setReportCallback(BaseAccessoryInterface::ReportCallback callback, void * callbackParam)
+{
+    ESP_LOGI(m_descriptor->tag, "Setting report callback");
+    m_reporter.setReportCallback(callback, callbackParam);
+}
+
+void RelayToggleCore::setEventCallback(BaseAccessoryInterface::EventCallback callback, void * callbackParam)
+{
+    ESP_LOGI(m_descriptor->tag, "Setting event callback");
+    m_reporter.setEventCallback(callback, callbackParam);
+}
+
+void RelayToggleCore::setAccessoryId(uint16_t accessoryId)
+{
+    ESP_LOGI(m_descriptor->tag, "Setting accessory id: %d", accessoryId);
+    m_reporter.setAccessoryId(accessoryId);
+}
+
+uint16_t RelayToggleCore::getAccessoryId()
+{
+    return m_reporter.getAccessoryId();
+}
+
+void RelayToggleCore::setStateStore(AccessoryStateStore * stateStore)
+{
+    ESP_LOGI(m_descriptor->tag, "Setting state store");
+    m_reporter.setStateStore(stateStore);
+}
+
+bool RelayToggleCore::restore(const AccessoryStateRecord & record)
+{
+    if (record.accessoryType != static_cast<uint8_t>(m_descriptor->type) || !m_relayModule || m_identifyEngine.isRunning())
+    {
+        return false;
+    }
+    bool powerState = record.flags & AccessoryStateRecord::FLAG_POWER_ON;
+    if (m_relayModule->isOn() != powerState)
+    {
+        m_relayModule->setPower(powerState);
+    }
+    return true;
+}
+
+bool RelayToggleCore::applyState(const AccessoryStateRecord & state, AccessoryEvent & event)
+{
+    event = m_reporter.makeEvent();
+    if (state.accessoryType != static_cast<uint8_t>(m_descriptor->type) || !m_relayModule || m_identifyEngine.isRunning())
+    {
+        return false;
+    }
+    bool powerState = state.flags & AccessoryStateRecord::FLAG_POWER_ON;
+    if (m_relayModule->isOn() != powerState)
+    {
+        m_relayModule->setPower(powerState);
+        event.changedMask = AccessoryEvent::ATTRIBUTE_POWER;
+        event.powerOn     = powerState;
+        m_reporter.save(event);
+    }
+    return true;
+}
+
+bool RelayToggleCore::getState(AccessoryStateRecord & state)
+{
+    state               = {};
+    state.accessoryId   = m_reporter.getAccessoryId();
+    state.accessoryType = static_cast<uint8_t>(m_descriptor->type);
+    state.flags         = m_relayModule && m_relayModule->isOn() ? AccessoryStateRecord::FLAG_POWER_ON : 0;
+    return true;
+}
+
+AccessoryLatencyStats RelayToggleCore::getLatencyStats(AccessoryLatencyPath path)
+{
+    return m_reporter.getLatencyStats(path);
+}
+
+void RelayToggleCore::identify()
+{
+    const char * TAG = m_descriptor->tag;
+    ESP_LOGI(TAG, "Identifying accessory");
+
+    if (m_descriptor->restartIdentify)
+    {
+        m_identifyEngine.cancel();
+    }
+    else if (m_identifyEngine.isRunning())
+    {
+        ESP_LOGW(TAG, "Identify task already running");
+        return;
+    }
+
+    if (!m_relayModule)
+    {
+        ESP_LOGW(TAG, "Relay module not set, cannot identify");
+        return;
+    }
+
+    m_identifyEngine.start(m_identifyPattern);
+}
+
+void RelayToggleCore::stopIdentify()
+{
+    ESP_LOGI(m_descriptor->tag, "Stopping identification");
+    m_identifyEngine.cancel();
+}
+
+void RelayToggleCore::setIdentifyPattern(const IdentifyPattern & pattern)
+{
+    ESP_LOGI(m_descriptor->tag, "Setting identify pattern with %d steps", pattern.stepCount);
+    m_identifyEngine.cancel();
+    m_identifyPattern = pattern;
+}
+
+void RelayToggleCore::buttonCallback(void * instance)
+{
+    RelayToggleCore * core = static_cast<RelayToggleCore *>(instance);
+    const char * TAG       = core->m_descriptor->tag;
+    core->m_reporter.markInput();
+    bool newPowerState = !core->getPower();
+    A_M_TRACE(TAG, core->m_reporter, BUTTON_TOGGLE, newPowerState, 0, "Button pressed, toggling power to %s",
+              newPowerState ? "ON" : "OFF");
+
+    // A refused toggle leaves the relay as it was, so there is no change to report or save.
+    if (core->setPower(newPowerState))
+    {
+        core->reportPower(newPowerState);
+    }
+}
+
+void RelayToggleCore::reportPower(bool power)
+{
+    AccessoryEvent event = m_reporter.makeEvent();
+    event.changedMask    = AccessoryEvent::ATTRIBUTE_POWER;
+    event.powerOn        = power;
+    ESP_LOGD(m_descriptor->tag, "Invoking report callback");
+    m_reporter.report(event);
+}
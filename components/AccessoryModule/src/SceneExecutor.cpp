@@ -0,0 +1,315 @@
+#include "SceneExecutor.hpp"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <string.h>
+
+#include "AccessoryCrc.hpp"
+
+static const char * TAG = "SceneExecutor";
+
+SceneExecutor::SceneExecutor(BaseAccessoryInterface * const * accessories, size_t count, AccessoryStorageInterface * storage) :
+    m_accessories(accessories), m_accessoryCount(accessories ? count : 0), m_storage(storage), m_reportCallback(nullptr),
+    m_reportCallbackParam(nullptr), m_events{}, m_eventCount(0), m_applied(0), m_skipped(0), m_presets{}, m_presetCount(0),
+    m_presetEntries{}, m_presetEntryCount(0), m_busy(false), m_stats{}, m_lock(portMUX_INITIALIZER_UNLOCKED)
+{
+}
+
+void SceneExecutor::setReportCallback(ReportCallback callback, void * callbackParam)
+{
+    m_reportCallback      = callback;
+    m_reportCallbackParam = callbackParam;
+}
+
+bool SceneExecutor::activate(const Entry * entries, size_t count, uint8_t sceneId)
+{
+    if (count > MAX_ENTRIES || (count && !entries))
+    {
+        ESP_LOGE(TAG, "Scene %d has %d entries, at most %d are supported", sceneId, static_cast<int>(count),
+                 static_cast<int>(MAX_ENTRIES));
+        portENTER_CRITICAL(&m_lock);
+        m_stats.rejected++;
+        portEXIT_CRITICAL(&m_lock);
+        return false;
+    }
+    if (!begin())
+    {
+        return false;
+    }
+
+    int64_t startUs = esp_timer_get_time();
+    for (size_t i = 0; i < count; i++)
+    {
+        apply(entries[i].accessory, entries[i].state);
+    }
+    finish(sceneId, startUs);
+    return true;
+}
+
+bool SceneExecutor::setPreset(uint8_t sceneId, const Entry * entries, size_t count)
+{
+    if (count > MAX_ENTRIES || (count && !entries))
+    {
+        ESP_LOGE(TAG, "Preset %d has %d entries, at most %d are supported", sceneId, static_cast<int>(count),
+                 static_cast<int>(MAX_ENTRIES));
+        return false;
+    }
+    int existing        = findPreset(sceneId);
+    size_t freedEntries = existing >= 0 ? m_presets[existing].entryCount : 0;
+    size_t freedPresets = existing >= 0 ? 1 : 0;
+    bool roomForEntries = m_presetEntryCount - freedEntries + count <= MAX_PRESET_ENTRIES;
+    bool roomForPreset  = m_presetCount - freedPresets < MAX_PRESETS;
+    if (!roomForEntries || !roomForPreset)
+    {
+        ESP_LOGE(TAG, "No room left for preset %d", sceneId);
+        return false;
+    }
+
+    removePreset(sceneId);
+    Preset & preset   = m_presets[m_presetCount++];
+    preset.sceneId    = sceneId;
+    preset.entryCount = static_cast<uint8_t>(count);
+    preset.firstEntry = static_cast<uint16_t>(m_presetEntryCount);
+    for (size_t i = 0; i < count; i++)
+    {
+        PresetEntry & entry  = m_presetEntries[m_presetEntryCount++];
+        entry.accessoryId    = entries[i].accessory ? entries[i].accessory->getAccessoryId() : 0;
+        entry.accessoryType  = entries[i].state.accessoryType;
+        entry.flags          = entries[i].state.flags;
+        entry.targetPosition = entries[i].state.targetPosition;
+    }
+    ESP_LOGI(TAG, "Preset %d stored with %d entries", sceneId, static_cast<int>(count));
+    return true;
+}
+
+bool SceneExecutor::removePreset(uint8_t sceneId)
+{
+    int index = findPreset(sceneId);
+    if (index < 0)
+    {
+        return false;
+    }
+
+    // Keep the entries contiguous: close the gap and move the presets stored after this one.
+    Preset removed = m_presets[index];
+    memmove(&m_presetEntries[removed.firstEntry], &m_presetEntries[removed.firstEntry + removed.entryCount],
+            (m_presetEntryCount - removed.firstEntry - removed.entryCount) * sizeof(PresetEntry));
+    m_presetEntryCount -= removed.entryCount;
+    memmove(&m_presets[index], &m_presets[index + 1], (m_presetCount - index - 1) * sizeof(Preset));
+    m_presetCount--;
+    for (size_t i = index; i < m_presetCount; i++)
+    {
+        m_presets[i].firstEntry -= removed.entryCount;
+    }
+    return true;
+}
+
+bool SceneExecutor::activatePreset(uint8_t sceneId)
+{
+    int index = findPreset(sceneId);
+    if (index < 0)
+    {
+        ESP_LOGW(TAG, "Preset %d not found", sceneId);
+        portENTER_CRITICAL(&m_lock);
+        m_stats.rejected++;
+        portEXIT_CRITICAL(&m_lock);
+        return false;
+    }
+    if (!begin())
+    {
+        return false;
+    }
+
+    int64_t startUs       = esp_timer_get_time();
+    const Preset & preset = m_presets[index];
+    for (size_t i = preset.firstEntry; i < size_t(preset.firstEntry) + preset.entryCount; i++)
+    {
+        const PresetEntry & entry  = m_presetEntries[i];
+        AccessoryStateRecord state = {};
+        state.accessoryId          = entry.accessoryId;
+        state.accessoryType        = entry.accessoryType;
+        state.flags                = entry.flags;
+        state.targetPosition       = entry.targetPosition;
+        apply(findAccessory(entry.accessoryId), state);
+    }
+    finish(sceneId, startUs);
+    return true;
+}
+
+bool SceneExecutor::loadPresets()
+{
+    StorageHeader header;
+    if (!m_storage || !m_storage->read(0, &header, sizeof(header)))
+    {
+        ESP_LOGW(TAG, "Cannot read the presets");
+        return false;
+    }
+    if (header.magic != STORAGE_MAGIC || header.presetCount > MAX_PRESETS || header.entryCount > MAX_PRESET_ENTRIES)
+    {
+        ESP_LOGI(TAG, "No presets stored");
+        return false;
+    }
+
+    Preset presets[MAX_PRESETS];
+    size_t presetsSize = header.presetCount * sizeof(Preset);
+    size_t entriesSize = header.entryCount * sizeof(PresetEntry);
+    if (!m_storage->read(sizeof(header), presets, presetsSize) ||
+        !m_storage->read(sizeof(header) + presetsSize, m_presetEntries, entriesSize) ||
+        AccessoryCrc::update(AccessoryCrc::update(AccessoryCrc::INITIAL, presets, presetsSize), m_presetEntries, entriesSize) !=
+            header.crc)
+    {
+        ESP_LOGE(TAG, "Stored presets are corrupted");
+        m_presetCount      = 0;
+        m_presetEntryCount = 0;
+        return false;
+    }
+    for (size_t i = 0; i < header.presetCount; i++)
+    {
+        if (presets[i].entryCount > MAX_ENTRIES || presets[i].firstEntry + presets[i].entryCount > header.entryCount)
+        {
+            ESP_LOGE(TAG, "Stored preset %d is out of bounds", presets[i].sceneId);
+            m_presetCount      = 0;
+            m_presetEntryCount = 0;
+            return false;
+        }
+    }
+    memcpy(m_presets, presets, presetsSize);
+    m_presetCount      = header.presetCount;
+    m_presetEntryCount = header.entryCount;
+    ESP_LOGI(TAG, "Loaded %d presets", static_cast<int>(m_presetCount));
+    return true;
+}
+
+bool SceneExecutor::savePresets()
+{
+    size_t presetsSize = m_presetCount * sizeof(Preset);
+    size_t entriesSize = m_presetEntryCount * sizeof(PresetEntry);
+    if (!m_storage || sizeof(StorageHeader) + presetsSize + entriesSize > m_storage->getSize())
+    {
+        ESP_LOGE(TAG, "No storage large enough for the presets");
+        return false;
+    }
+
+    StorageHeader header;
+    header.magic       = STORAGE_MAGIC;
+    header.presetCount = static_cast<uint16_t>(m_presetCount);
+    header.entryCount  = static_cast<uint16_t>(m_presetEntryCount);
+    header.crc         = AccessoryCrc::update(AccessoryCrc::INITIAL, m_presets, presetsSize);
+    header.crc         = AccessoryCrc::update(header.crc, m_presetEntries, entriesSize);
+    header.reserved    = 0xFFFF;
+    // The header goes last, so an interrupted save leaves no valid presets rather than corrupted ones.
+    if (!m_storage->erase(0, m_storage->getSize()) || !m_storage->write(sizeof(header), m_presets, presetsSize) ||
+        !m_storage->write(sizeof(header) + presetsSize, m_presetEntries, entriesSize) ||
+        !m_storage->write(0, &header, sizeof(header)))
+    {
+        ESP_LOGE(TAG, "Cannot write the presets");
+        return false;
+    }
+    ESP_LOGI(TAG, "Saved %d presets", static_cast<int>(m_presetCount));
+    return true;
+}
+
+SceneExecutor::Stats SceneExecutor::getStats()
+{
+    portENTER_CRITICAL(&m_lock);
+    Stats stats = m_stats;
+    portEXIT_CRITICAL(&m_lock);
+    return stats;
+}
+
+AccessoryLatencyStats SceneExecutor::getLatencyStats() const
+{
+#if CONFIG_A_M_LATENCY_STATS
+    return m_activationLatency.getStats();
+#else
+    return AccessoryLatencyStats{};
+#endif
+}
+
+void SceneExecutor::apply(BaseAccessoryInterface * accessory, const AccessoryStateRecord & state)
+{
+    AccessoryEvent & event = m_events[m_eventCount];
+    if (!accessory || !accessory->applyState(state, event))
+    {
+        m_skipped++;
+        return;
+    }
+    m_applied++;
+    if (event.changedMask)
+    {
+        m_eventCount++;
+    }
+}
+
+bool SceneExecutor::begin()
+{
+    if (m_busy.exchange(true, std::memory_order_acquire))
+    {
+        ESP_LOGW(TAG, "Activation already running");
+        portENTER_CRITICAL(&m_lock);
+        m_stats.rejected++;
+        portEXIT_CRITICAL(&m_lock);
+        return false;
+    }
+    m_eventCount = 0;
+    m_applied    = 0;
+    m_skipped    = 0;
+    return true;
+}
+
+void SceneExecutor::finish(uint8_t sceneId, int64_t startUs)
+{
+    uint32_t durationUs = static_cast<uint32_t>(esp_timer_get_time() - startUs);
+    bool overrun        = CONFIG_A_M_SCENE_BUDGET_US > 0 && durationUs > CONFIG_A_M_SCENE_BUDGET_US;
+
+    portENTER_CRITICAL(&m_lock);
+    m_stats.activations++;
+    m_stats.overruns += overrun ? 1 : 0;
+    m_stats.lastUs = durationUs;
+    m_stats.maxUs  = durationUs > m_stats.maxUs ? durationUs : m_stats.maxUs;
+    portEXIT_CRITICAL(&m_lock);
+#if CONFIG_A_M_LATENCY_STATS
+    m_activationLatency.record(durationUs);
+#endif
+    if (overrun)
+    {
+        ESP_LOGW(TAG, "Scene %d took %lu us, budget is %d us", sceneId, (unsigned long) durationUs, CONFIG_A_M_SCENE_BUDGET_US);
+    }
+
+    if (m_reportCallback)
+    {
+        Report report     = {};
+        report.sceneId    = sceneId;
+        report.applied    = m_applied;
+        report.skipped    = m_skipped;
+        report.durationUs = durationUs;
+        report.events     = m_events;
+        report.eventCount = m_eventCount;
+        m_reportCallback(report, m_reportCallbackParam);
+    }
+    m_busy.store(false, std::memory_order_release);
+}
+
+BaseAccessoryInterface * SceneExecutor::findAccessory(uint16_t accessoryId)
+{
+    for (size_t i = 0; i < m_accessoryCount; i++)
+    {
+        if (m_accessories[i] && m_accessories[i]->getAccessoryId() == accessoryId)
+        {
+            return m_accessories[i];
+        }
+    }
+    return nullptr;
+}
+
+int SceneExecutor::findPreset(uint8_t sceneId)
+{
+    for (size_t i = 0; i < m_presetCount; i++)
+    {
+        if (m_presets[i].sceneId == sceneId)
+        {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
@@ -1,31 +1,36 @@
 #include "StatelessButtonAccessory.hpp"
+#include "AccessoryClock.hpp"
+#include "AccessoryStateStore.hpp"
+#include "AccessoryTrace.hpp"
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 
 static const char * TAG = "StatelessButtonAccessory";
 
 StatelessButtonAccessory::StatelessButtonAccessory(ButtonModuleInterface * buttonModule) :
-    m_buttonModule(buttonModule), m_lastPressType(SinglePress), m_reportCallback(nullptr), m_reportCallbackParam(nullptr)
+    m_buttonModule(buttonModule), m_lastPress(PressEvent{ SinglePress, 0, 0, 0 }), m_queue{}, m_writePosition(0), m_readPosition(0),
+    m_overflowCount(0), m_sequence(0), m_reporter(AccessoryType::StatelessButton), m_decoder(handleDecodedPress, this)
 {
     ESP_LOGI(TAG, "StatelessButtonAccessory created");
+    m_decoder.setOwner(AccessoryType::StatelessButton);
 
     if (m_buttonModule)
     {
         m_buttonModule->setSinglePressCallback(
             [](void * instance) {
-                handlePress(instance, StatelessButtonAccessoryInterface::PressType::SinglePress, "Single press detected");
+                handlePress(instance, StatelessButtonAccessoryInterface::PressType::SinglePress, 1, "Single press detected");
             },
             this);
 
         m_buttonModule->setDoublePressCallback(
             [](void * instance) {
-                handlePress(instance, StatelessButtonAccessoryInterface::PressType::DoublePress, "Double press detected");
+                handlePress(instance, StatelessButtonAccessoryInterface::PressType::DoublePress, 1, "Double press detected");
             },
             this);
 
         m_buttonModule->setLongPressCallback(
             [](void * instance) {
-                handlePress(instance, StatelessButtonAccessoryInterface::PressType::LongPress, "Long press detected");
+                handlePress(instance, StatelessButtonAccessoryInterface::PressType::LongPress, 1, "Long press detected");
             },
             this);
     }
@@ -39,8 +44,60 @@ StatelessButtonAccessory::~StatelessButtonAccessory()
 void StatelessButtonAccessory::setReportCallback(ReportCallback callback, CallbackParam * callbackParam)
 {
     ESP_LOGI(TAG, "Setting report callback");
-    m_reportCallback      = callback;
-    m_reportCallbackParam = callbackParam;
+    m_reporter.setReportCallback(callback, callbackParam);
+}
+
+void StatelessButtonAccessory::setEventCallback(EventCallback callback, CallbackParam * callbackParam)
+{
+    ESP_LOGI(TAG, "Setting event callback");
+    m_reporter.setEventCallback(callback, callbackParam);
+}
+
+void StatelessButtonAccessory::setAccessoryId(uint16_t accessoryId)
+{
+    ESP_LOGI(TAG, "Setting accessory id: %d", accessoryId);
+    m_reporter.setAccessoryId(accessoryId);
+}
+
+uint16_t StatelessButtonAccessory::getAccessoryId()
+{
+    return m_reporter.getAccessoryId();
+}
+
+void StatelessButtonAccessory::setStateStore(AccessoryStateStore * stateStore)
+{
+    ESP_LOGI(TAG, "Setting state store");
+    m_reporter.setStateStore(stateStore);
+}
+
+bool StatelessButtonAccessory::restore(const AccessoryStateRecord & record)
+{
+    return record.accessoryType == static_cast<uint8_t>(AccessoryType::StatelessButton);
+}
+
+bool StatelessButtonAccessory::resume()
+{
+    return false;
+}
+
+bool StatelessButtonAccessory::applyState(const AccessoryStateRecord & state, AccessoryEvent & event)
+{
+    (void) state;
+    event = m_reporter.makeEvent();
+    return false;
+}
+
+bool StatelessButtonAccessory::getState(AccessoryStateRecord & state)
+{
+    state               = {};
+    state.accessoryId   = m_reporter.getAccessoryId();
+    state.accessoryType = static_cast<uint8_t>(AccessoryType::StatelessButton);
+    return false;
+}
+
+AccessoryLatencyStats StatelessButtonAccessory::getLatencyStats(AccessoryLatencyPath path)
+{
+    return m_reporter.getLatencyStats(path);
 }
 
 void StatelessButtonAccessory::identify()
@@ -49,20 +106,86 @@ void StatelessButtonAccessory::identify()
     // Implement the identification logic if needed
 }
 
+void StatelessButtonAccessory::stopIdentify()
+{
+    ESP_LOGI(TAG, "Stopping identification of StatelessButtonAccessory");
+}
+
 StatelessButtonAccessoryInterface::PressType StatelessButtonAccessory::getLastPressType()
 {
-    ESP_LOGI(TAG, "Getting last press type: %d", m_lastPressType);
-    return m_lastPressType;
+    PressType pressType = m_lastPress.read().pressType;
+    A_M_TRACE(TAG, m_reporter, PRESS_TYPE_GET, pressType, 0, "Getting last press type: %d", pressType);
+    return pressType;
 }
 
-void StatelessButtonAccessory::handlePress(void * instance, StatelessButtonAccessoryInterface::PressType pressType,
-                                           const char * logMessage)
+StatelessButtonAccessoryInterface::PressEvent StatelessButtonAccessory::getLastPress()
 {
-    StatelessButtonAccessory * statelessButtonAccessory = static_cast<StatelessButtonAccessory *>(instance);
-    statelessButtonAccessory->m_lastPressType           = pressType;
-    ESP_LOGI(TAG, "%s", logMessage);
-    if (statelessButtonAccessory->m_reportCallback)
+    return m_lastPress.read();
+}
+
+size_t StatelessButtonAccessory::drainEvents(PressEvent * events, size_t maxEvents)
+{
+    uint32_t read      = m_readPosition.load(std::memory_order_relaxed);
+    uint32_t available = m_writePosition.load(std::memory_order_acquire) - read;
+    size_t count       = available < maxEvents ? available : maxEvents;
+    for (size_t i = 0; i < count; i++)
     {
-        statelessButtonAccessory->m_reportCallback(statelessButtonAccessory->m_reportCallbackParam, false);
+        events[i] = m_queue[(read + i) % QUEUE_SIZE];
     }
+    m_readPosition.store(read + static_cast<uint32_t>(count), std::memory_order_release);
+    return count;
+}
+
+uint32_t StatelessButtonAccessory::getOverflowCount()
+{
+    return m_overflowCount.load(std::memory_order_relaxed);
+}
+
+void StatelessButtonAccessory::setPressProfile(const AccessoryPressProfile & profile)
+{
+    ESP_LOGI(TAG, "Setting press profile: gap %d ms, long press %d ms, max presses %d", profile.multiPressGapMs,
+             profile.longPressMs, profile.maxPresses);
+    m_decoder.setProfile(profile);
+}
+
+void StatelessButtonAccessory::handleEdge(bool pressed)
+{
+    m_decoder.edge(pressed);
+}
+
+void StatelessButtonAccessory::enqueue(const PressEvent & event)
+{
+    uint32_t write = m_writePosition.load(std::memory_order_relaxed);
+    if (write - m_readPosition.load(std::memory_order_acquire) == QUEUE_SIZE)
+    {
+        // Keep the older presses: the sequence gap tells the application how many were lost.
+        m_overflowCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    m_queue[write % QUEUE_SIZE] = event;
+    m_writePosition.store(write + 1, std::memory_order_release);
+}
+
+void StatelessButtonAccessory::handlePress(void * instance, StatelessButtonAccessoryInterface::PressType pressType,
+                                           uint8_t pressCount, const char * logMessage)
+{
+    StatelessButtonAccessory * statelessButtonAccessory = static_cast<StatelessButtonAccessory *>(instance);
+
+    PressEvent press = { pressType, AccessoryClock::now(), ++statelessButtonAccessory->m_sequence, pressCount };
+    statelessButtonAccessory->m_lastPress.write(press);
+    statelessButtonAccessory->enqueue(press);
+    statelessButtonAccessory->m_reporter.markActuated();
+    A_M_TRACE(TAG, statelessButtonAccessory->m_reporter, PRESS, pressType, pressCount, "%s", logMessage);
+
+    AccessoryEvent event = statelessButtonAccessory->m_reporter.makeEvent();
+    event.changedMask    = AccessoryEvent::ATTRIBUTE_PRESS_TYPE;
+    event.pressType      = pressType;
+    event.pressCount     = pressCount;
+    statelessButtonAccessory->m_reporter.report(event);
+}
+
+void StatelessButtonAccessory::handleDecodedPress(void * instance, StatelessButtonAccessoryInterface::PressType pressType,
+                                                  uint8_t pressCount)
+{
+    handlePress(instance, pressType, pressCount, "Decoded press");
 }
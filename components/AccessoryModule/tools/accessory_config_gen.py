@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+"""Generate the binary accessory configuration image read by AccessoryConfig.
+
+The input is a JSON list of accessories, or an object with an "accessories" list:
+
+    [
+        {"type": "light", "endpoint": 1, "relay": 0, "button": 0},
+        {"type": "doorLock", "endpoint": 2, "relay": 1, "button": 1, "openDuration": 5},
+        {"type": "blind", "endpoint": 3, "relays": [2, 3], "buttons": [2, 3], "timeToOpen": 25, "timeToClose": 20},
+        {"type": "statelessButton", "endpoint": 4, "button": 4}
+    ]
+
+Relays and buttons are indices into the tables the firmware passes to AccessoryConfig::build(). The image can be
+flashed to a data partition:
+
+    python3 accessory_config_gen.py board.json accessory_config.bin --size 0x1000
+    parttool.py write_partition --partition-name accessory_cfg --input accessory_config.bin
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+# Keep in sync with AccessoryConfigHeader and AccessoryConfigRecord in include/AccessoryConfig.hpp.
+MAGIC = 0x4643414D
+VERSION = 1
+HEADER_FORMAT = "<IHHHHHH"
+RECORD_FORMAT = "<BBH2B2B2BH"
+NONE = 0xFF
+
+# Keep in sync with AccessoryType in include/AccessoryEvent.hpp.
+ACCESSORY_TYPES = ["light", "fan", "switch", "plugin", "doorLock", "blind", "statelessButton"]
+
+
+def crc16(data):
+    """CRC-16/CCITT, as AccessoryConfig::checksum()."""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def pair(accessory, single, plural):
+    """Return the two indices of a wiring field, given as "relay": n or "relays": [up, down]."""
+    values = accessory.get(plural, [accessory[single]] if single in accessory else [])
+    if len(values) > 2:
+        raise ValueError(f"endpoint {accessory['endpoint']}: at most two {plural}")
+    values = list(values) + [NONE] * (2 - len(values))
+    for value in values:
+        if not 0 <= value <= NONE:
+            raise ValueError(f"endpoint {accessory['endpoint']}: {plural} index {value} out of range")
+    return values
+
+
+def encode(accessory):
+    """Pack one accessory, checking that it has the modules its constructor needs."""
+    kind = accessory["type"]
+    if kind not in ACCESSORY_TYPES:
+        raise ValueError(f"endpoint {accessory.get('endpoint')}: unknown type {kind}")
+    endpoint = accessory["endpoint"]
+    relays = pair(accessory, "relay", "relays")
+    buttons = pair(accessory, "button", "buttons")
+    if kind == "blind":
+        timing = [accessory.get("timeToOpen", 30), accessory.get("timeToClose", 30)]
+        wired = NONE not in relays
+    elif kind == "doorLock":
+        timing = [accessory.get("openDuration", 5), 0]
+        wired = relays[0] != NONE and buttons[0] != NONE
+    elif kind == "statelessButton":
+        timing = [0, 0]
+        wired = relays == [NONE, NONE]
+    else:
+        timing = [0, 0]
+        wired = relays[0] != NONE and relays[1] == NONE
+    if not wired:
+        raise ValueError(f"endpoint {endpoint}: relays {relays} and buttons {buttons} do not fit a {kind}")
+    return struct.pack(RECORD_FORMAT, ACCESSORY_TYPES.index(kind), NONE, endpoint, *relays, *buttons, *timing, 0xFFFF)
+
+
+def check_distinct(accessories):
+    """Reject shared endpoints, relays and buttons, as the AccessoryDevice static_asserts do."""
+    fields = (("endpoint", lambda accessory: [accessory["endpoint"]]),
+              ("relay", lambda accessory: [value for value in pair(accessory, "relay", "relays") if value != NONE]),
+              ("button", lambda accessory: [value for value in pair(accessory, "button", "buttons") if value != NONE]))
+    for field, values in fields:
+        owners = {}
+        for accessory in accessories:
+            for value in values(accessory):
+                if value in owners:
+                    endpoints = f"{owners[value]} and {accessory['endpoint']}"
+                    raise ValueError(f"{field} {value} is used by endpoints {endpoints}")
+                owners[value] = accessory["endpoint"]
+
+
+def generate(accessories):
+    """Return the image of a list of accessories."""
+    check_distinct(accessories)
+    records = b"".join(encode(accessory) for accessory in accessories)
+    header = struct.pack(HEADER_FORMAT, MAGIC, VERSION, struct.calcsize(HEADER_FORMAT), struct.calcsize(RECORD_FORMAT),
+                         len(accessories), crc16(records), 0xFFFF)
+    return header + records
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("config", type=argparse.FileType("r"), help="JSON accessory list")
+    parser.add_argument("image", help="binary image to write")
+    parser.add_argument("--size", type=lambda value: int(value, 0), default=0,
+                        help="pad the image with 0xFF to the partition size")
+    args = parser.parse_args()
+
+    config = json.load(args.config)
+    accessories = config["accessories"] if isinstance(config, dict) else config
+    try:
+        image = generate(accessories)
+    except (KeyError, ValueError, struct.error) as error:
+        sys.exit(f"{args.config.name}: {error}")
+    if args.size:
+        if len(image) > args.size:
+            sys.exit(f"{args.config.name}: the image needs {len(image)} bytes, the partition has {args.size}")
+        image += b"\xff" * (args.size - len(image))
+    with open(args.image, "wb") as output:
+        output.write(image)
+    print(f"{args.image}: {len(accessories)} accessories, {len(image)} bytes")
+
+
+if __name__ == "__main__":
+    main()
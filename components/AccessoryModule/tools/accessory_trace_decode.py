@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+"""Decode AccessoryTrace::dump() output captured from the serial monitor.
+
+Usage:
+    idf.py monitor | tee monitor.log
+    python3 accessory_trace_decode.py monitor.log
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+# Keep in sync with AccessoryType in include/AccessoryEvent.hpp.
+ACCESSORY_TYPES = ["Light", "Fan", "Switch", "Plugin", "DoorLock", "Blind", "StatelessButton"]
+
+# Keep in sync with AccessoryTraceCode in include/AccessoryTrace.hpp.
+TRACE_CODES = {
+    1: "POWER_SET",
+    2: "POWER_GET",
+    3: "BUTTON_TOGGLE",
+    4: "LOCK_STATE_SET",
+    5: "LOCK_STATE_GET",
+    6: "DOOR_OPEN",
+    7: "DOOR_EXTEND",
+    8: "DOOR_CLOSE",
+    9: "PRESS",
+    10: "PRESS_TYPE_GET",
+    11: "BLIND_MOVE",
+    12: "BLIND_BUTTON",
+    13: "BLIND_POSITION_GET",
+    14: "BLIND_TARGET_GET",
+    15: "BLIND_MOTOR",
+    16: "BLIND_RETARGET",
+    17: "BLIND_ARRIVED",
+    18: "BLIND_PROGRESS",
+}
+
+RECORD_FORMAT = "<IHBBII"
+RECORD_PATTERN = re.compile(r"AMTRACE:([0-9a-f]{32})")
+
+
+def decode(lines):
+    """Yield (timestamp_us, accessory_type, accessory_id, code, arg0, arg1) with the 32-bit timestamp unwrapped."""
+    previous = None
+    offset = 0
+    for line in lines:
+        match = RECORD_PATTERN.search(line)
+        if not match:
+            continue
+        timestamp, accessory_id, accessory_type, code, arg0, arg1 = struct.unpack(
+            RECORD_FORMAT, bytes.fromhex(match.group(1)))
+        if previous is not None and timestamp < previous:
+            offset += 1 << 32
+        previous = timestamp
+        yield timestamp + offset, accessory_type, accessory_id, code, arg0, arg1
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("log", nargs="?", type=argparse.FileType("r"), default=sys.stdin,
+                        help="monitor output containing AMTRACE lines (default: stdin)")
+    args = parser.parse_args()
+
+    first = None
+    last = None
+    print(f"{'time [us]':>12} {'delta [us]':>10}  {'accessory':<20} {'code':<20} {'arg0':>10} {'arg1':>10}")
+    for timestamp, accessory_type, accessory_id, code, arg0, arg1 in decode(args.log):
+        if first is None:
+            first = timestamp
+        delta = 0 if last is None else timestamp - last
+        last = timestamp
+        type_name = ACCESSORY_TYPES[accessory_type] if accessory_type < len(ACCESSORY_TYPES) else str(accessory_type)
+        code_name = TRACE_CODES.get(code, str(code))
+        print(f"{timestamp - first:>12} {delta:>10}  {type_name + '#' + str(accessory_id):<20} {code_name:<20} "
+              f"{arg0:>10} {arg1:>10}")
+
+
+if __name__ == "__main__":
+    main()
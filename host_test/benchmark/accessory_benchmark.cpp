@@ -0,0 +1,458 @@
+#include <chrono>
+#include <ctype.h>
+#include <map>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include <esp_log.h>
+
+#include <AccessoryConfig.hpp>
+#include <AccessoryConfigFile.hpp>
+#include <AccessoryDevice.hpp>
+#include <AccessoryRegistry.hpp>
+#include <AccessoryStateStore.hpp>
+#include <BlindAccessory.hpp>
+#include <DoorLockAccessory.hpp>
+#include <FanAccessory.hpp>
+#include <LightAccessory.hpp>
+#include <PluginAccessory.hpp>
+#include <SceneExecutor.hpp>
+#include <SwitchAccessory.hpp>
+
+#include "FakeButtonModule.hpp"
+#include "FakeRelayModule.hpp"
+
+/**
+ * @brief Runs an operation the given number of times and prints the average cost per operation.
+ */
+template <typename Operation>
+static void benchmark(const char * name, uint32_t iterations, Operation operation)
+{
+    // Warm up caches and lazily started services outside the measurement.
+    for (uint32_t i = 0; i < iterations / 10 + 1; i++)
+    {
+        operation(i);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        operation(i);
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%-32s %10u %12.1f\n", name, iterations, static_cast<double>(elapsed) / iterations);
+}
+
+/// A four channel relay board with a door lock, described at compile time.
+static constexpr AccessorySpec BENCHMARK_BOARD[] = { AccessorySpec::light(1, 0, 0), AccessorySpec::light(2, 1, 1),
+                                                     AccessorySpec::fan(3, 2, 2), AccessorySpec::doorLock(4, 3, 3) };
+
+/**
+ * @brief Node of the JSON baseline: a document tree with one heap node per value, as cJSON builds it.
+ */
+struct JsonValue
+{
+    double number = 0;                                        ///< Value of a number.
+    std::string string;                                       ///< Value of a string.
+    std::vector<std::pair<std::string, JsonValue *>> members; ///< Members of an object.
+    std::vector<JsonValue *> items;                           ///< Items of an array.
+
+    ~JsonValue()
+    {
+        for (auto & member : members)
+        {
+            delete member.second;
+        }
+        for (JsonValue * item : items)
+        {
+            delete item;
+        }
+    }
+
+    const JsonValue * get(const char * name) const
+    {
+        for (const auto & member : members)
+        {
+            if (member.first == name)
+            {
+                return member.second;
+            }
+        }
+        return nullptr;
+    }
+
+    uint8_t index(const char * single, const char * plural, size_t position) const
+    {
+        const JsonValue * value = get(plural);
+        if (value)
+        {
+            return position < value->items.size() ? static_cast<uint8_t>(value->items[position]->number) : 0xFF;
+        }
+        value = get(single);
+        return value && position == 0 ? static_cast<uint8_t>(value->number) : 0xFF;
+    }
+};
+
+/**
+ * @brief Parses the subset of JSON used by accessory configurations: objects, arrays, strings and numbers.
+ */
+static JsonValue * parseJson(const char *& text)
+{
+    while (isspace(static_cast<unsigned char>(*text)))
+    {
+        text++;
+    }
+    JsonValue * value = new JsonValue();
+    if (*text == '[' || *text == '{')
+    {
+        char close = *text == '[' ? ']' : '}';
+        text++;
+        while (*text && *text != close)
+        {
+            if (close == '}')
+            {
+                JsonValue * name = parseJson(text);
+                text             = strchr(text, ':') + 1;
+                value->members.emplace_back(name->string, parseJson(text));
+                delete name;
+            }
+            else
+            {
+                value->items.push_back(parseJson(text));
+            }
+            while (*text && (isspace(static_cast<unsigned char>(*text)) || *text == ','))
+            {
+                text++;
+            }
+        }
+        text += *text ? 1 : 0;
+    }
+    else if (*text == '"')
+    {
+        const char * end = strchr(text + 1, '"');
+        value->string.assign(text + 1, end);
+        text = end + 1;
+    }
+    else
+    {
+        char * end;
+        value->number = strtod(text, &end);
+        text          = end;
+    }
+    return value;
+}
+
+/**
+ * @brief Boots a bridge from JSON: parses the document, then builds every accessory it describes.
+ */
+static size_t bootFromJson(const std::string & json, AccessoryRegistry & registry, RelayModuleInterface * const * relays,
+                           ButtonModuleInterface * const * buttons)
+{
+    static const char * const TYPES[] = { "light", "fan", "switch", "plugin", "doorLock", "blind" };
+    const char * text                 = json.c_str();
+    std::unique_ptr<JsonValue> document(parseJson(text));
+    size_t built = 0;
+    for (const JsonValue * accessory : document->items)
+    {
+        const std::string & type        = accessory->get("type")->string;
+        uint16_t endpointId             = static_cast<uint16_t>(accessory->get("endpoint")->number);
+        RelayModuleInterface * a        = relays[accessory->index("relay", "relays", 0)];
+        BaseAccessoryInterface * result = nullptr;
+        if (type == TYPES[0])
+        {
+            result = registry.emplace<LightAccessory>(endpointId, a, nullptr);
+        }
+        else if (type == TYPES[1])
+        {
+            result = registry.emplace<FanAccessory>(endpointId, a, nullptr);
+        }
+        else if (type == TYPES[2])
+        {
+            result = registry.emplace<SwitchAccessory>(endpointId, a, nullptr);
+        }
+        else if (type == TYPES[3])
+        {
+            result = registry.emplace<PluginAccessory>(endpointId, a, nullptr);
+        }
+        else if (type == TYPES[4])
+        {
+            result = registry.emplace<DoorLockAccessory>(endpointId, a, buttons[accessory->index("button", "buttons", 0)],
+                                                         static_cast<uint8_t>(accessory->get("openDuration")->number));
+        }
+        else if (type == TYPES[5])
+        {
+            result = registry.emplace<BlindAccessory>(
+                endpointId, a, relays[accessory->index("relay", "relays", 1)], buttons[accessory->index("button", "buttons", 0)],
+                buttons[accessory->index("button", "buttons", 1)], static_cast<uint8_t>(accessory->get("timeToOpen")->number),
+                static_cast<uint8_t>(accessory->get("timeToClose")->number));
+        }
+        built += result ? 1 : 0;
+    }
+    return built;
+}
+
+static void countReports(void * counter, bool onlySave)
+{
+    (void) onlySave;
+    (*static_cast<uint32_t *>(counter))++;
+}
+
+int main(int argc, char ** argv)
+{
+    uint32_t iterations      = 100000;
+    const char * configJson  = nullptr;
+    const char * configImage = nullptr;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+        {
+            iterations = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        }
+        else if (strcmp(argv[i], "--config") == 0 && i + 2 < argc)
+        {
+            configJson  = argv[++i];
+            configImage = argv[++i];
+        }
+    }
+    esp_log_level_set("*", ESP_LOG_NONE);
+
+    printf("%-32s %10s %12s\n", "operation", "iterations", "ns/op");
+
+    FakeRelayModule relay;
+    FakeButtonModule button;
+    FakeRelayModule motorUp;
+    FakeRelayModule motorDown;
+    FakeButtonModule buttonUp;
+    FakeButtonModule buttonDown;
+
+    benchmark("LightAccessory construction", iterations, [&](uint32_t) { LightAccessory light(&relay, &button); });
+
+    benchmark("BlindAccessory construction", iterations / 10,
+              [&](uint32_t) { BlindAccessory blind(&motorUp, &motorDown, &buttonUp, &buttonDown); });
+
+    // The same board built with new, and into one AccessoryDevice.
+    FakeRelayModule boardRelays[4];
+    FakeButtonModule boardButtons[4];
+    RelayModuleInterface * const boardRelayTable[]   = { &boardRelays[0], &boardRelays[1], &boardRelays[2], &boardRelays[3] };
+    ButtonModuleInterface * const boardButtonTable[] = { &boardButtons[0], &boardButtons[1], &boardButtons[2], &boardButtons[3] };
+    benchmark("4 accessory board with new", iterations / 10, [&](uint32_t) {
+        BaseAccessoryInterface * board[] = { new LightAccessory(&boardRelays[0], &boardButtons[0]),
+                                             new LightAccessory(&boardRelays[1], &boardButtons[1]),
+                                             new FanAccessory(&boardRelays[2], &boardButtons[2]),
+                                             new DoorLockAccessory(&boardRelays[3], &boardButtons[3], 5) };
+        for (BaseAccessoryInterface * accessory : board)
+        {
+            delete accessory;
+        }
+    });
+    benchmark("4 accessory AccessoryDevice", iterations / 10,
+              [&](uint32_t) { AccessoryDevice<BENCHMARK_BOARD> device(boardRelayTable, boardButtonTable); });
+    printf("AccessoryDevice: %zu bytes for %zu accessories\n", sizeof(AccessoryDevice<BENCHMARK_BOARD>),
+           AccessoryDevice<BENCHMARK_BOARD>::size());
+
+    LightAccessory light(&relay, &button);
+    uint32_t reports = 0;
+    light.setReportCallback(countReports, &reports);
+
+    benchmark("setPowerState", iterations, [&](uint32_t i) { light.setPowerState(i & 1); });
+
+    // The same call through the abstract interface, and on the accessory without one.
+    LightAccessoryInterface * volatile lightInterface = &light;
+    benchmark("setPowerState via interface", iterations, [&](uint32_t i) { lightInterface->setPowerState(i & 1); });
+
+    FakeRelayModule staticRelay;
+    StaticRelayToggleAccessory<LightAccessoryTraits> staticLight(&staticRelay, nullptr);
+    benchmark("static setPower", iterations, [&](uint32_t i) { staticLight.setPower(i & 1); });
+
+    benchmark("button toggle with report", iterations, [&](uint32_t) { button.singlePress(); });
+
+    benchmark("identify start/stop", iterations, [&](uint32_t) {
+        light.identify();
+        light.stopIdentify();
+    });
+
+    BlindAccessory blind(&motorUp, &motorDown, &buttonUp, &buttonDown);
+    blind.setTravelTime(60000, 60000);
+    benchmark("moveBlindTo retarget", iterations, [&](uint32_t i) { blind.moveBlindTo(i & 1 ? 80 : 20); });
+
+    // A consistent snapshot read from the application task, while the motion callback publishes.
+    volatile int32_t velocity = 0;
+    benchmark("getMotionSnapshot", iterations, [&](uint32_t) { velocity = blind.getMotionSnapshot().velocity; });
+
+    FakeRelayModule doorRelay;
+    FakeButtonModule doorButton;
+    DoorLockAccessory door(&doorRelay, &doorButton, 60);
+    door.setState(DoorLockAccessoryInterface::DoorLockState::UNLOCKED);
+    benchmark("door unlock re-trigger", iterations,
+              [&](uint32_t) { door.setState(DoorLockAccessoryInterface::DoorLockState::UNLOCKED); });
+
+    AccessoryStateRecord record = {};
+    record.accessoryType        = static_cast<uint8_t>(AccessoryType::Light);
+    benchmark("restore", iterations, [&](uint32_t i) {
+        record.flags = i & 1 ? AccessoryStateRecord::FLAG_POWER_ON : 0;
+        light.restore(record);
+    });
+
+    // An "all on" / "all off" scene on a 16 relay board, against the same changes made with the setters.
+    static constexpr int SCENE_SIZE = 16;
+    FakeRelayModule sceneRelays[SCENE_SIZE];
+    LightAccessory * sceneLights[SCENE_SIZE];
+    SceneExecutor::Entry sceneOn[SCENE_SIZE];
+    SceneExecutor::Entry sceneOff[SCENE_SIZE];
+    for (int i = 0; i < SCENE_SIZE; i++)
+    {
+        sceneLights[i]          = new LightAccessory(&sceneRelays[i], nullptr);
+        sceneOn[i].accessory    = sceneLights[i];
+        sceneOn[i].state        = record;
+        sceneOn[i].state.flags  = AccessoryStateRecord::FLAG_POWER_ON;
+        sceneOff[i]             = sceneOn[i];
+        sceneOff[i].state.flags = 0;
+    }
+    benchmark("16 setPowerState calls", iterations / 10, [&](uint32_t i) {
+        for (int j = 0; j < SCENE_SIZE; j++)
+        {
+            sceneLights[j]->setPowerState(i & 1);
+        }
+    });
+    SceneExecutor executor(nullptr, 0);
+    executor.setReportCallback([](const SceneExecutor::Report &, void * counter) { (*static_cast<uint32_t *>(counter))++; },
+                               &reports);
+    benchmark("16 light scene activation", iterations / 10,
+              [&](uint32_t i) { executor.activate(i & 1 ? sceneOn : sceneOff, SCENE_SIZE); });
+    for (int i = 0; i < SCENE_SIZE; i++)
+    {
+        delete sceneLights[i];
+    }
+
+    // A 256 endpoint bridge, with the accessories on the heap behind a std::map and in an AccessoryRegistry.
+    static constexpr int BRIDGE_SIZE = 256;
+    std::unique_ptr<FakeRelayModule[]> bridgeRelays(new FakeRelayModule[2 * BRIDGE_SIZE]);
+    std::unique_ptr<FakeButtonModule[]> bridgeButtons(new FakeButtonModule[2 * BRIDGE_SIZE]);
+    std::unique_ptr<RelayModuleInterface *[]> bridgeRelayTable(new RelayModuleInterface *[2 * BRIDGE_SIZE]);
+    std::unique_ptr<ButtonModuleInterface *[]> bridgeButtonTable(new ButtonModuleInterface *[2 * BRIDGE_SIZE]);
+    for (int i = 0; i < 2 * BRIDGE_SIZE; i++)
+    {
+        bridgeRelayTable[i]  = &bridgeRelays[i];
+        bridgeButtonTable[i] = &bridgeButtons[i];
+    }
+    std::map<uint16_t, BaseAccessoryInterface *> bridgeMap;
+    std::unique_ptr<AccessoryRegistry> registry(new AccessoryRegistry());
+    for (int i = 0; i < BRIDGE_SIZE; i++)
+    {
+        uint16_t endpointId = static_cast<uint16_t>(i + 1);
+        FakeRelayModule * a = &bridgeRelays[2 * i];
+        FakeRelayModule * b = &bridgeRelays[2 * i + 1];
+        FakeButtonModule * c = &bridgeButtons[2 * i];
+        FakeButtonModule * d = &bridgeButtons[2 * i + 1];
+        switch (i % 8)
+        {
+        case 0:
+        case 1:
+            bridgeMap[endpointId] = new LightAccessory(a, nullptr);
+            registry->emplace<LightAccessory>(endpointId, a, nullptr);
+            break;
+        case 2:
+            bridgeMap[endpointId] = new FanAccessory(a, nullptr);
+            registry->emplace<FanAccessory>(endpointId, a, nullptr);
+            break;
+        case 3:
+            bridgeMap[endpointId] = new SwitchAccessory(a, nullptr);
+            registry->emplace<SwitchAccessory>(endpointId, a, nullptr);
+            break;
+        case 4:
+        case 5:
+            bridgeMap[endpointId] = new PluginAccessory(a, nullptr);
+            registry->emplace<PluginAccessory>(endpointId, a, nullptr);
+            break;
+        case 6:
+            bridgeMap[endpointId] = new DoorLockAccessory(a, c, 5);
+            registry->emplace<DoorLockAccessory>(endpointId, a, c, 5);
+            break;
+        default:
+            bridgeMap[endpointId] = new BlindAccessory(a, b, c, d);
+            registry->emplace<BlindAccessory>(endpointId, a, b, c, d);
+            break;
+        }
+    }
+
+    if (registry->size() != BRIDGE_SIZE)
+    {
+        fprintf(stderr, "registry holds %zu of %d accessories\n", registry->size(), BRIDGE_SIZE);
+        return 1;
+    }
+
+    volatile uintptr_t sink = 0;
+    AccessoryStateRecord bridgeStates[BRIDGE_SIZE];
+    benchmark("map find, 256 endpoints", iterations,
+              [&](uint32_t i) { sink = uintptr_t(bridgeMap.find(static_cast<uint16_t>(i * 97 % BRIDGE_SIZE + 1))->second); });
+    benchmark("registry find, 256 endpoints", iterations,
+              [&](uint32_t i) { sink = uintptr_t(registry->find(static_cast<uint16_t>(i * 97 % BRIDGE_SIZE + 1))); });
+    benchmark("map snapshot, 256 endpoints", iterations / 100, [&](uint32_t) {
+        size_t count = 0;
+        for (auto & entry : bridgeMap)
+        {
+            count += entry.second->getState(bridgeStates[count]) ? 1 : 0;
+        }
+        sink = count;
+    });
+    benchmark("registry snapshotAll, 256", iterations / 100,
+              [&](uint32_t) { sink = registry->snapshotAll(bridgeStates, BRIDGE_SIZE); });
+    printf("registry arena: %zu bytes for %zu accessories\n", registry->getArenaUsed(), registry->size());
+    for (auto & entry : bridgeMap)
+    {
+        delete entry.second;
+    }
+
+    // Boot of the same bridge from a JSON document read into RAM, and from its binary image mapped in place.
+    if (configJson && configImage)
+    {
+        auto readJson = [&]() {
+            FILE * file = fopen(configJson, "rb");
+            std::string json;
+            char buffer[1024];
+            for (size_t length; (length = fread(buffer, 1, sizeof(buffer), file)) > 0;)
+            {
+                json.append(buffer, length);
+            }
+            fclose(file);
+            return json;
+        };
+        benchmark("JSON read and parse", iterations / 100, [&](uint32_t) {
+            std::string json  = readJson();
+            const char * text = json.c_str();
+            delete parseJson(text);
+        });
+        benchmark("image map and check", iterations / 100, [&](uint32_t) {
+            AccessoryConfigFile image(configImage);
+            sink = AccessoryConfig(image.getData(), image.getSize()).size();
+        });
+
+        size_t jsonBuilt  = 0;
+        size_t imageBuilt = 0;
+        benchmark("boot from JSON", iterations / 100, [&](uint32_t) {
+            std::string json = readJson();
+            registry.reset();
+            registry.reset(new AccessoryRegistry());
+            jsonBuilt = bootFromJson(json, *registry, bridgeRelayTable.get(), bridgeButtonTable.get());
+        });
+        benchmark("boot from mapped image", iterations / 100, [&](uint32_t) {
+            AccessoryConfigFile image(configImage);
+            AccessoryConfig config(image.getData(), image.getSize());
+            registry.reset();
+            registry.reset(new AccessoryRegistry());
+            imageBuilt = config.build(*registry, bridgeRelayTable.get(), 2 * BRIDGE_SIZE, bridgeButtonTable.get(), 2 * BRIDGE_SIZE);
+        });
+        printf("boot: %zu accessories from JSON, %zu from the image\n", jsonBuilt, imageBuilt);
+        if (jsonBuilt == 0 || jsonBuilt != imageBuilt || registry->size() != imageBuilt)
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
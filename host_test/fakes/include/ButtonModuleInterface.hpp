@@ -0,0 +1,39 @@
+#pragma once
+
+/**
+ * @brief Host stand-in for the button interface of the relaybuttonmodule component.
+ */
+class ButtonModuleInterface
+{
+public:
+    /**
+     * @brief Type definition for the press callbacks.
+     */
+    using ButtonCallback = void (*)(void *);
+
+    virtual ~ButtonModuleInterface() = default;
+
+    /**
+     * @brief Sets the callback invoked on a single press.
+     *
+     * @param callback The callback function.
+     * @param callbackParam Parameter passed to the callback function.
+     */
+    virtual void setSinglePressCallback(ButtonCallback callback, void * callbackParam = nullptr) = 0;
+
+    /**
+     * @brief Sets the callback invoked on a double press.
+     *
+     * @param callback The callback function.
+     * @param callbackParam Parameter passed to the callback function.
+     */
+    virtual void setDoublePressCallback(ButtonCallback callback, void * callbackParam = nullptr) = 0;
+
+    /**
+     * @brief Sets the callback invoked on a long press.
+     *
+     * @param callback The callback function.
+     * @param callbackParam Parameter passed to the callback function.
+     */
+    virtual void setLongPressCallback(ButtonCallback callback, void * callbackParam = nullptr) = 0;
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "ButtonModuleInterface.hpp"
+
+/**
+ * @brief In-memory button whose presses are triggered by the test.
+ */
+class FakeButtonModule : public ButtonModuleInterface
+{
+public:
+    /**
+     * @brief Constructor for FakeButtonModule.
+     */
+    FakeButtonModule();
+
+    void setSinglePressCallback(ButtonCallback callback, void * callbackParam = nullptr) override;
+    void setDoublePressCallback(ButtonCallback callback, void * callbackParam = nullptr) override;
+    void setLongPressCallback(ButtonCallback callback, void * callbackParam = nullptr) override;
+
+    /**
+     * @brief Invokes the single press callback in the calling thread.
+     */
+    void singlePress();
+
+    /**
+     * @brief Invokes the double press callback in the calling thread.
+     */
+    void doublePress();
+
+    /**
+     * @brief Invokes the long press callback in the calling thread.
+     */
+    void longPress();
+
+private:
+    ButtonCallback m_singlePressCallback; ///< Callback of a single press.
+    void * m_singlePressParam;            ///< Parameter of the single press callback.
+    ButtonCallback m_doublePressCallback; ///< Callback of a double press.
+    void * m_doublePressParam;            ///< Parameter of the double press callback.
+    ButtonCallback m_longPressCallback;   ///< Callback of a long press.
+    void * m_longPressParam;              ///< Parameter of the long press callback.
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+#include "RelayModuleInterface.hpp"
+
+/**
+ * @brief In-memory relay that records how often it was switched.
+ */
+class FakeRelayModule : public RelayModuleInterface
+{
+public:
+    /**
+     * @brief Constructor for FakeRelayModule.
+     *
+     * @param initialPower Initial relay state.
+     */
+    FakeRelayModule(bool initialPower = false);
+
+    /**
+     * @brief Switches the relay and counts the call.
+     *
+     * @param power True to switch the relay on, false to switch it off.
+     */
+    void setPower(bool power) override;
+
+    /**
+     * @brief Gets the relay state.
+     *
+     * @return True if the relay is on.
+     */
+    bool isOn() override;
+
+    /**
+     * @brief Gets the number of setPower() calls.
+     *
+     * @return The number of calls since construction.
+     */
+    uint32_t getSetPowerCount() const;
+
+private:
+    std::atomic<bool> m_power;             ///< Current relay state.
+    std::atomic<uint32_t> m_setPowerCount; ///< Number of setPower() calls.
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+/**
+ * @brief Host stand-in for the relay interface of the relaybuttonmodule component.
+ */
+class RelayModuleInterface
+{
+public:
+    virtual ~RelayModuleInterface() = default;
+
+    /**
+     * @brief Switches the relay.
+     *
+     * @param power True to switch the relay on, false to switch it off.
+     */
+    virtual void setPower(bool power) = 0;
+
+    /**
+     * @brief Gets the relay state.
+     *
+     * @return True if the relay is on.
+     */
+    virtual bool isOn() = 0;
+};
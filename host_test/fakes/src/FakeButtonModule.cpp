@@ -0,0 +1,49 @@
+#include "FakeButtonModule.hpp"
+
+FakeButtonModule::FakeButtonModule() :
+    m_singlePressCallback(nullptr), m_singlePressParam(nullptr), m_doublePressCallback(nullptr), m_doublePressParam(nullptr),
+    m_longPressCallback(nullptr), m_longPressParam(nullptr)
+{
+}
+
+void FakeButtonModule::setSinglePressCallback(ButtonCallback callback, void * callbackParam)
+{
+    m_singlePressCallback = callback;
+    m_singlePressParam    = callbackParam;
+}
+
+void FakeButtonModule::setDoublePressCallback(ButtonCallback callback, void * callbackParam)
+{
+    m_doublePressCallback = callback;
+    m_doublePressParam    = callbackParam;
+}
+
+void FakeButtonModule::setLongPressCallback(ButtonCallback callback, void * callbackParam)
+{
+    m_longPressCallback = callback;
+    m_longPressParam    = callbackParam;
+}
+
+void FakeButtonModule::singlePress()
+{
+    if (m_singlePressCallback)
+    {
+        m_singlePressCallback(m_singlePressParam);
+    }
+}
+
+void FakeButtonModule::doublePress()
+{
+    if (m_doublePressCallback)
+    {
+        m_doublePressCallback(m_doublePressParam);
+    }
+}
+
+void FakeButtonModule::longPress()
+{
+    if (m_longPressCallback)
+    {
+        m_longPressCallback(m_longPressParam);
+    }
+}
@@ -0,0 +1,19 @@
+#include "FakeRelayModule.hpp"
+
+FakeRelayModule::FakeRelayModule(bool initialPower) : m_power(initialPower), m_setPowerCount(0) {}
+
+void FakeRelayModule::setPower(bool power)
+{
+    m_power.store(power);
+    m_setPowerCount.fetch_add(1);
+}
+
+bool FakeRelayModule::isOn()
+{
+    return m_power.load();
+}
+
+uint32_t FakeRelayModule::getSetPowerCount() const
+{
+    return m_setPowerCount.load();
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+/**
+ * @brief Places a variable in RTC slow memory that survives warm restarts. On the host a plain static is kept for the
+ * whole process, which is enough to simulate a restart by constructing the accessories again.
+ */
+#define RTC_NOINIT_ATTR
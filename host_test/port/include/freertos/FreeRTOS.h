@@ -0,0 +1,56 @@
+#pragma once
+
+/*
+ * Subset of the FreeRTOS API used by AccessoryModule, implemented over std::thread for host builds.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <sdkconfig.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint8_t StackType_t;
+
+#define portTICK_PERIOD_MS ((TickType_t) (1000 / CONFIG_FREERTOS_HZ))
+#define portMAX_DELAY ((TickType_t) 0xffffffffUL)
+#define pdMS_TO_TICKS(ms) ((TickType_t) ((ms) / portTICK_PERIOD_MS))
+#define pdFALSE ((BaseType_t) 0)
+#define pdTRUE ((BaseType_t) 1)
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+#define tskNO_AFFINITY ((BaseType_t) 0x7FFFFFFF)
+
+/**
+ * @brief Storage of a statically created task. Unused on the host, tasks always run on their own thread.
+ */
+typedef struct
+{
+    uint8_t reserved;
+} StaticTask_t;
+
+/**
+ * @brief Spinlock of a critical section. All critical sections share one recursive mutex on the host.
+ */
+typedef struct
+{
+    uint32_t owner;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void vPortEnterCritical(portMUX_TYPE * mux);
+void vPortExitCritical(portMUX_TYPE * mux);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define portENTER_CRITICAL(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL(mux) vPortExitCritical(mux)
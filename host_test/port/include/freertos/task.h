@@ -0,0 +1,35 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+typedef struct tskTaskControlBlock * TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t taskCode, const char * name, uint32_t stackDepth, void * parameters,
+                                   UBaseType_t priority, TaskHandle_t * createdTask, BaseType_t coreId);
+
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t taskCode, const char * name, uint32_t stackDepth, void * parameters,
+                                           UBaseType_t priority, StackType_t * stackBuffer, StaticTask_t * taskBuffer,
+                                           BaseType_t coreId);
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+
+void vTaskDelay(TickType_t ticksToDelay);
+
+BaseType_t xTaskNotifyGive(TaskHandle_t taskToNotify);
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait);
+
+/* Host threads have no painted stack: the high water mark is the stack size given at creation. */
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+
+/* Always nullptr on the host, the stack of a thread cannot be inspected. */
+uint8_t * pxTaskGetStackStart(TaskHandle_t task);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,107 @@
+#pragma once
+
+/*
+ * Host configuration of AccessoryModule, mirroring the Kconfig.projbuild defaults. Targets that need larger limits
+ * raise them in CMakeLists.txt.
+ * Any option can be overridden from CMake, for example -DCONFIG_A_M_TRACE_BACKEND_BINARY=1.
+ */
+
+#ifndef CONFIG_FREERTOS_HZ
+#define CONFIG_FREERTOS_HZ 1000
+#endif
+
+#ifndef CONFIG_A_M_TIMER_SERVICE_STACK_SIZE
+#define CONFIG_A_M_TIMER_SERVICE_STACK_SIZE 4096
+#endif
+#ifndef CONFIG_A_M_TIMER_SERVICE_PRIORITY
+#define CONFIG_A_M_TIMER_SERVICE_PRIORITY 5
+#endif
+#ifndef CONFIG_A_M_TIMER_SERVICE_CORE_ID
+#define CONFIG_A_M_TIMER_SERVICE_CORE_ID -1
+#endif
+#ifndef CONFIG_A_M_TIMER_SERVICE_MAX_TIMERS
+#define CONFIG_A_M_TIMER_SERVICE_MAX_TIMERS 128
+#endif
+
+#if CONFIG_A_M_EVENT_DISPATCHER_ENABLE
+#ifndef CONFIG_A_M_EVENT_DISPATCHER_QUEUE_SIZE
+#define CONFIG_A_M_EVENT_DISPATCHER_QUEUE_SIZE 32
+#endif
+#ifndef CONFIG_A_M_EVENT_DISPATCHER_STACK_SIZE
+#define CONFIG_A_M_EVENT_DISPATCHER_STACK_SIZE 4096
+#endif
+#ifndef CONFIG_A_M_EVENT_DISPATCHER_PRIORITY
+#define CONFIG_A_M_EVENT_DISPATCHER_PRIORITY 4
+#endif
+#endif
+
+#if !CONFIG_A_M_TRACE_BACKEND_BINARY && !CONFIG_A_M_TRACE_BACKEND_NONE
+#define CONFIG_A_M_TRACE_BACKEND_TEXT 1
+#endif
+#if CONFIG_A_M_TRACE_BACKEND_BINARY && !defined(CONFIG_A_M_TRACE_BUFFER_RECORDS)
+#define CONFIG_A_M_TRACE_BUFFER_RECORDS 256
+#endif
+
+#if CONFIG_A_M_TASK_TELEMETRY && !defined(CONFIG_A_M_TASK_TELEMETRY_STACK_MARGIN)
+#define CONFIG_A_M_TASK_TELEMETRY_STACK_MARGIN 512
+#endif
+
+#ifndef CONFIG_A_M_STATE_STORE_MAX_RECORDS
+#define CONFIG_A_M_STATE_STORE_MAX_RECORDS 32
+#endif
+#ifndef CONFIG_A_M_STATE_STORE_DEBOUNCE_MS
+#define CONFIG_A_M_STATE_STORE_DEBOUNCE_MS 2000
+#endif
+
+#ifndef CONFIG_A_M_RETAINED_STATE
+#define CONFIG_A_M_RETAINED_STATE 1
+#endif
+#if CONFIG_A_M_RETAINED_STATE && !defined(CONFIG_A_M_RETAINED_STATE_MAX_RECORDS)
+#define CONFIG_A_M_RETAINED_STATE_MAX_RECORDS 16
+#endif
+
+#ifndef CONFIG_A_M_BLIND_ACCESSORY_REPORT_STEP_PERCENT
+#define CONFIG_A_M_BLIND_ACCESSORY_REPORT_STEP_PERCENT 10
+#endif
+#ifndef CONFIG_A_M_BLIND_ACCESSORY_REPORT_INTERVAL_MS
+#define CONFIG_A_M_BLIND_ACCESSORY_REPORT_INTERVAL_MS 0
+#endif
+
+#ifndef CONFIG_A_M_STATELESS_BUTTON_QUEUE_SIZE
+#define CONFIG_A_M_STATELESS_BUTTON_QUEUE_SIZE 8
+#endif
+#ifndef CONFIG_A_M_PRESS_DECODER_DEBOUNCE_MS
+#define CONFIG_A_M_PRESS_DECODER_DEBOUNCE_MS 20
+#endif
+#ifndef CONFIG_A_M_PRESS_DECODER_GAP_MS
+#define CONFIG_A_M_PRESS_DECODER_GAP_MS 300
+#endif
+#ifndef CONFIG_A_M_PRESS_DECODER_LONG_PRESS_MS
+#define CONFIG_A_M_PRESS_DECODER_LONG_PRESS_MS 800
+#endif
+#ifndef CONFIG_A_M_PRESS_DECODER_REPEAT_MS
+#define CONFIG_A_M_PRESS_DECODER_REPEAT_MS 250
+#endif
+#ifndef CONFIG_A_M_PRESS_DECODER_MAX_PRESSES
+#define CONFIG_A_M_PRESS_DECODER_MAX_PRESSES 3
+#endif
+
+#ifndef CONFIG_A_M_SCENE_MAX_ENTRIES
+#define CONFIG_A_M_SCENE_MAX_ENTRIES 32
+#endif
+#ifndef CONFIG_A_M_SCENE_MAX_PRESETS
+#define CONFIG_A_M_SCENE_MAX_PRESETS 8
+#endif
+#ifndef CONFIG_A_M_SCENE_PRESET_ENTRIES
+#define CONFIG_A_M_SCENE_PRESET_ENTRIES 64
+#endif
+#ifndef CONFIG_A_M_SCENE_BUDGET_US
+#define CONFIG_A_M_SCENE_BUDGET_US 2000
+#endif
+
+#ifndef CONFIG_A_M_REGISTRY_MAX_ACCESSORIES
+#define CONFIG_A_M_REGISTRY_MAX_ACCESSORIES 48
+#endif
+#ifndef CONFIG_A_M_REGISTRY_ARENA_SIZE
+#define CONFIG_A_M_REGISTRY_ARENA_SIZE 12288
+#endif
@@ -0,0 +1,35 @@
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#include <atomic>
+#include <stdarg.h>
+#include <stdio.h>
+
+static std::atomic<esp_log_level_t> s_logLevel(ESP_LOG_WARN);
+
+extern "C" void esp_log_level_set(const char * tag, esp_log_level_t level)
+{
+    (void) tag;
+    s_logLevel.store(level);
+}
+
+extern "C" esp_log_level_t esp_log_level_get(const char * tag)
+{
+    (void) tag;
+    return s_logLevel.load(std::memory_order_relaxed);
+}
+
+extern "C" uint32_t esp_log_timestamp(void)
+{
+    return static_cast<uint32_t>(esp_timer_get_time() / 1000);
+}
+
+extern "C" void esp_log_write(esp_log_level_t level, const char * tag, const char * format, ...)
+{
+    (void) level;
+    (void) tag;
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+}
@@ -0,0 +1,16 @@
+#include <esp_rtc_time.h>
+#include <esp_timer.h>
+
+#include <chrono>
+
+static const std::chrono::steady_clock::time_point s_startTime = std::chrono::steady_clock::now();
+
+extern "C" int64_t esp_timer_get_time(void)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - s_startTime).count();
+}
+
+extern "C" uint64_t esp_rtc_get_time_us(void)
+{
+    return static_cast<uint64_t>(esp_timer_get_time());
+}
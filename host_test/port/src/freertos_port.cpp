@@ -0,0 +1,141 @@
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief Host task: a detached thread with a notification counter.
+ */
+struct tskTaskControlBlock
+{
+    std::mutex mutex;                 ///< Protects the fields below.
+    std::condition_variable notified; ///< Signalled when notificationCount is incremented or the task may start.
+    uint32_t notificationCount;       ///< Pending direct-to-task notifications.
+    uint32_t stackDepth;              ///< Stack size requested at creation.
+    bool started;                     ///< Set once the creator has stored the task handle.
+};
+
+static thread_local TaskHandle_t s_currentTask = nullptr;
+static std::recursive_mutex s_criticalSection;
+
+static TaskHandle_t createTask(TaskFunction_t taskCode, uint32_t stackDepth, void * parameters, TaskHandle_t * createdTask)
+{
+    TaskHandle_t task       = new tskTaskControlBlock();
+    task->notificationCount = 0;
+    task->stackDepth        = stackDepth;
+    task->started           = false;
+
+    std::thread([task, taskCode, parameters]() {
+        {
+            // Like a lower priority FreeRTOS task, do not run before the creator has stored the handle.
+            std::unique_lock<std::mutex> lock(task->mutex);
+            task->notified.wait(lock, [task]() { return task->started; });
+        }
+        s_currentTask = task;
+        taskCode(parameters);
+    }).detach();
+
+    if (createdTask)
+    {
+        *createdTask = task;
+    }
+    {
+        std::lock_guard<std::mutex> lock(task->mutex);
+        task->started = true;
+    }
+    task->notified.notify_all();
+    return task;
+}
+
+extern "C" void vPortEnterCritical(portMUX_TYPE * mux)
+{
+    (void) mux;
+    s_criticalSection.lock();
+}
+
+extern "C" void vPortExitCritical(portMUX_TYPE * mux)
+{
+    (void) mux;
+    s_criticalSection.unlock();
+}
+
+extern "C" BaseType_t xTaskCreatePinnedToCore(TaskFunction_t taskCode, const char * name, uint32_t stackDepth, void * parameters,
+                                              UBaseType_t priority, TaskHandle_t * createdTask, BaseType_t coreId)
+{
+    (void) name;
+    (void) priority;
+    (void) coreId;
+    createTask(taskCode, stackDepth, parameters, createdTask);
+    return pdPASS;
+}
+
+extern "C" TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t taskCode, const char * name, uint32_t stackDepth,
+                                                      void * parameters, UBaseType_t priority, StackType_t * stackBuffer,
+                                                      StaticTask_t * taskBuffer, BaseType_t coreId)
+{
+    (void) name;
+    (void) priority;
+    (void) stackBuffer;
+    (void) taskBuffer;
+    (void) coreId;
+    TaskHandle_t task = nullptr;
+    createTask(taskCode, stackDepth, parameters, &task);
+    return task;
+}
+
+extern "C" TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return s_currentTask;
+}
+
+extern "C" void vTaskDelay(TickType_t ticksToDelay)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticksToDelay * portTICK_PERIOD_MS));
+}
+
+extern "C" BaseType_t xTaskNotifyGive(TaskHandle_t taskToNotify)
+{
+    {
+        std::lock_guard<std::mutex> lock(taskToNotify->mutex);
+        taskToNotify->notificationCount++;
+    }
+    taskToNotify->notified.notify_one();
+    return pdPASS;
+}
+
+extern "C" uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait)
+{
+    TaskHandle_t task = s_currentTask;
+    std::unique_lock<std::mutex> lock(task->mutex);
+    auto hasNotification = [task]() { return task->notificationCount > 0; };
+    if (ticksToWait == portMAX_DELAY)
+    {
+        task->notified.wait(lock, hasNotification);
+    }
+    else
+    {
+        task->notified.wait_for(lock, std::chrono::milliseconds(ticksToWait * portTICK_PERIOD_MS), hasNotification);
+    }
+
+    uint32_t count = task->notificationCount;
+    if (count > 0)
+    {
+        task->notificationCount = clearCountOnExit ? 0 : count - 1;
+    }
+    return count;
+}
+
+extern "C" UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+    task = task ? task : s_currentTask;
+    return task ? task->stackDepth : 0;
+}
+
+extern "C" uint8_t * pxTaskGetStackStart(TaskHandle_t task)
+{
+    (void) task;
+    return nullptr;
+}
@@ -0,0 +1,446 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include <esp_log.h>
+
+#include <AccessoryClock.hpp>
+#include <AccessoryTimerService.hpp>
+#include <BlindAccessory.hpp>
+#include <DoorLockAccessory.hpp>
+#include <LightAccessory.hpp>
+#include <StatelessButtonAccessory.hpp>
+
+#include "FakeButtonModule.hpp"
+#include "FakeRelayModule.hpp"
+
+/**
+ * @brief Button press or application command applied to one accessory at a virtual time.
+ */
+struct Command
+{
+    int64_t timeMs;       ///< Virtual time in milliseconds.
+    uint16_t accessoryId; ///< Target accessory, numbered from 1 in household order.
+    std::string op;       ///< press, double, long, power, move, lock, unlock, identify or stop-identify.
+    int32_t arg;          ///< Argument of power (0/1), move (percent) and blind press (1 up, 0 down).
+};
+
+/**
+ * @brief Report delivered to the application, stamped with the virtual time.
+ */
+struct Report
+{
+    int64_t timeUs;       ///< Virtual time in microseconds.
+    AccessoryEvent event; ///< The delivered event.
+};
+
+/**
+ * @brief Lights, blinds, door locks and stateless buttons wired to fake drivers.
+ */
+class Household
+{
+public:
+    Household(size_t lights, size_t blinds, size_t doors, size_t buttons)
+    {
+        for (size_t i = 0; i < lights; i++)
+        {
+            FakeRelayModule * relay   = addRelay();
+            FakeButtonModule * button = addButton();
+            m_lights.emplace_back(new LightAccessory(relay, button));
+            registerAccessory(m_lights.back().get(), { Kind::Light, m_lights.size() - 1, button, nullptr });
+        }
+        for (size_t i = 0; i < blinds; i++)
+        {
+            FakeRelayModule * up     = addRelay();
+            FakeRelayModule * down   = addRelay();
+            FakeButtonModule * bUp   = addButton();
+            FakeButtonModule * bDown = addButton();
+            m_blinds.emplace_back(new BlindAccessory(up, down, bUp, bDown));
+            registerAccessory(m_blinds.back().get(), { Kind::Blind, m_blinds.size() - 1, bUp, bDown });
+        }
+        for (size_t i = 0; i < doors; i++)
+        {
+            FakeRelayModule * relay   = addRelay();
+            FakeButtonModule * button = addButton();
+            m_doors.emplace_back(new DoorLockAccessory(relay, button));
+            registerAccessory(m_doors.back().get(), { Kind::Door, m_doors.size() - 1, button, nullptr });
+        }
+        for (size_t i = 0; i < buttons; i++)
+        {
+            FakeButtonModule * button = addButton();
+            m_buttons.emplace_back(new StatelessButtonAccessory(button));
+            registerAccessory(m_buttons.back().get(), { Kind::Button, m_buttons.size() - 1, button, nullptr });
+        }
+    }
+
+    size_t size() const { return m_entries.size(); }
+
+    /**
+     * @brief Applies a command. Unknown commands for an accessory kind are ignored.
+     */
+    void apply(const Command & command)
+    {
+        if (command.accessoryId == 0 || command.accessoryId > m_entries.size())
+        {
+            return;
+        }
+        const Entry & entry = m_entries[command.accessoryId - 1];
+        const std::string & op = command.op;
+
+        if (op == "press")
+        {
+            (entry.kind == Kind::Blind && command.arg == 0 ? entry.secondButton : entry.button)->singlePress();
+        }
+        else if (op == "double")
+        {
+            entry.button->doublePress();
+        }
+        else if (op == "long")
+        {
+            entry.button->longPress();
+        }
+        else if (op == "power" && entry.kind == Kind::Light)
+        {
+            m_lights[entry.index]->setPowerState(command.arg != 0);
+        }
+        else if (op == "move" && entry.kind == Kind::Blind)
+        {
+            m_blinds[entry.index]->moveBlindTo(static_cast<uint8_t>(command.arg));
+        }
+        else if ((op == "lock" || op == "unlock") && entry.kind == Kind::Door)
+        {
+            m_doors[entry.index]->setState(op == "lock" ? DoorLockAccessoryInterface::DoorLockState::LOCKED
+                                                        : DoorLockAccessoryInterface::DoorLockState::UNLOCKED);
+        }
+        else if (op == "identify")
+        {
+            entry.accessory->identify();
+        }
+        else if (op == "stop-identify")
+        {
+            entry.accessory->stopIdentify();
+        }
+    }
+
+    /**
+     * @brief Gets the state of every relay in creation order, one '0' or '1' per relay.
+     */
+    std::string relayStates() const
+    {
+        std::string states;
+        for (const std::unique_ptr<FakeRelayModule> & relay : m_relays)
+        {
+            states += relay->isOn() ? '1' : '0';
+        }
+        return states;
+    }
+
+    std::vector<Report> reports; ///< Reports in delivery order.
+
+private:
+    enum class Kind
+    {
+        Light,
+        Blind,
+        Door,
+        Button
+    };
+
+    struct Entry
+    {
+        Kind kind;
+        size_t index;
+        FakeButtonModule * button;
+        FakeButtonModule * secondButton;
+        BaseAccessoryInterface * accessory;
+    };
+
+    FakeRelayModule * addRelay()
+    {
+        m_relays.emplace_back(new FakeRelayModule());
+        return m_relays.back().get();
+    }
+
+    FakeButtonModule * addButton()
+    {
+        m_buttonModules.emplace_back(new FakeButtonModule());
+        return m_buttonModules.back().get();
+    }
+
+    void registerAccessory(BaseAccessoryInterface * accessory, Entry entry)
+    {
+        entry.accessory = accessory;
+        m_entries.push_back(entry);
+        accessory->setAccessoryId(static_cast<uint16_t>(m_entries.size()));
+        accessory->setEventCallback(onEvent, this);
+    }
+
+    static void onEvent(const AccessoryEvent & event, void * instance)
+    {
+        static_cast<Household *>(instance)->reports.push_back({ AccessoryClock::now(), event });
+    }
+
+    std::vector<std::unique_ptr<FakeRelayModule>> m_relays;
+    std::vector<std::unique_ptr<FakeButtonModule>> m_buttonModules;
+    std::vector<std::unique_ptr<LightAccessory>> m_lights;
+    std::vector<std::unique_ptr<BlindAccessory>> m_blinds;
+    std::vector<std::unique_ptr<DoorLockAccessory>> m_doors;
+    std::vector<std::unique_ptr<StatelessButtonAccessory>> m_buttons;
+    std::vector<Entry> m_entries;
+};
+
+/**
+ * @brief Small deterministic PRNG, identical on every platform.
+ */
+class XorShift
+{
+public:
+    explicit XorShift(uint64_t seed) : m_state(seed ? seed : 0x9E3779B97F4A7C15ull) {}
+
+    uint32_t next(uint32_t bound)
+    {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 7;
+        m_state ^= m_state << 17;
+        return static_cast<uint32_t>(m_state % bound);
+    }
+
+private:
+    uint64_t m_state;
+};
+
+/**
+ * @brief Generates a household workload: every accessory acts at random intervals around the mean.
+ */
+static std::vector<Command> generateWorkload(size_t lights, size_t blinds, size_t doors, size_t buttons, uint32_t hours,
+                                             uint32_t meanIntervalS, uint64_t seed)
+{
+    XorShift random(seed);
+    std::vector<Command> commands;
+    int64_t endMs   = int64_t(hours) * 3600 * 1000;
+    size_t total    = lights + blinds + doors + buttons;
+    uint32_t window = 2 * meanIntervalS * 1000;
+
+    for (size_t id = 1; id <= total; id++)
+    {
+        for (int64_t t = random.next(window); t < endMs; t += 1 + random.next(window))
+        {
+            Command command = { t, static_cast<uint16_t>(id), "press", 0 };
+            uint32_t choice = random.next(100);
+            if (id <= lights)
+            {
+                command.op  = choice < 70 ? "press" : choice < 95 ? "power" : "identify";
+                command.arg = static_cast<int32_t>(random.next(2));
+            }
+            else if (id <= lights + blinds)
+            {
+                command.op  = choice < 60 ? "move" : "press";
+                command.arg = static_cast<int32_t>(choice < 60 ? random.next(101) : random.next(2));
+            }
+            else if (id <= lights + blinds + doors)
+            {
+                command.op = choice < 80 ? "press" : choice < 95 ? "unlock" : "lock";
+            }
+            else
+            {
+                command.op = choice < 60 ? "press" : choice < 85 ? "double" : "long";
+            }
+            commands.push_back(command);
+        }
+    }
+    return commands;
+}
+
+static bool loadTrace(const char * path, std::vector<Command> & commands)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        fprintf(stderr, "cannot open trace %s\n", path);
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+        std::istringstream fields(line);
+        Command command = { 0, 0, "", 0 };
+        fields >> command.timeMs >> command.accessoryId >> command.op;
+        fields >> command.arg;
+        commands.push_back(command);
+    }
+    return true;
+}
+
+/**
+ * @brief Renders the report sequence and final relay states, the exact output compared by --expect.
+ */
+static std::string render(const Household & household)
+{
+    std::string output;
+    char line[160];
+    for (const Report & report : household.reports)
+    {
+        const AccessoryEvent & e = report.event;
+        snprintf(line, sizeof(line), "%lld %u mask=%02x save=%d power=%d unlocked=%d current=%u target=%u press=%u\n",
+                 static_cast<long long>(report.timeUs / 1000), e.accessoryId, e.changedMask, e.onlySave, e.powerOn, e.unlocked,
+                 e.currentPosition, e.targetPosition, e.pressType);
+        output += line;
+    }
+    output += "relays " + household.relayStates() + "\n";
+    return output;
+}
+
+static uint64_t fnv1a(const std::string & text)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (unsigned char c : text)
+    {
+        hash = (hash ^ c) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+static void usage()
+{
+    fprintf(stderr,
+            "usage: accessory_simulation --household L,B,D,S (--trace FILE | --generate --hours H --seed N)\n"
+            "                            [--mean-interval-s S] [--dump] [--expect FILE] [--expect-hash HEX]\n");
+}
+
+int main(int argc, char ** argv)
+{
+    size_t lights = 1, blinds = 1, doors = 1, buttons = 1;
+    const char * tracePath  = nullptr;
+    const char * expectPath = nullptr;
+    const char * expectHash = nullptr;
+    bool generate           = false;
+    bool dump               = false;
+    uint32_t hours          = 24;
+    uint32_t meanIntervalS  = 1200;
+    uint64_t seed           = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--household") == 0 && hasValue)
+        {
+            sscanf(argv[++i], "%zu,%zu,%zu,%zu", &lights, &blinds, &doors, &buttons);
+        }
+        else if (strcmp(argv[i], "--trace") == 0 && hasValue)
+        {
+            tracePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--generate") == 0)
+        {
+            generate = true;
+        }
+        else if (strcmp(argv[i], "--hours") == 0 && hasValue)
+        {
+            hours = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && hasValue)
+        {
+            seed = strtoull(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--mean-interval-s") == 0 && hasValue)
+        {
+            meanIntervalS = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        }
+        else if (strcmp(argv[i], "--dump") == 0)
+        {
+            dump = true;
+        }
+        else if (strcmp(argv[i], "--expect") == 0 && hasValue)
+        {
+            expectPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--expect-hash") == 0 && hasValue)
+        {
+            expectHash = argv[++i];
+        }
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+    if (!tracePath && !generate)
+    {
+        usage();
+        return 2;
+    }
+    esp_log_level_set("*", ESP_LOG_NONE);
+
+    std::vector<Command> commands;
+    if (tracePath && !loadTrace(tracePath, commands))
+    {
+        return 2;
+    }
+    if (generate)
+    {
+        commands = generateWorkload(lights, blinds, doors, buttons, hours, meanIntervalS, seed);
+    }
+    std::stable_sort(commands.begin(), commands.end(),
+                     [](const Command & a, const Command & b) { return a.timeMs < b.timeMs; });
+
+    auto wallStart = std::chrono::steady_clock::now();
+    AccessoryTimerService & service = AccessoryTimerService::instance();
+    Household household(lights, blinds, doors, buttons);
+
+    for (const Command & command : commands)
+    {
+        service.advanceTo(command.timeMs * 1000);
+        household.apply(command);
+        // Run the work the command armed for now, such as a blind retarget.
+        service.advanceTo(command.timeMs * 1000);
+    }
+
+    // Let running motions, unlock windows and identify sequences complete.
+    int64_t deadline;
+    while (service.getNextDeadline(deadline))
+    {
+        service.advanceTo(deadline);
+    }
+
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    std::string output = render(household);
+    uint64_t hash      = fnv1a(output);
+
+    if (dump)
+    {
+        fputs(output.c_str(), stdout);
+    }
+    printf("accessories %zu, commands %zu, reports %zu, virtual %.1f h in %.3f s wall\n", household.size(), commands.size(),
+           household.reports.size(), AccessoryClock::now() / 3.6e9, wallSeconds);
+    printf("report hash %016llx\n", static_cast<unsigned long long>(hash));
+
+    int result = 0;
+    if (expectPath)
+    {
+        std::ifstream file(expectPath);
+        std::stringstream expected;
+        expected << file.rdbuf();
+        if (!file || expected.str() != output)
+        {
+            fprintf(stderr, "output differs from %s, rerun with --dump to compare\n", expectPath);
+            result = 1;
+        }
+    }
+    if (expectHash && strtoull(expectHash, nullptr, 16) != hash)
+    {
+        fprintf(stderr, "report hash differs from %s\n", expectHash);
+        result = 1;
+    }
+    return result;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <chrono>
+#include <stdio.h>
+#include <thread>
+
+/**
+ * @brief Minimal test harness for the host build.
+ */
+struct HostTest
+{
+    using Function = void (*)();
+
+    const char * name; ///< Name printed in the results.
+    Function function; ///< Test body.
+
+    static int & failures()
+    {
+        static int count = 0;
+        return count;
+    }
+};
+
+#define HOST_TEST_ASSERT(condition)                                                                                              \
+    do                                                                                                                           \
+    {                                                                                                                            \
+        if (!(condition))                                                                                                        \
+        {                                                                                                                        \
+            fprintf(stderr, "%s:%d: assertion failed: %s\n", __FILE__, __LINE__, #condition);                                    \
+            HostTest::failures()++;                                                                                              \
+            return;                                                                                                              \
+        }                                                                                                                        \
+    } while (0)
+
+/**
+ * @brief Polls a condition until it holds or the timeout expires.
+ */
+template <typename Condition>
+bool waitFor(Condition condition, uint32_t timeoutMs)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!condition())
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+        {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
@@ -0,0 +1,1072 @@
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#include <AccessoryConfig.hpp>
+#include <AccessoryConfigFile.hpp>
+#include <AccessoryDevice.hpp>
+#include <AccessoryFileStorage.hpp>
+#include <AccessoryRegistry.hpp>
+#include <AccessoryRetainedState.hpp>
+#include <AccessoryStateStore.hpp>
+#include <AccessoryTelemetry.hpp>
+#include <AccessoryTimer.hpp>
+#include <BlindAccessory.hpp>
+#include <DoorLockAccessory.hpp>
+#include <LightAccessory.hpp>
+#include <RelayToggleAccessory.hpp>
+#include <SceneExecutor.hpp>
+#include <StatelessButtonAccessory.hpp>
+
+#include "FakeButtonModule.hpp"
+#include "FakeRelayModule.hpp"
+#include "HostTest.hpp"
+
+/**
+ * @brief Collects the events delivered to the application.
+ */
+struct EventRecorder
+{
+    std::atomic<int> count{0};
+    std::mutex mutex;
+    AccessoryEvent lastEvent{};
+
+    static void onEvent(const AccessoryEvent & event, void * instance)
+    {
+        EventRecorder * recorder = static_cast<EventRecorder *>(instance);
+        std::lock_guard<std::mutex> lock(recorder->mutex);
+        recorder->lastEvent = event;
+        recorder->count++;
+    }
+
+    AccessoryEvent last()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return lastEvent;
+    }
+};
+
+static void lightButtonTogglesRelayAndReports()
+{
+    FakeRelayModule relay;
+    FakeButtonModule button;
+    LightAccessory light(&relay, &button);
+    EventRecorder recorder;
+    light.setAccessoryId(7);
+    light.setEventCallback(EventRecorder::onEvent, &recorder);
+
+    button.singlePress();
+    HOST_TEST_ASSERT(waitFor([&]() { return recorder.count == 1; }, 1000));
+    HOST_TEST_ASSERT(relay.isOn());
+    HOST_TEST_ASSERT(recorder.last().accessoryId == 7);
+    HOST_TEST_ASSERT(recorder.last().changedMask == AccessoryEvent::ATTRIBUTE_POWER);
+    HOST_TEST_ASSERT(recorder.last().powerOn);
+
+    button.singlePress();
+    HOST_TEST_ASSERT(waitFor([&]() { return recorder.count == 2; }, 1000));
+    HOST_TEST_ASSERT(!relay.isOn());
+}
+
+static void lightIdentifyRestoresRelay()
+{
+    static const IdentifyStep steps[] = { { 0, true, 20 }, { 0, false, 20 } };
+    FakeRelayModule relay(true);
+    FakeButtonModule button;
+    LightAccessory light(&relay, &button);
+    light.setIdentifyPattern(IdentifyPattern(steps));
+
+    light.identify();
+    HOST_TEST_ASSERT(waitFor([&]() { return relay.getSetPowerCount() >= 3; }, 1000));
+    HOST_TEST_ASSERT(relay.isOn());
+}
+
+static void lightButtonDuringIdentifyReportsNothing()
+{
+    FakeRelayModule relay;
+    FakeButtonModule button;
+    LightAccessory light(&relay, &button);
+    EventRecorder recorder;
+    light.setEventCallback(EventRecorder::onEvent, &recorder);
+
+    light.identify();
+    button.singlePress();
+    HOST_TEST_ASSERT(!waitFor([&]() { return recorder.count > 0; }, 50));
+    light.stopIdentify();
+    HOST_TEST_ASSERT(!relay.isOn());
+}
+
+/**
+ * @brief Traits of a plug built without an abstract interface.
+ */
+struct TestPlugTraits
+{
+    static constexpr const char * TAG                         = "TestPlug";
+    static constexpr AccessoryType TYPE                       = AccessoryType::Plugin;
+    static constexpr const IdentifyPattern * IDENTIFY_PATTERN = &IdentifyPatterns::RELAY_BLINK;
+    static constexpr bool RESTART_IDENTIFY                    = true;
+};
+
+static void staticRelayToggleReportsButtonToggles()
+{
+    FakeRelayModule relay;
+    FakeButtonModule button;
+    StaticRelayToggleAccessory<TestPlugTraits> plug(&relay, &button);
+    EventRecorder recorder;
+    plug.setEventCallback(EventRecorder::onEvent, &recorder);
+
+    // The caller of setPower() knows the new state already.
+    HOST_TEST_ASSERT(plug.setPower(true));
+    HOST_TEST_ASSERT(relay.isOn());
+    HOST_TEST_ASSERT(!waitFor([&]() { return recorder.count > 0; }, 50));
+
+    button.singlePress();
+    HOST_TEST_ASSERT(waitFor([&]() { return recorder.count == 1; }, 1000));
+    HOST_TEST_ASSERT(!waitFor([&]() { return recorder.count > 1; }, 50));
+    HOST_TEST_ASSERT(!relay.isOn());
+    HOST_TEST_ASSERT(recorder.last().accessoryType == AccessoryType::Plugin);
+    HOST_TEST_ASSERT(!recorder.last().powerOn);
+
+    AccessoryStateRecord light = {};
+    light.accessoryType        = static_cast<uint8_t>(AccessoryType::Light);
+    light.flags                = AccessoryStateRecord::FLAG_POWER_ON;
+    HOST_TEST_ASSERT(!plug.restore(light));
+    HOST_TEST_ASSERT(!relay.isOn());
+}
+
+static void blindReachesTargetAndStops()
+{
+    FakeRelayModule motorUp;
+    FakeRelayModule motorDown;
+    FakeButtonModule buttonUp;
+    FakeButtonModule buttonDown;
+    BlindAccessory blind(&motorUp, &motorDown, &buttonUp, &buttonDown);
+    EventRecorder recorder;
+    blind.setTravelTime(200, 200);
+    blind.setEventCallback(EventRecorder::onEvent, &recorder);
+
+    blind.moveBlindTo(50);
+    HOST_TEST_ASSERT(waitFor([&]() { return motorUp.isOn(); }, 1000));
+    HOST_TEST_ASSERT(waitFor([&]() { return !motorUp.isOn() && !recorder.last().onlySave && recorder.count >= 2; }, 2000));
+    HOST_TEST_ASSERT(!motorDown.isOn());
+    HOST_TEST_ASSERT(blind.getCurrentPosition() == 50);
+    HOST_TEST_ASSERT(recorder.last().currentPosition == 5000);
+}
+
+static void doorRelocksAfterOpenDuration()
+{
+    FakeRelayModule relay;
+    FakeButtonModule button;
+    DoorLockAccessory door(&relay, &button, 1);
+
+    button.singlePress();
+    HOST_TEST_ASSERT(relay.isOn());
+    HOST_TEST_ASSERT(door.getState() == DoorLockAccessoryInterface::DoorLockState::UNLOCKED);
+    HOST_TEST_ASSERT(waitFor([&]() { return !relay.isOn(); }, 3000));
+}
+
+static void doorRetriggerExtendsUnlockWindow()
+{
+    FakeRelayModule relay;
+    FakeButtonModule button;
+    DoorLockAccessory door(&relay, &button, 1);
+    EventRecorder recorder;
+    door.setEventCallback(EventRecorder::onEvent, &recorder);
+
+    auto start = std::chrono::steady_clock::now();
+    door.setState(DoorLockAccessoryInterface::DoorLockState::UNLOCKED);
+    for (int i = 0; i < 10; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        door.setState(DoorLockAccessoryInterface::DoorLockState::UNLOCKED);
+    }
+    auto lastTrigger = std::chrono::steady_clock::now();
+
+    // The window restarted with every trigger, which is not reported again.
+    HOST_TEST_ASSERT(waitFor([&]() { return !relay.isOn(); }, 2000));
+    auto relocked = std::chrono::steady_clock::now();
+    HOST_TEST_ASSERT(relocked - lastTrigger >= std::chrono::milliseconds(1000));
+    HOST_TEST_ASSERT(relocked - start < std::chrono::milliseconds(1800));
+    HOST_TEST_ASSERT(waitFor([&]() { return recorder.count == 2; }, 1000));
+    HOST_TEST_ASSERT(!recorder.last().unlocked);
+
+#if CONFIG_A_M_LATENCY_STATS
+    AccessoryLatencyStats stats = door.getLatencyStats(AccessoryLatencyPath::RELOCK);
+    HOST_TEST_ASSERT(stats.count == 1);
+    HOST_TEST_ASSERT(stats.maxUs < 20000);
+#endif
+}
+
+static void fullTimerServiceKeepsAccessoriesSafe()
+{
+    FakeRelayModule relay;
+    FakeButtonModule button;
+    DoorLockAccessory door(&relay, &button, 1);
+    FakeRelayModule motorUp;
+    FakeRelayModule motorDown;
+    BlindAccessory blind(&motorUp, &motorDown, nullptr, nullptr);
+    blind.setTravelTime(200, 200);
+    FakeRelayModule lightRelay;
+    LightAccessory light(&lightRelay, nullptr);
+
+    std::vector<std::unique_ptr<AccessoryTimer>> fillers;
+    for (;;)
+    {
+        fillers.emplace_back(new AccessoryTimer([](void *) {}, nullptr));
+        if (!fillers.back()->start(60000))
+        {
+            break;
+        }
+    }
+
+    door.setState(DoorLockAccessoryInterface::DoorLockState::UNLOCKED);
+    HOST_TEST_ASSERT(!relay.isOn());
+    blind.moveBlindTo(100);
+    HOST_TEST_ASSERT(!waitFor([&]() { return motorUp.isOn(); }, 50));
+    light.identify();
+    light.setPowerState(true);
+    HOST_TEST_ASSERT(lightRelay.isOn());
+
+    fillers.clear();
+    door.setState(DoorLockAccessoryInterface::DoorLockState::UNLOCKED);
+    HOST_TEST_ASSERT(relay.isOn());
+    blind.moveBlindTo(100);
+    HOST_TEST_ASSERT(waitFor([&]() { return blind.getCurrentPosition() == 100 && !motorUp.isOn(); }, 2000));
+}
+
+static void statelessButtonReportsPressType()
+{
+    FakeButtonModule button;
+    StatelessButtonAccessory accessory(&button);
+    EventRecorder recorder;
+    accessory.setEventCallback(EventRecorder::onEvent, &recorder);
+
+    button.doublePress();
+    HOST_TEST_ASSERT(waitFor([&]() { return recorder.count == 1; }, 1000));
+    HOST_TEST_ASSERT(recorder.last().pressType == StatelessButtonAccessoryInterface::DoublePress);
+    HOST_TEST_ASSERT(accessory.getLastPressType() == StatelessButtonAccessoryInterface::DoublePress);
+}
+
+static void statelessButtonQueuesPressesWithoutLoss()
+{
+    using PressEvent = StatelessButtonAccessoryInterface::PressEvent;
+    FakeButtonModule button;
+    StatelessButtonAccessory accessory(&button);
+    PressEvent events[16];
+
+    button.singlePress();
+    button.doublePress();
+    button.longPress();
+    HOST_TEST_ASSERT(accessory.drainEvents(events, 16) == 3);
+    HOST_TEST_ASSERT(events[0].pressType == StatelessButtonAccessoryInterface::SinglePress && events[0].sequence == 1);
+    HOST_TEST_ASSERT(events[1].pressType == StatelessButtonAccessoryInterface::DoublePress && events[1].sequence == 2);
+    HOST_TEST_ASSERT(events[2].pressType == StatelessButtonAccessoryInterface::LongPress && events[2].sequence == 3);
+    HOST_TEST_ASSERT(events[0].timestampUs <= events[1].timestampUs && events[1].timestampUs <= events[2].timestampUs);
+    HOST_TEST_ASSERT(accessory.drainEvents(events, 16) == 0);
+
+    // A full queue keeps the oldest presses and counts the others.
+    for (int i = 0; i < CONFIG_A_M_STATELESS_BUTTON_QUEUE_SIZE + 2; i++)
+    {
+        button.singlePress();
+    }
+    HOST_TEST_ASSERT(accessory.getOverflowCount() == 2);
+    HOST_TEST_ASSERT(accessory.drainEvents(events, 2) == 2 && events[0].sequence == 4);
+    HOST_TEST_ASSERT(accessory.drainEvents(events, 16) == CONFIG_A_M_STATELESS_BUTTON_QUEUE_SIZE - 2);
+    button.doublePress();
+    HOST_TEST_ASSERT(accessory.drainEvents(events, 16) == 1);
+    HOST_TEST_ASSERT(events[0].sequence == CONFIG_A_M_STATELESS_BUTTON_QUEUE_SIZE + 6);
+}
+
+static void statelessButtonQueueDrainsConcurrently()
+{
+    static constexpr uint32_t PRESSES = 20000;
+    FakeButtonModule button;
+    StatelessButtonAccessory accessory(&button);
+
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < PRESSES; i++)
+        {
+            button.singlePress();
+        }
+    });
+
+    StatelessButtonAccessoryInterface::PressEvent events[4];
+    uint32_t drained      = 0;
+    uint32_t lastSequence = 0;
+    bool ordered          = true;
+    while (drained + accessory.getOverflowCount() < PRESSES)
+    {
+        size_t count = accessory.drainEvents(events, 4);
+        for (size_t i = 0; i < count; i++)
+        {
+            ordered      = ordered && events[i].sequence > lastSequence;
+            lastSequence = events[i].sequence;
+        }
+        drained += count;
+    }
+    producer.join();
+
+    HOST_TEST_ASSERT(ordered);
+    HOST_TEST_ASSERT(drained + accessory.getOverflowCount() == PRESSES);
+}
+
+static void statelessButtonDecodesMultiPressAndHold()
+{
+    using PressEvent = StatelessButtonAccessoryInterface::PressEvent;
+    StatelessButtonAccessory accessory(nullptr);
+    EventRecorder recorder;
+    PressEvent events[16];
+    AccessoryPressProfile profile;
+    profile.debounceMs      = 0;
+    profile.multiPressGapMs = 150;
+    profile.longPressMs     = 300;
+    profile.repeatMs        = 60;
+    profile.maxPresses      = 5;
+    accessory.setPressProfile(profile);
+    accessory.setEventCallback(EventRecorder::onEvent, &recorder);
+
+    for (int i = 0; i < 3; i++)
+    {
+        accessory.handleEdge(true);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        accessory.handleEdge(false);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    HOST_TEST_ASSERT(recorder.count == 0);
+    HOST_TEST_ASSERT(waitFor([&]() { return recorder.count == 1; }, 1000));
+    HOST_TEST_ASSERT(recorder.last().pressType == StatelessButtonAccessoryInterface::MultiPress);
+    HOST_TEST_ASSERT(recorder.last().pressCount == 3);
+
+    accessory.handleEdge(true);
+    HOST_TEST_ASSERT(waitFor([&]() { return recorder.count >= 4; }, 2000));
+    accessory.handleEdge(false);
+    HOST_TEST_ASSERT(waitFor(
+        [&]() { return recorder.last().pressType == StatelessButtonAccessoryInterface::LongPressRelease; }, 1000));
+
+    size_t count = accessory.drainEvents(events, 16);
+    HOST_TEST_ASSERT(count >= 5);
+    HOST_TEST_ASSERT(events[1].pressType == StatelessButtonAccessoryInterface::LongPress && events[1].pressCount == 1);
+    HOST_TEST_ASSERT(events[2].pressType == StatelessButtonAccessoryInterface::LongPressRepeat);
+    HOST_TEST_ASSERT(events[count - 1].pressType == StatelessButtonAccessoryInterface::LongPressRelease);
+}
+
+static void statelessButtonReportsSinglePressSpeculatively()
+{
+    using PressEvent = StatelessButtonAccessoryInterface::PressEvent;
+    StatelessButtonAccessory accessory(nullptr);
+    PressEvent events[4];
+    AccessoryPressProfile profile;
+    profile.debounceMs  = 50;
+    profile.longPressMs = 0;
+    profile.maxPresses  = 1;
+    accessory.setPressProfile(profile);
+
+    // Without double or long presses the press is reported on the down edge, and the bounces are ignored.
+    accessory.handleEdge(true);
+    accessory.handleEdge(false);
+    accessory.handleEdge(true);
+    HOST_TEST_ASSERT(waitFor([&]() { return accessory.getLastPress().sequence == 1; }, 1000));
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    HOST_TEST_ASSERT(accessory.drainEvents(events, 4) == 1);
+    HOST_TEST_ASSERT(events[0].pressType == StatelessButtonAccessoryInterface::SinglePress && events[0].pressCount == 1);
+    accessory.handleEdge(false);
+
+    // With long presses the press is reported on release, still without waiting for a gap.
+    profile.debounceMs  = 0;
+    profile.longPressMs = 500;
+    accessory.setPressProfile(profile);
+    accessory.handleEdge(true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    HOST_TEST_ASSERT(accessory.drainEvents(events, 4) == 0);
+    accessory.handleEdge(false);
+    HOST_TEST_ASSERT(waitFor([&]() { return accessory.getLastPress().sequence == 2; }, 1000));
+    HOST_TEST_ASSERT(accessory.drainEvents(events, 4) == 1);
+    HOST_TEST_ASSERT(events[0].pressType == StatelessButtonAccessoryInterface::SinglePress);
+}
+
+static void stateStoreCoalescesBlindProgress()
+{
+    const char * path = "state_store_blind.bin";
+    remove(path);
+    {
+        AccessoryFileStorage storage(path, 4096);
+        AccessoryStateStore store(&storage, 50);
+        HOST_TEST_ASSERT(!store.load());
+
+        FakeRelayModule motorUp;
+        FakeRelayModule motorDown;
+        FakeButtonModule buttonUp;
+        FakeButtonModule buttonDown;
+        BlindAccessory blind(&motorUp, &motorDown, &buttonUp, &buttonDown);
+        blind.setAccessoryId(3);
+        blind.setTravelTime(300, 300);
+        blind.setReportPolicy(5, 0);
+        blind.setStateStore(&store);
+
+        blind.moveBlindTo(100);
+        HOST_TEST_ASSERT(waitFor([&]() { return blind.getCurrentPosition() == 100 && !motorUp.isOn(); }, 2000));
+        HOST_TEST_ASSERT(waitFor([&]() { return store.getStats().flushes == 1; }, 1000));
+        AccessoryStateStore::Stats stats = store.getStats();
+        HOST_TEST_ASSERT(stats.updates >= 10);
+        HOST_TEST_ASSERT(stats.writes == 1);
+        blind.setStateStore(nullptr);
+    }
+
+    AccessoryFileStorage storage(path, 4096);
+    AccessoryStateStore store(&storage, 50);
+    AccessoryStateRecord record;
+    HOST_TEST_ASSERT(store.load());
+    HOST_TEST_ASSERT(store.getRecord(3, record));
+    HOST_TEST_ASSERT(record.accessoryType == static_cast<uint8_t>(AccessoryType::Blind));
+    HOST_TEST_ASSERT(record.currentPosition == 10000 && record.targetPosition == 10000);
+}
+
+static void stateStoreCompactsJournal()
+{
+    const char * path = "state_store_compaction.bin";
+    remove(path);
+    {
+        // Four entries per bank, so two lights fill a bank after one compaction and one more flush.
+        AccessoryFileStorage storage(path, 2 * (8 + 4 * 12));
+        AccessoryStateStore store(&storage, 1000);
+        FakeRelayModule relay1;
+        FakeRelayModule relay2;
+        FakeButtonModule button1;
+        FakeButtonModule button2;
+        LightAccessory light1(&relay1, &button1);
+        LightAccessory light2(&relay2, &button2);
+        light1.setAccessoryId(1);
+        light2.setAccessoryId(2);
+        light1.setStateStore(&store);
+        light2.setStateStore(&store);
+
+        for (int i = 0; i < 9; i++)
+        {
+            button1.singlePress();
+            button2.singlePress();
+            HOST_TEST_ASSERT(store.flush());
+        }
+        HOST_TEST_ASSERT(relay1.isOn() && relay2.isOn());
+        HOST_TEST_ASSERT(store.getStats().compactions >= 3);
+        light1.setStateStore(nullptr);
+        light2.setStateStore(nullptr);
+    }
+
+    AccessoryFileStorage storage(path, 2 * (8 + 4 * 12));
+    AccessoryStateStore store(&storage);
+    AccessoryStateRecord record;
+    HOST_TEST_ASSERT(store.load());
+    HOST_TEST_ASSERT(store.getRecord(1, record) && (record.flags & AccessoryStateRecord::FLAG_POWER_ON));
+    HOST_TEST_ASSERT(store.getRecord(2, record) && (record.flags & AccessoryStateRecord::FLAG_POWER_ON));
+}
+
+static void stateStoreRestoresWithoutReports()
+{
+    const char * path = "state_store_restore.bin";
+    remove(path);
+    AccessoryFileStorage storage(path, 4096);
+    AccessoryStateStore store(&storage);
+
+    // State saved before the reboot.
+    AccessoryEvent event = {};
+    event.changedMask    = AccessoryEvent::ATTRIBUTE_POWER;
+    event.accessoryType  = AccessoryType::Light;
+    event.accessoryId    = 1;
+    event.powerOn        = true;
+    store.update(event);
+    event.accessoryId = 2;
+    store.update(event);
+    event.changedMask   = AccessoryEvent::ATTRIBUTE_LOCK_STATE;
+    event.accessoryType = AccessoryType::DoorLock;
+    event.accessoryId   = 3;
+    event.unlocked      = true;
+    store.update(event);
+    event.changedMask     = AccessoryEvent::ATTRIBUTE_CURRENT_POSITION;
+    event.accessoryType   = AccessoryType::Blind;
+    event.accessoryId     = 4;
+    event.currentPosition = 4200;
+    store.update(event);
+    uint32_t updates = store.getStats().updates;
+
+    FakeRelayModule relay1;
+    FakeRelayModule relay2(true);
+    FakeRelayModule doorRelay(true);
+    FakeRelayModule relay5(true);
+    FakeRelayModule motorUp;
+    FakeRelayModule motorDown;
+    FakeButtonModule button;
+    LightAccessory light1(&relay1, &button);
+    LightAccessory light2(&relay2, &button);
+    DoorLockAccessory door(&doorRelay, &button, 1);
+    BlindAccessory blind(&motorUp, &motorDown, &button, &button);
+    LightAccessory light5(&relay5, &button);
+    BaseAccessoryInterface * accessories[] = { &light1, &light2, &door, &blind, &light5 };
+    EventRecorder recorder;
+    for (uint16_t i = 0; i < 5; i++)
+    {
+        accessories[i]->setAccessoryId(i + 1);
+        accessories[i]->setEventCallback(EventRecorder::onEvent, &recorder);
+    }
+
+    HOST_TEST_ASSERT(store.restore(accessories, 5) == 4);
+    HOST_TEST_ASSERT(relay1.isOn() && relay1.getSetPowerCount() == 1);
+    HOST_TEST_ASSERT(relay2.isOn() && relay2.getSetPowerCount() == 0);
+    HOST_TEST_ASSERT(!doorRelay.isOn());
+    HOST_TEST_ASSERT(relay5.isOn() && relay5.getSetPowerCount() == 0);
+    HOST_TEST_ASSERT(blind.getTargetPosition() == 42);
+    HOST_TEST_ASSERT(waitFor([&]() { return blind.getCurrentPosition() == 42; }, 1000));
+    HOST_TEST_ASSERT(!waitFor([&]() { return recorder.count > 0; }, 50));
+    HOST_TEST_ASSERT(motorUp.getSetPowerCount() == 0 && motorDown.getSetPowerCount() == 0);
+    HOST_TEST_ASSERT(store.getStats().updates == updates);
+    HOST_TEST_ASSERT(store.getStats().restoredAtUs > 0);
+
+    // A record of another type is ignored.
+    AccessoryStateRecord record;
+    HOST_TEST_ASSERT(store.getRecord(4, record));
+    HOST_TEST_ASSERT(!light1.restore(record));
+}
+
+#if CONFIG_A_M_RETAINED_STATE
+static void retainedStateResumesBlindMotion()
+{
+    FakeRelayModule motorUp;
+    FakeRelayModule motorDown;
+    FakeButtonModule buttonUp;
+    FakeButtonModule buttonDown;
+    AccessoryRetainedRecord record;
+    {
+        BlindAccessory blind(&motorUp, &motorDown, &buttonUp, &buttonDown);
+        blind.setAccessoryId(21);
+        blind.setTravelTime(1000, 1000);
+        blind.moveBlindTo(100);
+        HOST_TEST_ASSERT(waitFor([&]() { return motorUp.isOn(); }, 1000));
+        HOST_TEST_ASSERT(AccessoryRetainedState::find(21, record));
+        HOST_TEST_ASSERT(record.direction == 1 && record.startPosition == 0 && record.targetPosition == 10000);
+        HOST_TEST_ASSERT(record.timeUs > 0 && record.timeUs <= AccessoryRetainedState::now());
+    }
+    // Destroying the accessory stops the motion on purpose, so it is not resumed.
+    HOST_TEST_ASSERT(AccessoryRetainedState::find(21, record) && record.direction == 0);
+
+    // The chip reset 300 ms into a full opening.
+    record.direction      = 1;
+    record.startPosition  = 0;
+    record.targetPosition = 10000;
+    record.timeUs         = AccessoryRetainedState::resetTime() - 300000;
+    AccessoryRetainedState::save(record);
+
+    BlindAccessory blind(&motorUp, &motorDown, &buttonUp, &buttonDown);
+    BaseAccessoryInterface * accessories[] = { &blind };
+    EventRecorder recorder;
+    blind.setAccessoryId(21);
+    blind.setTravelTime(1000, 1000);
+    blind.setEventCallback(EventRecorder::onEvent, &recorder);
+    HOST_TEST_ASSERT(AccessoryRetainedState::resume(accessories, 1) == 1);
+    HOST_TEST_ASSERT(blind.getTargetPosition() == 100);
+    HOST_TEST_ASSERT(waitFor([&]() { return blind.getCurrentPosition() >= 29; }, 1000));
+    HOST_TEST_ASSERT(blind.getCurrentPosition() <= 40);
+
+    HOST_TEST_ASSERT(waitFor([&]() { return blind.getCurrentPosition() == 100 && !motorUp.isOn(); }, 2000));
+    // With the dispatcher the arrival event may still be queued when the motor stops.
+    HOST_TEST_ASSERT(waitFor([&]() { return recorder.count > 0 && recorder.last().currentPosition == 10000; }, 1000));
+    HOST_TEST_ASSERT(AccessoryRetainedState::find(21, record));
+    HOST_TEST_ASSERT(record.direction == 0 && record.startPosition == 10000);
+}
+
+static void retainedStateFinishesDoorUnlockWindow()
+{
+    FakeRelayModule relay;
+    FakeButtonModule button;
+    AccessoryRetainedRecord record;
+    {
+        DoorLockAccessory door(&relay, &button, 5);
+        door.setAccessoryId(22);
+        door.setState(DoorLockAccessoryInterface::DoorLockState::UNLOCKED);
+        HOST_TEST_ASSERT(AccessoryRetainedState::find(22, record));
+        int64_t remainingUs = record.timeUs - AccessoryRetainedState::now();
+        HOST_TEST_ASSERT(remainingUs > 4000000 && remainingUs <= 5000000);
+        door.setState(DoorLockAccessoryInterface::DoorLockState::LOCKED);
+        HOST_TEST_ASSERT(AccessoryRetainedState::find(22, record) && record.timeUs == 0);
+    }
+
+    // The chip reset 200 ms before the end of the unlock window, which turned the relay off.
+    record.timeUs = AccessoryRetainedState::now() + 200000;
+    AccessoryRetainedState::save(record);
+    DoorLockAccessory door(&relay, &button, 5);
+    EventRecorder recorder;
+    door.setAccessoryId(22);
+    door.setEventCallback(EventRecorder::onEvent, &recorder);
+    HOST_TEST_ASSERT(door.resume());
+    HOST_TEST_ASSERT(relay.isOn());
+    HOST_TEST_ASSERT(waitFor([&]() { return recorder.count == 1; }, 1000));
+    HOST_TEST_ASSERT(!relay.isOn() && !recorder.last().unlocked);
+    HOST_TEST_ASSERT(!door.resume());
+
+    // The window ended while the chip was down.
+    record.timeUs = AccessoryRetainedState::now() - 1;
+    AccessoryRetainedState::save(record);
+    HOST_TEST_ASSERT(door.resume());
+    HOST_TEST_ASSERT(!relay.isOn());
+}
+#endif
+
+/**
+ * @brief Collects the aggregated reports of a scene executor.
+ */
+struct SceneRecorder
+{
+    int count = 0;
+    SceneExecutor::Report last{};
+    std::vector<AccessoryEvent> events;
+
+    static void onReport(const SceneExecutor::Report & report, void * instance)
+    {
+        SceneRecorder * recorder = static_cast<SceneRecorder *>(instance);
+        recorder->count++;
+        recorder->last = report;
+        recorder->events.assign(report.events, report.events + report.eventCount);
+    }
+};
+
+/**
+ * @brief Sixteen lights with ids 1 to 16 and scene entries switching all of them.
+ */
+struct SceneBoard
+{
+    static constexpr int LIGHTS = 16;
+    FakeRelayModule relays[LIGHTS];
+    std::unique_ptr<LightAccessory> lights[LIGHTS];
+    BaseAccessoryInterface * accessories[LIGHTS];
+    SceneExecutor::Entry entries[LIGHTS];
+
+    SceneBoard(bool powerOn)
+    {
+        for (int i = 0; i < LIGHTS; i++)
+        {
+            lights[i].reset(new LightAccessory(&relays[i], nullptr));
+            lights[i]->setAccessoryId(static_cast<uint16_t>(i + 1));
+            accessories[i]                 = lights[i].get();
+            entries[i].accessory           = lights[i].get();
+            entries[i].state               = {};
+            entries[i].state.accessoryId   = static_cast<uint16_t>(i + 1);
+            entries[i].state.accessoryType = static_cast<uint8_t>(AccessoryType::Light);
+            entries[i].state.flags         = powerOn ? AccessoryStateRecord::FLAG_POWER_ON : 0;
+        }
+    }
+};
+
+static void sceneAppliesStatesWithOneReport()
+{
+    SceneBoard board(true);
+    EventRecorder recorder;
+    SceneRecorder sceneRecorder;
+    SceneExecutor executor(board.accessories, SceneBoard::LIGHTS);
+    executor.setReportCallback(SceneRecorder::onReport, &sceneRecorder);
+    for (int i = 0; i < SceneBoard::LIGHTS; i++)
+    {
+        board.lights[i]->setEventCallback(EventRecorder::onEvent, &recorder);
+    }
+
+    HOST_TEST_ASSERT(executor.activate(board.entries, SceneBoard::LIGHTS, 5));
+    HOST_TEST_ASSERT(sceneRecorder.count == 1 && recorder.count == 0);
+    HOST_TEST_ASSERT(sceneRecorder.last.sceneId == 5 && sceneRecorder.last.applied == SceneBoard::LIGHTS);
+    HOST_TEST_ASSERT(sceneRecorder.events.size() == SceneBoard::LIGHTS);
+    HOST_TEST_ASSERT(sceneRecorder.events[15].accessoryId == 16 && sceneRecorder.events[15].powerOn);
+    for (int i = 0; i < SceneBoard::LIGHTS; i++)
+    {
+        HOST_TEST_ASSERT(board.relays[i].isOn());
+    }
+
+    // Accessories already in their state are not written and not reported, the wrong type is skipped.
+    board.entries[0].state.accessoryType = static_cast<uint8_t>(AccessoryType::Fan);
+    HOST_TEST_ASSERT(executor.activate(board.entries, SceneBoard::LIGHTS));
+    HOST_TEST_ASSERT(sceneRecorder.count == 2 && sceneRecorder.events.empty());
+    HOST_TEST_ASSERT(sceneRecorder.last.applied == SceneBoard::LIGHTS - 1 && sceneRecorder.last.skipped == 1);
+    HOST_TEST_ASSERT(board.relays[1].getSetPowerCount() == 1);
+
+    HOST_TEST_ASSERT(!executor.activate(board.entries, SceneExecutor::MAX_ENTRIES + 1));
+    SceneExecutor::Stats stats = executor.getStats();
+    HOST_TEST_ASSERT(stats.activations == 2 && stats.rejected == 1);
+    HOST_TEST_ASSERT(stats.maxUs >= stats.lastUs);
+}
+
+static void sceneActivatesStoredPreset()
+{
+    const char * path = "scene_presets.bin";
+    remove(path);
+    SceneBoard allOff(false);
+    SceneRecorder sceneRecorder;
+    AccessoryFileStorage storage(path, 4096);
+    {
+        SceneExecutor executor(allOff.accessories, SceneBoard::LIGHTS, &storage);
+        HOST_TEST_ASSERT(!executor.loadPresets());
+        HOST_TEST_ASSERT(executor.setPreset(1, allOff.entries, SceneBoard::LIGHTS));
+        HOST_TEST_ASSERT(executor.setPreset(2, allOff.entries, 4));
+        HOST_TEST_ASSERT(executor.setPreset(1, allOff.entries, SceneBoard::LIGHTS));
+        HOST_TEST_ASSERT(executor.removePreset(2));
+        HOST_TEST_ASSERT(executor.savePresets());
+    }
+
+    SceneExecutor executor(allOff.accessories, SceneBoard::LIGHTS, &storage);
+    executor.setReportCallback(SceneRecorder::onReport, &sceneRecorder);
+    HOST_TEST_ASSERT(executor.loadPresets());
+    for (int i = 0; i < SceneBoard::LIGHTS; i++)
+    {
+        allOff.relays[i].setPower(true);
+    }
+    HOST_TEST_ASSERT(!executor.activatePreset(2));
+    HOST_TEST_ASSERT(executor.activatePreset(1));
+    HOST_TEST_ASSERT(sceneRecorder.count == 1 && sceneRecorder.last.sceneId == 1);
+    HOST_TEST_ASSERT(sceneRecorder.events.size() == SceneBoard::LIGHTS && !sceneRecorder.events[0].powerOn);
+    for (int i = 0; i < SceneBoard::LIGHTS; i++)
+    {
+        HOST_TEST_ASSERT(!allOff.relays[i].isOn());
+    }
+}
+
+static void registryGroupsAccessoriesByTypeAndFindsEndpoints()
+{
+    FakeRelayModule relays[5];
+    FakeButtonModule buttons[3];
+    std::unique_ptr<AccessoryRegistry> registry(new AccessoryRegistry());
+
+    BlindAccessory * blind   = registry->emplace<BlindAccessory>(40, &relays[0], &relays[1], &buttons[0], &buttons[1]);
+    LightAccessory * first   = registry->emplace<LightAccessory>(12, &relays[2], nullptr);
+    DoorLockAccessory * door = registry->emplace<DoorLockAccessory>(3, &relays[3], &buttons[2], 5);
+    LightAccessory * second  = registry->emplace<LightAccessory>(7, &relays[4], nullptr);
+    HOST_TEST_ASSERT(blind && first && door && second);
+    HOST_TEST_ASSERT(!registry->emplace<LightAccessory>(7, &relays[4], nullptr));
+    HOST_TEST_ASSERT(registry->size() == 4);
+    HOST_TEST_ASSERT(registry->getArenaUsed() >= sizeof(BlindAccessory) + sizeof(DoorLockAccessory) + 2 * sizeof(LightAccessory));
+
+    HOST_TEST_ASSERT(registry->find(40) == blind);
+    HOST_TEST_ASSERT(registry->find(12) == first);
+    HOST_TEST_ASSERT(registry->find(3) == door);
+    HOST_TEST_ASSERT(registry->find(7) == second);
+    HOST_TEST_ASSERT(!registry->find(99));
+    HOST_TEST_ASSERT(first->getAccessoryId() == 12);
+
+    // Slots are grouped in AccessoryType order, registration order within a type.
+    BaseAccessoryInterface * const * slots = registry->accessories();
+    HOST_TEST_ASSERT(slots[0] == first && slots[1] == second && slots[2] == door && slots[3] == blind);
+    size_t lights = 0;
+    HOST_TEST_ASSERT(registry->accessories(AccessoryType::Light, lights) == slots && lights == 2);
+
+    first->setPowerState(true);
+    second->setPowerState(true);
+    EventRecorder recorder;
+    HOST_TEST_ASSERT(registry->allOff(EventRecorder::onEvent, &recorder) == 2);
+    HOST_TEST_ASSERT(recorder.count == 2);
+    HOST_TEST_ASSERT(!relays[2].isOn() && !relays[4].isOn());
+    HOST_TEST_ASSERT(registry->allOff() == 0);
+
+    AccessoryStateRecord states[4];
+    HOST_TEST_ASSERT(registry->snapshotAll(states, 4) == 4);
+    HOST_TEST_ASSERT(states[0].accessoryId == 12 && states[0].flags == 0);
+    HOST_TEST_ASSERT(states[3].accessoryType == static_cast<uint8_t>(AccessoryType::Blind));
+}
+
+static constexpr AccessorySpec DEVICE_BOARD[] = {
+    AccessorySpec::light(10, 0, 0),          AccessorySpec::light(11, 1),
+    AccessorySpec::doorLock(20, 2, 1, 3),    AccessorySpec::blind(30, 3, 4, 2, 3, 25, 20),
+    AccessorySpec::statelessButton(40, 4),
+};
+static constexpr AccessorySpec CONFLICTING_BOARD[] = { AccessorySpec::light(1, 0), AccessorySpec::blind(2, 1, 0) };
+static_assert(!AccessoryDeviceCheck::relaysDistinct(CONFLICTING_BOARD), "A relay shared by two accessories must be caught");
+static_assert(AccessoryDeviceCheck::relayCount(DEVICE_BOARD) == 5 && AccessoryDeviceCheck::buttonCount(DEVICE_BOARD) == 5,
+              "Table sizes are derived from the description");
+
+static void deviceBuildsAccessoriesFromDescription()
+{
+    FakeRelayModule relays[5];
+    FakeButtonModule buttons[5];
+    RelayModuleInterface * const relayTable[]   = { &relays[0], &relays[1], &relays[2], &relays[3], &relays[4] };
+    ButtonModuleInterface * const buttonTable[] = { &buttons[0], &buttons[1], &buttons[2], &buttons[3], &buttons[4] };
+    AccessoryDevice<DEVICE_BOARD> device(relayTable, buttonTable);
+
+    HOST_TEST_ASSERT(device.size() == 5);
+    size_t withState = 0;
+    for (size_t i = 0; i < device.size(); i++)
+    {
+        AccessoryStateRecord state = {};
+        HOST_TEST_ASSERT(device.accessories()[i]->getAccessoryId() == DEVICE_BOARD[i].endpointId);
+        if (device.accessories()[i]->getState(state))
+        {
+            HOST_TEST_ASSERT(state.accessoryType == static_cast<uint8_t>(DEVICE_BOARD[i].type));
+            withState++;
+        }
+    }
+    HOST_TEST_ASSERT(withState == 4);
+
+    // Every accessory drives the modules of its row.
+    buttons[0].singlePress();
+    HOST_TEST_ASSERT(relays[0].isOn() && !relays[1].isOn());
+    device.get<1>().setPowerState(true);
+    HOST_TEST_ASSERT(relays[1].isOn());
+    device.get<2>().setState(DoorLockAccessoryInterface::DoorLockState::UNLOCKED);
+    HOST_TEST_ASSERT(relays[2].isOn());
+    device.get<3>().moveBlindTo(50);
+    HOST_TEST_ASSERT(waitFor([&]() { return relays[3].isOn(); }, 1000));
+    HOST_TEST_ASSERT(!relays[4].isOn());
+
+    EventRecorder recorder;
+    device.get<4>().setEventCallback(EventRecorder::onEvent, &recorder);
+    buttons[4].doublePress();
+    HOST_TEST_ASSERT(waitFor([&]() { return recorder.count == 1; }, 1000));
+    HOST_TEST_ASSERT(recorder.last().accessoryId == 40);
+}
+
+static void configBuildsAccessoriesFromMappedImage()
+{
+    const AccessoryConfigRecord records[] = {
+        { static_cast<uint8_t>(AccessoryType::Light), 0xFF, 5, { 0, 0xFF }, { 0, 0xFF }, { 0, 0 }, 0xFFFF },
+        { static_cast<uint8_t>(AccessoryType::Blind), 0xFF, 6, { 1, 2 }, { 1, 2 }, { 25, 20 }, 0xFFFF },
+        { static_cast<uint8_t>(AccessoryType::DoorLock), 0xFF, 7, { 3, 0xFF }, { 0xFF, 0xFF }, { 5, 0 }, 0xFFFF },
+        { static_cast<uint8_t>(AccessoryType::Fan), 0xFF, 8, { 9, 0xFF }, { 0xFF, 0xFF }, { 0, 0 }, 0xFFFF },
+    };
+    AccessoryConfigHeader header = { AccessoryConfig::MAGIC, AccessoryConfig::VERSION, sizeof(AccessoryConfigHeader),
+                                     sizeof(AccessoryConfigRecord), 4, AccessoryConfig::checksum(records, sizeof(records)),
+                                     0xFFFF };
+    const char * path = "accessory_config.bin";
+    FILE * file       = fopen(path, "wb");
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(records, sizeof(records), 1, file);
+    fclose(file);
+
+    FakeRelayModule relays[4];
+    FakeButtonModule buttons[3];
+    RelayModuleInterface * const relayTable[]   = { &relays[0], &relays[1], &relays[2], &relays[3] };
+    ButtonModuleInterface * const buttonTable[] = { &buttons[0], &buttons[1], &buttons[2] };
+    {
+        AccessoryConfigFile image(path);
+        AccessoryConfig config(image.getData(), image.getSize());
+        HOST_TEST_ASSERT(config.isValid() && config.size() == 4);
+        // Records are read where they are mapped.
+        const uint8_t * mapped = static_cast<const uint8_t *>(image.getData());
+        HOST_TEST_ASSERT(reinterpret_cast<const uint8_t *>(&config.record(1)) == mapped + sizeof(header) + sizeof(records[0]));
+
+        // The door lacks its button and the fan's relay is outside the table: both are skipped.
+        std::unique_ptr<AccessoryRegistry> registry(new AccessoryRegistry());
+        HOST_TEST_ASSERT(config.build(*registry, relayTable, 4, buttonTable, 3) == 2);
+        HOST_TEST_ASSERT(registry->size() == 2 && !registry->find(7) && !registry->find(8));
+        LightAccessory * light = static_cast<LightAccessory *>(registry->find(5));
+        HOST_TEST_ASSERT(light && light->getAccessoryId() == 5);
+        buttons[0].singlePress();
+        HOST_TEST_ASSERT(relays[0].isOn());
+        static_cast<BlindAccessory *>(registry->find(6))->moveBlindTo(50);
+        HOST_TEST_ASSERT(waitFor([&]() { return relays[1].isOn(); }, 1000));
+    }
+
+    // A truncated image, a flipped bit or another format version leaves the image unused.
+    alignas(AccessoryConfigHeader) uint8_t image[sizeof(header) + sizeof(records)];
+    memcpy(image, &header, sizeof(header));
+    memcpy(image + sizeof(header), records, sizeof(records));
+    HOST_TEST_ASSERT(AccessoryConfig(image, sizeof(image)).isValid());
+    HOST_TEST_ASSERT(!AccessoryConfig(image, sizeof(image) - 1).isValid());
+    image[sizeof(header) + 2] ^= 1;
+    HOST_TEST_ASSERT(!AccessoryConfig(image, sizeof(image)).isValid());
+    image[sizeof(header) + 2] ^= 1;
+    header.version = AccessoryConfig::VERSION + 1;
+    memcpy(image, &header, sizeof(header));
+    HOST_TEST_ASSERT(!AccessoryConfig(image, sizeof(image)).isValid());
+    remove(path);
+}
+
+static void accessoryStateReadsStayConsistentUnderLoad()
+{
+    FakeRelayModule motorUp;
+    FakeRelayModule motorDown;
+    FakeButtonModule buttonUp;
+    FakeButtonModule buttonDown;
+    FakeButtonModule button;
+    BlindAccessory blind(&motorUp, &motorDown, &buttonUp, &buttonDown);
+    StatelessButtonAccessory accessory(&button);
+    blind.setTravelTime(200, 400);
+
+    // Odd presses are single, even presses double: a torn read mixes the fields of two presses.
+    std::atomic<bool> done(false);
+    std::thread writer([&]() {
+        for (int i = 0; i < 200; i++)
+        {
+            // The motion callback reads the travel times and the report policy on the timer service task.
+            blind.setTravelTime(i % 4 < 2 ? 200 : 400, i % 4 < 2 ? 400 : 200);
+            blind.setReportPolicy(i % 3 == 0 ? 0 : 5, i % 2 == 0 ? 0 : 20);
+            blind.moveBlindTo(i % 2 == 0 ? 80 : 20);
+            for (int press = 0; press < 20; press++)
+            {
+                if (press % 2 == 0)
+                {
+                    button.singlePress();
+                }
+                else
+                {
+                    button.doublePress();
+                }
+            }
+            blind.identify();
+            blind.stopIdentify();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        done = true;
+    });
+
+    auto reader = [&](uint32_t & reads) {
+        bool consistent       = true;
+        uint32_t lastSequence = 0;
+        int64_t lastTimestamp = 0;
+        while (!done)
+        {
+            BlindAccessoryInterface::MotionSnapshot motion = blind.getMotionSnapshot();
+            int direction = (motion.targetPosition > motion.startPosition) - (motion.targetPosition < motion.startPosition);
+            int32_t speed = motion.velocity < 0 ? -motion.velocity : motion.velocity;
+            consistent    = consistent && (speed == 0 || speed == 50000 || speed == 25000);
+            consistent    = consistent && (motion.velocity > 0) - (motion.velocity < 0) == direction;
+            consistent    = consistent && blind.getCurrentPosition() <= 100;
+
+            StatelessButtonAccessoryInterface::PressEvent press = accessory.getLastPress();
+            StatelessButtonAccessoryInterface::PressType expected =
+                press.sequence % 2 == 1 ? StatelessButtonAccessoryInterface::SinglePress
+                                        : StatelessButtonAccessoryInterface::DoublePress;
+            consistent    = consistent && press.sequence >= lastSequence && press.timestampUs >= lastTimestamp;
+            consistent    = consistent && (press.sequence == 0 || (press.pressType == expected && press.pressCount == 1));
+            lastSequence  = press.sequence;
+            lastTimestamp = press.timestampUs;
+            reads++;
+        }
+        return consistent;
+    };
+
+    uint32_t otherReads  = 0;
+    bool otherConsistent = true;
+    std::thread other([&]() { otherConsistent = reader(otherReads); });
+    uint32_t reads  = 0;
+    bool consistent = reader(reads);
+    other.join();
+    writer.join();
+
+    HOST_TEST_ASSERT(consistent && otherConsistent);
+    HOST_TEST_ASSERT(reads > 0 && otherReads > 0);
+    HOST_TEST_ASSERT(accessory.getLastPress().sequence == 200 * 20);
+}
+
+#if CONFIG_A_M_EVENT_DISPATCHER_ENABLE
+/**
+ * @brief Event callback that destroys another accessory on the dispatcher task once allowed to.
+ */
+struct AccessoryDestroyer
+{
+    std::atomic<bool> entered{false};
+    std::atomic<bool> proceed{false};
+    std::atomic<LightAccessory *> victim{nullptr};
+
+    static void onEvent(const AccessoryEvent &, void * instance)
+    {
+        AccessoryDestroyer * destroyer = static_cast<AccessoryDestroyer *>(instance);
+        destroyer->entered             = true;
+        while (!destroyer->proceed)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        delete destroyer->victim.exchange(nullptr);
+    }
+};
+
+static void dispatcherDropsEventsOfAccessoryDestroyedInCallback()
+{
+    FakeRelayModule relays[2];
+    FakeButtonModule buttons[2];
+    LightAccessory light(&relays[0], &buttons[0]);
+    AccessoryDestroyer destroyer;
+    EventRecorder recorder;
+    LightAccessory * victim = new LightAccessory(&relays[1], &buttons[1]);
+    victim->setEventCallback(EventRecorder::onEvent, &recorder);
+    destroyer.victim = victim;
+    light.setEventCallback(AccessoryDestroyer::onEvent, &destroyer);
+
+    // The event of the victim waits in the queue behind the callback that destroys it.
+    buttons[0].singlePress();
+    HOST_TEST_ASSERT(waitFor([&]() { return destroyer.entered.load(); }, 1000));
+    buttons[1].singlePress();
+    destroyer.proceed = true;
+    HOST_TEST_ASSERT(waitFor([&]() { return destroyer.victim.load() == nullptr; }, 1000));
+    HOST_TEST_ASSERT(!waitFor([&]() { return recorder.count > 0; }, 50));
+}
+#endif
+
+#if CONFIG_A_M_TASK_TELEMETRY
+static void telemetryCountsAccessoriesAndCallbacks()
+{
+    static const IdentifyStep steps[] = { { 0, true, 10 }, { 0, false, 10 } };
+    uint8_t light                     = static_cast<uint8_t>(AccessoryType::Light);
+    AccessoryTelemetrySnapshot before = AccessoryTelemetry::getSnapshot();
+    {
+        FakeRelayModule relay;
+        FakeButtonModule button;
+        LightAccessory lightAccessory(&relay, &button);
+        lightAccessory.setIdentifyPattern(IdentifyPattern(steps));
+        HOST_TEST_ASSERT(AccessoryTelemetry::getSnapshot().types[light].live == before.types[light].live + 1);
+
+        lightAccessory.identify();
+        HOST_TEST_ASSERT(waitFor([&]() { return relay.getSetPowerCount() >= 3; }, 1000));
+    }
+    AccessoryTelemetrySnapshot after = AccessoryTelemetry::getSnapshot();
+    uint8_t timerService             = static_cast<uint8_t>(AccessoryTask::TIMER_SERVICE);
+
+    HOST_TEST_ASSERT(after.types[light].created == before.types[light].created + 1);
+    HOST_TEST_ASSERT(after.types[light].live == before.types[light].live);
+    HOST_TEST_ASSERT(after.types[light].callbackCount >= before.types[light].callbackCount + 2);
+    HOST_TEST_ASSERT(after.tasks[timerService].name != nullptr);
+    HOST_TEST_ASSERT(after.tasks[timerService].stackSize == CONFIG_A_M_TIMER_SERVICE_STACK_SIZE);
+    HOST_TEST_ASSERT(after.tasks[timerService].callbackCount >= after.types[light].callbackCount);
+    HOST_TEST_ASSERT(AccessoryTelemetry::recommendedStackSize(AccessoryType::Light) >= CONFIG_A_M_TASK_TELEMETRY_STACK_MARGIN);
+}
+#endif
+
+int main()
+{
+    const std::vector<HostTest> tests = {
+        { "lightButtonTogglesRelayAndReports", lightButtonTogglesRelayAndReports },
+        { "lightIdentifyRestoresRelay", lightIdentifyRestoresRelay },
+        { "lightButtonDuringIdentifyReportsNothing", lightButtonDuringIdentifyReportsNothing },
+        { "staticRelayToggleReportsButtonToggles", staticRelayToggleReportsButtonToggles },
+        { "blindReachesTargetAndStops", blindReachesTargetAndStops },
+        { "doorRelocksAfterOpenDuration", doorRelocksAfterOpenDuration },
+        { "doorRetriggerExtendsUnlockWindow", doorRetriggerExtendsUnlockWindow },
+        { "fullTimerServiceKeepsAccessoriesSafe", fullTimerServiceKeepsAccessoriesSafe },
+        { "statelessButtonReportsPressType", statelessButtonReportsPressType },
+        { "statelessButtonQueuesPressesWithoutLoss", statelessButtonQueuesPressesWithoutLoss },
+        { "statelessButtonQueueDrainsConcurrently", statelessButtonQueueDrainsConcurrently },
+        { "statelessButtonDecodesMultiPressAndHold", statelessButtonDecodesMultiPressAndHold },
+        { "statelessButtonReportsSinglePressSpeculatively", statelessButtonReportsSinglePressSpeculatively },
+        { "stateStoreCoalescesBlindProgress", stateStoreCoalescesBlindProgress },
+        { "stateStoreCompactsJournal", stateStoreCompactsJournal },
+        { "stateStoreRestoresWithoutReports", stateStoreRestoresWithoutReports },
+#if CONFIG_A_M_RETAINED_STATE
+        { "retainedStateResumesBlindMotion", retainedStateResumesBlindMotion },
+        { "retainedStateFinishesDoorUnlockWindow", retainedStateFinishesDoorUnlockWindow },
+#endif
+        { "sceneAppliesStatesWithOneReport", sceneAppliesStatesWithOneReport },
+        { "sceneActivatesStoredPreset", sceneActivatesStoredPreset },
+        { "registryGroupsAccessoriesByTypeAndFindsEndpoints", registryGroupsAccessoriesByTypeAndFindsEndpoints },
+        { "deviceBuildsAccessoriesFromDescription", deviceBuildsAccessoriesFromDescription },
+        { "configBuildsAccessoriesFromMappedImage", configBuildsAccessoriesFromMappedImage },
+        { "accessoryStateReadsStayConsistentUnderLoad", accessoryStateReadsStayConsistentUnderLoad },
+#if CONFIG_A_M_EVENT_DISPATCHER_ENABLE
+        { "dispatcherDropsEventsOfAccessoryDestroyedInCallback", dispatcherDropsEventsOfAccessoryDestroyedInCallback },
+#endif
+#if CONFIG_A_M_TASK_TELEMETRY
+        { "telemetryCountsAccessoriesAndCallbacks", telemetryCountsAccessoriesAndCallbacks },
+#endif
+    };
+
+    for (const HostTest & test : tests)
+    {
+        int failuresBefore = HostTest::failures();
+        test.function();
+        printf("%s %s\n", HostTest::failures() == failuresBefore ? "PASS" : "FAIL", test.name);
+    }
+    printf("%zu tests, %d failures\n", tests.size(), HostTest::failures());
+    return HostTest::failures() == 0 ? 0 : 1;
+}
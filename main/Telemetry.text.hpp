@@ -0,0 +1,73 @@
+#pragma once
+#include "testHelper.hpp"
+
+#include <AccessoryTelemetry.hpp>
+#include <BlindAccessory.hpp>
+#include <DoorLockAccessory.hpp>
+#include <FanAccessory.hpp>
+#include <LightAccessory.hpp>
+#include <PluginAccessory.hpp>
+#include <SwitchAccessory.hpp>
+#include <RelayModule.hpp>
+#include <ButtonModule.hpp>
+
+#if CONFIG_A_M_TASK_TELEMETRY
+
+// Exercises the timed paths of every accessory type with a logging report callback, then prints the stack size a
+// timer service serving only that type would need. Copy the largest value into A_M_TIMER_SERVICE_STACK_SIZE.
+// Only built with the sdkconfig.telemetry overlay, so telemetry does not change the timing of the other tests.
+TEST_CASE("Test 14", "[Telemetry] [Stack]")
+{
+    static constexpr IdentifyStep shortBlink[] = { { 0, true, 50 }, { 0, false, 50 }, { 0, true, 50 }, { 0, false, 50 } };
+    static const char * TAG                    = "Telemetry";
+
+    RelayModule relay1(2, 1, 0);
+    RelayModule relay2(4, 1, 0);
+    ButtonModule button1(5);
+    ButtonModule button2(18);
+
+    LightAccessory lightAccessory(&relay1, &button1);
+    FanAccessory fanAccessory(&relay1, &button1);
+    SwitchAccessory switchAccessory(&relay1, &button1);
+    PluginAccessory pluginAccessory(&relay1, &button1);
+    DoorLockAccessory doorLockAccessory(&relay1, &button1, 1);
+    BlindAccessory blindAccessory(&relay1, &relay2, &button1, &button2);
+
+    BaseAccessoryInterface * relayAccessories[] = { &lightAccessory, &fanAccessory, &switchAccessory, &pluginAccessory };
+    for (BaseAccessoryInterface * accessory : relayAccessories)
+    {
+        accessory->setReportCallback([](void * aaa, bool bbb) { ESP_LOGI(TAG, "report, onlySave %d", bbb); }, nullptr);
+        accessory->identify();
+        vTaskDelay(1000 / portTICK_PERIOD_MS);
+    }
+    lightAccessory.setIdentifyPattern(IdentifyPattern(shortBlink));
+    lightAccessory.identify();
+    vTaskDelay(300 / portTICK_PERIOD_MS);
+
+    doorLockAccessory.setReportCallback([](void * aaa, bool bbb) { ESP_LOGI(TAG, "report, onlySave %d", bbb); }, nullptr);
+    doorLockAccessory.setState(DoorLockAccessoryInterface::DoorLockState::UNLOCKED);
+    vTaskDelay(1200 / portTICK_PERIOD_MS);
+
+    blindAccessory.setReportCallback([](void * aaa, bool bbb) { ESP_LOGI(TAG, "report, onlySave %d", bbb); }, nullptr);
+    blindAccessory.setTravelTime(500, 500);
+    blindAccessory.moveBlindTo(100);
+    vTaskDelay(200 / portTICK_PERIOD_MS);
+    blindAccessory.moveBlindTo(30);
+    vTaskDelay(800 / portTICK_PERIOD_MS);
+
+    AccessoryTelemetry::log();
+
+    static const char * const names[] = { "Light", "Fan", "Switch", "Plugin", "DoorLock", "Blind" };
+    printf("Recommended timer service stack per accessory type:\n");
+    for (uint8_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+    {
+        uint32_t recommended = AccessoryTelemetry::recommendedStackSize(static_cast<AccessoryType>(i));
+        printf("  %-10s %lu bytes\n", names[i], (unsigned long) recommended);
+        TEST_ASSERT_NOT_EQUAL(0, recommended);
+        TEST_ASSERT_LESS_OR_EQUAL(CONFIG_A_M_TIMER_SERVICE_STACK_SIZE, recommended - CONFIG_A_M_TASK_TELEMETRY_STACK_MARGIN);
+    }
+    printf("  %-10s %lu bytes\n", "all",
+           (unsigned long) AccessoryTelemetry::recommendedStackSize(AccessoryTask::TIMER_SERVICE));
+}
+
+#endif
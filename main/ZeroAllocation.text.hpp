@@ -0,0 +1,95 @@
+#pragma once
+#include "testHelper.hpp"
+
+#include <BlindAccessory.hpp>
+#include <DoorLockAccessory.hpp>
+#include <LightAccessory.hpp>
+#include <RelayModule.hpp>
+#include <ButtonModule.hpp>
+
+// The first cycle of each test runs outside the trace so one-time lazy initialization (first log line from the
+// timer service task, C library locks) is not counted. Every cycle after that must not touch the heap.
+
+static constexpr IdentifyStep shortBlink[] = { { 0, true, 100 }, { 0, false, 100 }, { 0, true, 100 }, { 0, false, 100 } };
+
+// Moves, retargets mid-move, reverses and closes; ends with the blind at 0 and both motors off.
+static void blindMoveCycle(BlindAccessory & blindAccessory)
+{
+    blindAccessory.moveBlindTo(100);
+    vTaskDelay(150 / portTICK_PERIOD_MS);
+    blindAccessory.moveBlindTo(20);
+    vTaskDelay(50 / portTICK_PERIOD_MS);
+    blindAccessory.moveBlindTo(60);
+    vTaskDelay(400 / portTICK_PERIOD_MS);
+    blindAccessory.moveBlindTo(0);
+    vTaskDelay(400 / portTICK_PERIOD_MS);
+}
+
+TEST_CASE("Test 11", "[ZeroAllocation] [BlindAccessory] [moveBlindTo]")
+{
+    heap_trace_record_t trace_record[10];
+
+    RelayModule motorUp(2, 1, 0);
+    RelayModule motorDown(4, 1, 0);
+    ButtonModule buttonUp(5);
+    ButtonModule buttonDown(18);
+    BlindAccessory blindAccessory(&motorUp, &motorDown, &buttonUp, &buttonDown);
+    blindAccessory.setTravelTime(300, 300);
+    blindAccessory.setReportCallback([](void * aaa, bool bbb) {}, nullptr);
+
+    blindMoveCycle(blindAccessory);
+
+    BEGIN_ZERO_ALLOCATION_TEST(trace_record);
+    blindMoveCycle(blindAccessory);
+    END_ZERO_ALLOCATION_TEST(trace_record);
+
+    TEST_ASSERT_EQUAL(0, blindAccessory.getCurrentPosition());
+    TEST_ASSERT_FALSE(motorUp.isOn());
+    TEST_ASSERT_FALSE(motorDown.isOn());
+}
+
+TEST_CASE("Test 12", "[ZeroAllocation] [LightAccessory] [identify]")
+{
+    heap_trace_record_t trace_record[10];
+
+    RelayModule relayModule(2, 1, 0);
+    ButtonModule buttonModule(5);
+    LightAccessory lightAccessory(&relayModule, &buttonModule);
+    lightAccessory.setIdentifyPattern(IdentifyPattern(shortBlink));
+
+    lightAccessory.identify();
+    vTaskDelay(600 / portTICK_PERIOD_MS);
+
+    BEGIN_ZERO_ALLOCATION_TEST(trace_record);
+    lightAccessory.identify();
+    vTaskDelay(600 / portTICK_PERIOD_MS);
+    lightAccessory.identify();
+    vTaskDelay(150 / portTICK_PERIOD_MS);
+    lightAccessory.stopIdentify();
+    END_ZERO_ALLOCATION_TEST(trace_record);
+
+    TEST_ASSERT_FALSE(relayModule.isOn());
+}
+
+TEST_CASE("Test 13", "[ZeroAllocation] [DoorLockAccessory] [setState]")
+{
+    heap_trace_record_t trace_record[10];
+
+    RelayModule relayModule(2, 1, 0);
+    ButtonModule buttonModule(5);
+    DoorLockAccessory doorLockAccessory(&relayModule, &buttonModule, 1);
+    doorLockAccessory.setReportCallback([](void * aaa, bool bbb) {}, nullptr);
+
+    doorLockAccessory.setState(DoorLockAccessoryInterface::DoorLockState::UNLOCKED);
+    vTaskDelay(1200 / portTICK_PERIOD_MS);
+
+    BEGIN_ZERO_ALLOCATION_TEST(trace_record);
+    doorLockAccessory.setState(DoorLockAccessoryInterface::DoorLockState::UNLOCKED);
+    vTaskDelay(500 / portTICK_PERIOD_MS);
+    doorLockAccessory.setState(DoorLockAccessoryInterface::DoorLockState::UNLOCKED);
+    TEST_ASSERT_TRUE(relayModule.isOn());
+    vTaskDelay(1200 / portTICK_PERIOD_MS);
+    END_ZERO_ALLOCATION_TEST(trace_record);
+
+    TEST_ASSERT_FALSE(relayModule.isOn());
+}
@@ -1,6 +1,8 @@
 
 
 #include "LightAccessory.text.hpp"
+#include "ZeroAllocation.text.hpp"
+#include "Telemetry.text.hpp"
 
 extern "C" void app_main()
 {
@@ -28,4 +28,27 @@
             TEST_FAIL_MESSAGE("Memory leak detected!");                                                                            \
         }                                                                                                                          \
     } while (0)
-#endif
\ No newline at end of file
+#endif
+
+#ifndef BEGIN_ZERO_ALLOCATION_TEST
+#define BEGIN_ZERO_ALLOCATION_TEST(trace_record)                                                                                   \
+    do                                                                                                                             \
+    {                                                                                                                              \
+        heap_trace_stop();                                                                                                         \
+        ESP_ERROR_CHECK(heap_trace_init_standalone(trace_record, sizeof(trace_record) / sizeof(trace_record[0])));                 \
+        ESP_ERROR_CHECK(heap_trace_start(HEAP_TRACE_ALL));                                                                         \
+    } while (0)
+#endif
+
+#ifndef END_ZERO_ALLOCATION_TEST
+#define END_ZERO_ALLOCATION_TEST(trace_record)                                                                                     \
+    do                                                                                                                             \
+    {                                                                                                                              \
+        ESP_ERROR_CHECK(heap_trace_stop());                                                                                        \
+        if (heap_trace_get_count() != 0)                                                                                           \
+        {                                                                                                                          \
+            heap_trace_dump();                                                                                                     \
+            TEST_FAIL_MESSAGE("Heap allocation detected!");                                                                        \
+        }                                                                                                                          \
+    } while (0)
+#endif